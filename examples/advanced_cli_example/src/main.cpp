@@ -3,9 +3,11 @@
  * 
  * This example demonstrates advanced features of the GenericCLI library:
  * - JSON output for commands
- * - Configuration management with EEPROM
+ * - Typed settings under 'config get/set/list/save', persisted in NVS
+ * - Streaming JSON configuration import/export
  * - Advanced argument validation
  * - Sensor data simulation and logging
+ * - Time-series statistics and downsampled export (ts)
  * - Task scheduling and management
  * - Data export capabilities
  * - Custom CLI themes and formatting
@@ -16,45 +18,37 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <EEPROM.h>
 #include <ArduinoJson.h>
 #include "../../src/generic_cli.h"
 #include "../../src/cli_standard_commands.h"
+#include "../../src/cli_settings.h"
+#include "../../src/cli_timeseries.h"
+#include "../../src/cli_bench.h"
+#include "../../src/cli_widgets.h"
 
 // Configuration
-#define EEPROM_SIZE 512
-#define CONFIG_VERSION 1
 #define MAX_SENSOR_READINGS 100
 
 // Global objects
 GenericCLI cli;
 
-// Simulated sensor data
-struct SensorReading {
-    unsigned long timestamp;
-    float temperature;
-    float humidity;
-    float pressure;
-    uint16_t lightLevel;
-};
-
-// Configuration structure
+// Configuration values, registered with the settings registry
 struct DeviceConfig {
-    uint8_t version;
     char deviceName[32];
     char wifiSSID[64];
     char wifiPassword[64];
     bool autoConnect;
-    uint16_t sensorInterval;
+    int32_t sensorInterval;
     bool jsonOutput;
-    uint8_t logLevel;
-    char checksum;
+    int32_t logLevel;
 };
 
 // Global variables
 DeviceConfig config;
-SensorReading sensorData[MAX_SENSOR_READINGS];
-int sensorDataIndex = 0;
+CLISettings settings("device");
+// Simulated sensor history, also queryable with 'ts'
+enum SensorChannel { TEMPERATURE, HUMIDITY, PRESSURE, LIGHT_LEVEL, SENSOR_CHANNELS };
+CLITimeSeries sensorData("sensors", MAX_SENSOR_READINGS, SENSOR_CHANNELS);
 unsigned long lastSensorReading = 0;
 bool dataLoggingEnabled = false;
 
@@ -62,41 +56,22 @@ bool dataLoggingEnabled = false;
 // CONFIGURATION MANAGEMENT
 // ========================================================================
 
-uint8_t calculateChecksum(const DeviceConfig& cfg) {
-    uint8_t sum = 0;
-    const uint8_t* data = (const uint8_t*)&cfg;
-    for (size_t i = 0; i < sizeof(DeviceConfig) - 1; i++) {
-        sum += data[i];
-    }
-    return ~sum + 1; // Two's complement
-}
-
-void loadConfiguration() {
-    EEPROM.readBytes(0, &config, sizeof(DeviceConfig));
+void setupSettings() {
+    // Each setting binds a name, range and default to a config field;
+    // config get/set/list/save are provided by the registry
+    settings.addString("device_name", config.deviceName, sizeof(config.deviceName), 
+                       "ESP32-CLI-Device", "Device name");
+    settings.addString("wifi_ssid", config.wifiSSID, sizeof(config.wifiSSID), "", "WiFi network");
+    settings.addString("wifi_password", config.wifiPassword, sizeof(config.wifiPassword), "", 
+                       "WiFi password", true);
+    settings.addBool("auto_connect", &config.autoConnect, false, "Connect to WiFi at boot");
+    settings.addInt("sensor_interval", &config.sensorInterval, 5000, 1000, 60000, 
+                    "Sensor sampling interval (ms)");
+    settings.addBool("json_output", &config.jsonOutput, false, "Print command output as JSON");
+    settings.addInt("log_level", &config.logLevel, 2, 0, 4, 
+                    "0=None, 1=Error, 2=Warn, 3=Info, 4=Debug");
     
-    if (config.version != CONFIG_VERSION || 
-        config.checksum != calculateChecksum(config)) {
-        // Invalid config, load defaults
-        cli.printWarning("Invalid configuration found, loading defaults");
-        
-        config.version = CONFIG_VERSION;
-        strcpy(config.deviceName, "ESP32-CLI-Device");
-        strcpy(config.wifiSSID, "");
-        strcpy(config.wifiPassword, "");
-        config.autoConnect = false;
-        config.sensorInterval = 5000; // 5 seconds
-        config.jsonOutput = false;
-        config.logLevel = 2; // INFO level
-        config.checksum = calculateChecksum(config);
-        
-        saveConfiguration();
-    }
-}
-
-void saveConfiguration() {
-    config.checksum = calculateChecksum(config);
-    EEPROM.writeBytes(0, &config, sizeof(DeviceConfig));
-    EEPROM.commit();
+    settings.load();
 }
 
 // ========================================================================
@@ -105,16 +80,15 @@ void saveConfiguration() {
 
 void updateSensorData() {
     if (millis() - lastSensorReading >= config.sensorInterval && dataLoggingEnabled) {
-        SensorReading& reading = sensorData[sensorDataIndex];
+        float reading[SENSOR_CHANNELS];
         
         // Simulate realistic sensor data
-        reading.timestamp = millis();
-        reading.temperature = 20.0 + (random(-50, 150) / 10.0); // 15-35°C
-        reading.humidity = 45.0 + (random(-200, 300) / 10.0);   // 25-75%
-        reading.pressure = 1013.25 + (random(-100, 100) / 10.0); // ±10 hPa
-        reading.lightLevel = random(0, 4096); // 12-bit ADC value
+        reading[TEMPERATURE] = 20.0 + (random(-50, 150) / 10.0); // 15-35°C
+        reading[HUMIDITY] = 45.0 + (random(-200, 300) / 10.0);   // 25-75%
+        reading[PRESSURE] = 1013.25 + (random(-100, 100) / 10.0); // ±10 hPa
+        reading[LIGHT_LEVEL] = random(0, 4096); // 12-bit ADC value
         
-        sensorDataIndex = (sensorDataIndex + 1) % MAX_SENSOR_READINGS;
+        sensorData.add(millis(), reading);
         lastSensorReading = millis();
     }
 }
@@ -123,164 +97,29 @@ void updateSensorData() {
 // ADVANCED COMMAND HANDLERS
 // ========================================================================
 
-void handleConfigCommand(const CLIArgs& args) {
-    if (args.empty()) {
-        // Show current configuration
-        if (config.jsonOutput || args.hasFlag("json")) {
-            DynamicJsonDocument doc(1024);
-            doc["device_name"] = config.deviceName;
-            doc["wifi_ssid"] = config.wifiSSID;
-            doc["auto_connect"] = config.autoConnect;
-            doc["sensor_interval"] = config.sensorInterval;
-            doc["json_output"] = config.jsonOutput;
-            doc["log_level"] = config.logLevel;
-            
-            String output;
-            serializeJson(doc, output);
-            Serial.println(output);
-        } else {
-            cli.printInfo("=== Device Configuration ===");
-            Serial.println("Device Name: " + String(config.deviceName));
-            Serial.println("WiFi SSID: " + String(config.wifiSSID));
-            Serial.println("Auto Connect: " + String(config.autoConnect ? "Yes" : "No"));
-            Serial.println("Sensor Interval: " + String(config.sensorInterval) + "ms");
-            Serial.println("JSON Output: " + String(config.jsonOutput ? "Yes" : "No"));
-            Serial.println("Log Level: " + String(config.logLevel));
-        }
-        return;
-    }
-    
-    String action = args.getPositional(0);
-    action.toLowerCase();
-    
-    if (action == "set") {
-        if (args.size() < 3) {
-            cli.printError("Usage: config set <key> <value>");
-            return;
-        }
-        
-        String key = args.getPositional(1);
-        String value = args.getPositional(2);
-        key.toLowerCase();
-        
-        bool changed = false;
-        
-        if (key == "name" || key == "device_name") {
-            if (value.length() < 32) {
-                strcpy(config.deviceName, value.c_str());
-                changed = true;
-            } else {
-                cli.printError("Device name too long (max 31 characters)");
-                return;
-            }
-        } else if (key == "wifi_ssid" || key == "ssid") {
-            if (value.length() < 64) {
-                strcpy(config.wifiSSID, value.c_str());
-                changed = true;
-            } else {
-                cli.printError("SSID too long (max 63 characters)");
-                return;
-            }
-        } else if (key == "wifi_password" || key == "password") {
-            if (value.length() < 64) {
-                strcpy(config.wifiPassword, value.c_str());
-                changed = true;
-            } else {
-                cli.printError("Password too long (max 63 characters)");
-                return;
-            }
-        } else if (key == "auto_connect") {
-            value.toLowerCase();
-            if (value == "true" || value == "1" || value == "yes") {
-                config.autoConnect = true;
-                changed = true;
-            } else if (value == "false" || value == "0" || value == "no") {
-                config.autoConnect = false;
-                changed = true;
-            } else {
-                cli.printError("Invalid boolean value. Use: true/false, 1/0, yes/no");
-                return;
-            }
-        } else if (key == "sensor_interval" || key == "interval") {
-            int interval = value.toInt();
-            if (interval >= 1000 && interval <= 60000) {
-                config.sensorInterval = interval;
-                changed = true;
-            } else {
-                cli.printError("Interval must be between 1000 and 60000 ms");
-                return;
-            }
-        } else if (key == "json_output" || key == "json") {
-            value.toLowerCase();
-            if (value == "true" || value == "1" || value == "yes") {
-                config.jsonOutput = true;
-                changed = true;
-            } else if (value == "false" || value == "0" || value == "no") {
-                config.jsonOutput = false;
-                changed = true;
-            } else {
-                cli.printError("Invalid boolean value");
-                return;
-            }
-        } else if (key == "log_level" || key == "loglevel") {
-            int level = value.toInt();
-            if (level >= 0 && level <= 4) {
-                config.logLevel = level;
-                changed = true;
-            } else {
-                cli.printError("Log level must be 0-4 (0=None, 1=Error, 2=Warn, 3=Info, 4=Debug)");
-                return;
-            }
-        } else {
-            cli.printError("Unknown configuration key: " + key);
-            cli.printInfo("Available keys: name, ssid, password, auto_connect, interval, json, log_level");
-            return;
-        }
-        
-        if (changed) {
-            saveConfiguration();
-            cli.printSuccess("Configuration updated: " + key + " = " + value);
-        }
-        
-    } else if (action == "reset") {
-        // Reset to defaults
-        config.version = CONFIG_VERSION;
-        strcpy(config.deviceName, "ESP32-CLI-Device");
-        strcpy(config.wifiSSID, "");
-        strcpy(config.wifiPassword, "");
-        config.autoConnect = false;
-        config.sensorInterval = 5000;
-        config.jsonOutput = false;
-        config.logLevel = 2;
-        
-        saveConfiguration();
-        cli.printSuccess("Configuration reset to defaults");
-        
-    } else {
-        cli.printError("Unknown config action: " + action);
-        cli.printInfo("Available actions: set, reset, or no action to view current config");
-    }
-}
-
 void handleSensorCommand(const CLIArgs& args) {
     if (args.empty()) {
         // Show current sensor data
-        if (sensorDataIndex == 0 && sensorData[0].timestamp == 0) {
+        if (sensorData.size() == 0) {
             cli.printWarning("No sensor data available");
             return;
         }
         
         // Get the most recent reading
-        int lastIndex = (sensorDataIndex - 1 + MAX_SENSOR_READINGS) % MAX_SENSOR_READINGS;
-        const SensorReading& reading = sensorData[lastIndex];
+        size_t last = sensorData.size() - 1;
+        unsigned long timestamp = sensorData.timestampAt(last);
+        float temperature = sensorData.valueAt(TEMPERATURE, last);
+        float humidity = sensorData.valueAt(HUMIDITY, last);
+        float pressure = sensorData.valueAt(PRESSURE, last);
+        uint16_t lightLevel = sensorData.valueAt(LIGHT_LEVEL, last);
         
         if (config.jsonOutput || args.hasFlag("json")) {
             DynamicJsonDocument doc(512);
-            doc["timestamp"] = reading.timestamp;
-            doc["temperature"] = reading.temperature;
-            doc["humidity"] = reading.humidity;
-            doc["pressure"] = reading.pressure;
-            doc["light_level"] = reading.lightLevel;
+            doc["timestamp"] = timestamp;
+            doc["temperature"] = temperature;
+            doc["humidity"] = humidity;
+            doc["pressure"] = pressure;
+            doc["light_level"] = lightLevel;
             doc["logging_enabled"] = dataLoggingEnabled;
             
             String output;
@@ -288,11 +127,11 @@ void handleSensorCommand(const CLIArgs& args) {
             Serial.println(output);
         } else {
             cli.printInfo("=== Current Sensor Data ===");
-            Serial.println("Timestamp: " + String(reading.timestamp) + "ms");
-            Serial.println("Temperature: " + String(reading.temperature, 2) + "°C");
-            Serial.println("Humidity: " + String(reading.humidity, 1) + "%");
-            Serial.println("Pressure: " + String(reading.pressure, 2) + " hPa");
-            Serial.println("Light Level: " + String(reading.lightLevel) + " (0-4095)");
+            Serial.println("Timestamp: " + String(timestamp) + "ms");
+            Serial.println("Temperature: " + String(temperature, 2) + "°C");
+            Serial.println("Humidity: " + String(humidity, 1) + "%");
+            Serial.println("Pressure: " + String(pressure, 2) + " hPa");
+            Serial.println("Light Level: " + String(lightLevel) + " (0-4095)");
             Serial.println("Logging: " + String(dataLoggingEnabled ? "Enabled" : "Disabled"));
         }
         return;
@@ -311,8 +150,7 @@ void handleSensorCommand(const CLIArgs& args) {
         
     } else if (action == "clear") {
         // Clear sensor data
-        memset(sensorData, 0, sizeof(sensorData));
-        sensorDataIndex = 0;
+        sensorData.clear();
         cli.printSuccess("Sensor data cleared");
         
     } else if (action == "export") {
@@ -320,8 +158,8 @@ void handleSensorCommand(const CLIArgs& args) {
         String format = args.getPositional(1, "json");
         int count = args.getFlag("count", "10").toInt();
         
-        if (count > MAX_SENSOR_READINGS) count = MAX_SENSOR_READINGS;
         if (count < 1) count = 1;
+        size_t first = sensorData.last(count);
         
         format.toLowerCase();
         
@@ -329,16 +167,13 @@ void handleSensorCommand(const CLIArgs& args) {
             DynamicJsonDocument doc(8192);
             JsonArray readings = doc.createNestedArray("readings");
             
-            for (int i = 0; i < count; i++) {
-                int idx = (sensorDataIndex - count + i + MAX_SENSOR_READINGS) % MAX_SENSOR_READINGS;
-                if (sensorData[idx].timestamp == 0) continue;
-                
+            for (size_t i = first; i < sensorData.size(); i++) {
                 JsonObject reading = readings.createNestedObject();
-                reading["timestamp"] = sensorData[idx].timestamp;
-                reading["temperature"] = sensorData[idx].temperature;
-                reading["humidity"] = sensorData[idx].humidity;
-                reading["pressure"] = sensorData[idx].pressure;
-                reading["light_level"] = sensorData[idx].lightLevel;
+                reading["timestamp"] = sensorData.timestampAt(i);
+                reading["temperature"] = sensorData.valueAt(TEMPERATURE, i);
+                reading["humidity"] = sensorData.valueAt(HUMIDITY, i);
+                reading["pressure"] = sensorData.valueAt(PRESSURE, i);
+                reading["light_level"] = (uint16_t)sensorData.valueAt(LIGHT_LEVEL, i);
             }
             
             String output;
@@ -347,19 +182,27 @@ void handleSensorCommand(const CLIArgs& args) {
             
         } else if (format == "csv") {
             Serial.println("timestamp,temperature,humidity,pressure,light_level");
-            for (int i = 0; i < count; i++) {
-                int idx = (sensorDataIndex - count + i + MAX_SENSOR_READINGS) % MAX_SENSOR_READINGS;
-                if (sensorData[idx].timestamp == 0) continue;
-                
-                Serial.println(String(sensorData[idx].timestamp) + "," +
-                             String(sensorData[idx].temperature, 2) + "," +
-                             String(sensorData[idx].humidity, 1) + "," +
-                             String(sensorData[idx].pressure, 2) + "," +
-                             String(sensorData[idx].lightLevel));
+            // Numbers go straight to the stream, no String per field
+            for (size_t i = first; i < sensorData.size(); i++) {
+                cli.printNum(sensorData.timestampAt(i));
+                Serial.print(',');
+                cli.printFixed(sensorData.valueAt(TEMPERATURE, i), 2);
+                Serial.print(',');
+                cli.printFixed(sensorData.valueAt(HUMIDITY, i), 1);
+                Serial.print(',');
+                cli.printFixed(sensorData.valueAt(PRESSURE, i), 2);
+                Serial.print(',');
+                cli.printNum((uint16_t)sensorData.valueAt(LIGHT_LEVEL, i));
+                Serial.println();
             }
+        } else if (format == "bin") {
+            // Delta/varint frames, decoded on the host by tools/cli_ts_decode
+            sensorData.exportBinary(Serial, first, sensorData.size() - first);
+            Serial.println();
+            
         } else {
             cli.printError("Unknown export format: " + format);
-            cli.printInfo("Available formats: json, csv");
+            cli.printInfo("Available formats: json, csv, bin");
         }
         
     } else {
@@ -378,10 +221,14 @@ void handleTaskCommand(const CLIArgs& args) {
     action.toLowerCase();
     
     if (action == "list") {
-        cli.printInfo("=== Active Tasks ===");
-        Serial.println("1. Sensor Data Collection - " + String(dataLoggingEnabled ? "Running" : "Stopped"));
-        Serial.println("2. WiFi Monitor - " + String(WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected"));
-        Serial.println("3. System Monitor - Running");
+        CLITable table(Serial, CLITable::formatFor(args));
+        table.column("#", 0, CLIAlign::RIGHT).column("Task").column("State");
+        table.cell(1).cell("Sensor Data Collection").cell(dataLoggingEnabled ? "Running" : "Stopped");
+        table.endRow();
+        table.cell(2).cell("WiFi Monitor").cell(WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected");
+        table.endRow();
+        table.cell(3).cell("System Monitor").cell("Running");
+        table.endRow();
         
     } else if (action == "create") {
         cli.printInfo("Task creation not implemented in this demo");
@@ -478,11 +325,14 @@ void handleLogCommand(const CLIArgs& args) {
 // ========================================================================
 
 void setup() {
-    // Initialize EEPROM
-    EEPROM.begin(EEPROM_SIZE);
+    // Load configuration from NVS
+    setupSettings();
     
-    // Load configuration
-    loadConfiguration();
+    sensorData.setChannelName(TEMPERATURE, "temperature");
+    sensorData.setChannelName(HUMIDITY, "humidity", 1);
+    sensorData.setChannelName(PRESSURE, "pressure");
+    sensorData.setChannelName(LIGHT_LEVEL, "light_level", 0);
+    sensorData.begin();
     
     // Configure CLI with custom theme
     CLIConfig cliConfig;
@@ -491,8 +341,8 @@ void setup() {
         "🔧 " + String(config.deviceName) + " - Advanced CLI v2.0\n" +
         "═══════════════════════════════════════════════\n" +
         "🚀 Type 'help' for commands\n" +
-        "⚙️  Type 'config' to view/modify settings\n" +
-        "📊 Type 'sensor' to manage sensor data\n" +
+        "⚙️  Type 'config list' / 'config set' to view/modify settings\n" +
+        "📊 Type 'sensor' to manage sensor data, 'ts stats sensors' for statistics\n" +
         "📝 Type 'log' to view system logs\n";
     cliConfig.colorsEnabled = true;
     cliConfig.echoEnabled = true;
@@ -504,14 +354,19 @@ void setup() {
     CLIStandardCommands::registerAllStandardCommands(cli);
     
     // Register advanced commands
-    cli.registerCommand("config", "Manage device configuration", 
-                       "config [set <key> <value>] [reset] [--json]", 
-                       handleConfigCommand, "Configuration");
+    // config get/set/list/save/import/export/reset
+    settings.registerCommands(cli);
     
     cli.registerCommand("sensor", "Sensor data management", 
                        "sensor [start|stop|clear|export] [--json] [--count=n]", 
                        handleSensorCommand, "Data");
     
+    // ts stats/export over sensorData (and any other series)
+    CLITimeSeries::registerCommands(cli);
+    
+    // fmtbench: number formatting costs on this board
+    CLIBench::registerBenchCommands(cli);
+    
     cli.registerCommand("task", "Task management", 
                        "task <list|create|delete|run> [parameters]", 
                        handleTaskCommand, "System");
@@ -45,6 +45,7 @@
 // Make sure these files are in your Arduino libraries folder
 #include "generic_cli.h"
 #include "cli_standard_commands.h"
+#include "cli_widgets.h"
 
 // Pin definitions
 #define LED_PIN 2
@@ -331,13 +332,13 @@ void handleWiFiCommand(const CLIArgs& args) {
         }
         
         // Wait for connection with timeout
-        int attempts = 0;
-        while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-            delay(500);
-            Serial.print(".");
-            attempts++;
+        unsigned long startTime = millis();
+        CLISpinner spinner(Serial, "Waiting", cli.getConfig().colorsEnabled);
+        while (WiFi.status() != WL_CONNECTED && millis() - startTime < 10000) {
+            spinner.tick();
+            delay(50);
         }
-        Serial.println();
+        spinner.finish(WiFi.status() == WL_CONNECTED ? "connected" : "timed out");
         
         if (WiFi.status() == WL_CONNECTED) {
             cli.printSuccess("Connected to " + ssid);
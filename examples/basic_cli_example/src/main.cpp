@@ -31,6 +31,7 @@
 #include <WiFi.h>
 #include "../../src/generic_cli.h"
 #include "../../src/cli_standard_commands.h"
+#include "../../src/cli_widgets.h"
 
 // Configuration
 #define LED_PIN 2
@@ -262,16 +263,13 @@ void handleWiFiCommand(const CLIArgs& args) {
         } else {
             cli.printSuccess("Found " + String(n) + " networks:");
             Serial.println();
-            Serial.println("  #  SSID                         RSSI  Ch  Encryption");
-            Serial.println("  ─  ────────────────────────────  ────  ──  ──────────");
+            
+            CLITable table(Serial, CLITable::formatFor(args));
+            table.column("#", 3, CLIAlign::RIGHT).column("SSID", 30).column("RSSI", 4, CLIAlign::RIGHT)
+                 .column("Ch", 2, CLIAlign::RIGHT).column("Encryption");
             
             for (int i = 0; i < n; i++) {
-                String ssid = WiFi.SSID(i);
-                if (ssid.length() > 30) {
-                    ssid = ssid.substring(0, 27) + "...";
-                }
-                
-                String encryption;
+                const char* encryption;
                 switch (WiFi.encryptionType(i)) {
                     case WIFI_AUTH_OPEN: encryption = "Open"; break;
                     case WIFI_AUTH_WEP: encryption = "WEP"; break;
@@ -282,8 +280,8 @@ void handleWiFiCommand(const CLIArgs& args) {
                     default: encryption = "Unknown"; break;
                 }
                 
-                Serial.printf("%3d  %-30s  %4d  %2d  %s\n", 
-                    i + 1, ssid.c_str(), WiFi.RSSI(i), WiFi.channel(i), encryption.c_str());
+                table.cell(i + 1).cell(WiFi.SSID(i)).cell(WiFi.RSSI(i)).cell(WiFi.channel(i)).cell(encryption);
+                table.endRow();
             }
         }
         
@@ -308,11 +306,12 @@ void handleWiFiCommand(const CLIArgs& args) {
         unsigned long startTime = millis();
         const unsigned long timeout = 15000; // 15 seconds
         
+        CLISpinner spinner(Serial, "Waiting", cli.getConfig().colorsEnabled);
         while (WiFi.status() != WL_CONNECTED && (millis() - startTime) < timeout) {
-            delay(500);
-            Serial.print(".");
+            spinner.tick();
+            delay(50);
         }
-        Serial.println();
+        spinner.finish(WiFi.status() == WL_CONNECTED ? "connected" : "timed out");
         
         if (WiFi.status() == WL_CONNECTED) {
             cli.printSuccess("Connected to " + ssid);
@@ -0,0 +1,128 @@
+/**
+ * Generic CLI Wakeup Example
+ * 
+ * Measures how often the CLI runs while the serial line is idle, to
+ * compare event-driven operation (beginTask) with polling update() from
+ * loop(). The mode is picked at build time by the PlatformIO environment:
+ * 
+ *   pio run -e event --target upload   # cli.beginTask(), woken by UART RX events
+ *   pio run -e poll --target upload    # cli.update() from loop() with delay(1)
+ * 
+ * loop() samples getWakeups() every 10 seconds and keeps the last windows.
+ * The `wakeups` command lists them with update() runs per second. Keys
+ * wake the CLI as well, so for the idle figure type `wakeups`, leave the
+ * line alone for 20 seconds or more, and type it again: the windows
+ * between the two commands were idle.
+ * 
+ * Idle current: put a meter in the board's supply and read it during such
+ * an idle stretch, once with each build.
+ * 
+ * Hardware Requirements:
+ * - ESP32 board with a UART serial port (USB-CDC builds have no RX
+ *   callback and fall back to waking every 20 ms)
+ */
+
+#include <Arduino.h>
+#include "generic_cli.h"
+#include "cli_widgets.h"
+
+#define BAUD_RATE 115200
+#define WINDOW_MS 10000
+#define WINDOW_COUNT 6
+
+#if CLI_EVENT_MODE
+static const char* MODE = "event (beginTask)";
+#else
+static const char* MODE = "poll (update() from loop, delay(1))";
+#endif
+
+GenericCLI cli;
+
+// update() runs per window, oldest first; written by loop(), read by the
+// command (in the CLI task in event mode)
+struct Window {
+    uint32_t started;
+    uint32_t milliseconds;
+    uint32_t wakeups;
+};
+static Window windows[WINDOW_COUNT];
+static volatile uint8_t windowCount = 0;
+static uint32_t windowStart = 0;
+static uint32_t windowWakeups = 0;
+
+static void sampleWakeups() {
+    uint32_t now = millis();
+    if (now - windowStart < WINDOW_MS) {
+        return;
+    }
+    uint32_t wakeups = cli.getWakeups();
+    Window window = { windowStart, now - windowStart, wakeups - windowWakeups };
+    windowStart = now;
+    windowWakeups = wakeups;
+    
+    uint8_t count = windowCount;
+    if (count == WINDOW_COUNT) {
+        memmove(windows, windows + 1, sizeof(Window) * (WINDOW_COUNT - 1));
+        count--;
+    }
+    windows[count] = window;
+    windowCount = count + 1;
+}
+
+/**
+ * Wakeups Command
+ * Usage: wakeups
+ */
+void handleWakeupsCommand(const CLIArgs& args) {
+    cli.printInfo(String("Mode: ") + MODE);
+    uint8_t count = windowCount;
+    if (count == 0) {
+        cli.printInfo("No complete window yet, try again in " + String(WINDOW_MS / 1000) + " s");
+        return;
+    }
+    
+    CLITable table(cli.getStream());
+    table.column("Started (s)", 0, CLIAlign::RIGHT).column("Seconds", 0, CLIAlign::RIGHT)
+         .column("update() runs", 0, CLIAlign::RIGHT).column("Per second", 0, CLIAlign::RIGHT);
+    for (uint8_t i = 0; i < count; i++) {
+        Window window = windows[i];
+        table.cell(window.started / 1000)
+             .cell(window.milliseconds / 1000.0f, 1)
+             .cell(window.wakeups)
+             .cell(window.wakeups * 1000.0f / window.milliseconds, 1);
+        table.endRow();
+    }
+}
+
+void setup() {
+    Serial.begin(BAUD_RATE);
+    
+    CLIConfig config;
+    config.prompt = "wakeup";
+    config.welcomeMessage = "Wakeup measurement, mode: " + String(MODE);
+    config.baudRate = BAUD_RATE;
+    cli.setConfig(config);
+    
+    cli.registerCommand("wakeups", "update() runs per second over the last windows", "wakeups",
+                        handleWakeupsCommand, "Power");
+
+#if CLI_EVENT_MODE
+    cli.beginTask();
+#else
+    cli.begin();
+#endif
+    windowStart = millis();
+    windowWakeups = cli.getWakeups();
+}
+
+void loop() {
+#if CLI_EVENT_MODE
+    // The CLI task runs on its own; loop() only wakes to take the samples
+    sampleWakeups();
+    delay(1000);
+#else
+    cli.update();
+    sampleWakeups();
+    delay(1);
+#endif
+}
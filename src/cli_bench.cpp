@@ -0,0 +1,350 @@
+#include "cli_bench.h"
+#include "cli_codec.h"
+#include "cli_widgets.h"
+#include <algorithm>
+
+// With heap hooks enabled in the IDF config (CONFIG_HEAP_USE_HOOKS) every
+// successful allocation is counted, from any task. Define
+// CLI_BENCH_NO_HEAP_HOOKS if the application implements the hooks itself.
+static volatile uint32_t heapAllocations = 0;
+
+#if defined(CONFIG_HEAP_USE_HOOKS) && !defined(CLI_BENCH_NO_HEAP_HOOKS)
+#define CLI_BENCH_COUNTS_ALLOCATIONS 1
+
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    heapAllocations = heapAllocations + 1;
+}
+
+extern "C" void esp_heap_trace_free_hook(void* ptr) {}
+#else
+#define CLI_BENCH_COUNTS_ALLOCATIONS 0
+#endif
+
+namespace CLIBench {
+
+    // Results are summed into this so the compiler cannot drop the work
+    static volatile size_t sink = 0;
+    
+    // Nanoseconds per operation for count calls of format(i)
+    template<typename Format>
+    static uint32_t measure(size_t count, Format format) {
+        size_t total = 0;
+        uint32_t start = micros();
+        for (size_t i = 0; i < count; i++) {
+            total += format(i);
+        }
+        uint32_t elapsed = micros() - start;
+        sink = sink + total;
+        return (uint32_t)((uint64_t)elapsed * 1000 / count);
+    }
+    
+    static void printRow(GenericCLI& cli, const char* label, uint32_t string, uint32_t printf, uint32_t table) {
+        Stream& io = cli.getStream();
+        io.print(label);
+        cli.printNum(string, 10);
+        cli.printNum(printf, 12);
+        cli.printNum(table, 12);
+        io.print("  x");
+        cli.printFixed(table > 0 ? (float)printf / table : 0, 1);
+        io.println();
+    }
+    
+    static void handleFormatBench(GenericCLI& cli, const CLIArgs& args) {
+        long requested = args.getFlag("count", "10000").toInt();
+        size_t count = (size_t)std::min(1000000L, std::max(100L, requested));
+        char buffer[CLIFormat::NUMBER_SIZE];
+        
+        // Inputs vary per call so no result can be cached
+        auto integer = [](size_t i) { return (uint32_t)(i * 2654435761u) >> (i & 15); };
+        auto reading = [](size_t i) { return (float)(int32_t)(i * 7919 % 200000 - 100000) / 97.0f; };
+        auto size = [](size_t i) { return (uint32_t)(i * 2654435761u) >> (i & 7); };
+        
+        cli.printInfo("Formatting " + String((unsigned long)count) + " values per case (ns per value)");
+        cli.println("              String    snprintf   CLIFormat  vs snprintf");
+        
+        printRow(cli, "integer   ",
+            measure(count, [&](size_t i) { return String(integer(i)).length(); }),
+            measure(count, [&](size_t i) {
+                return (size_t)snprintf(buffer, sizeof(buffer), "%lu", (unsigned long)integer(i));
+            }),
+            measure(count, [&](size_t i) {
+                return (size_t)(CLIFormat::formatUnsigned(buffer, integer(i)) - buffer);
+            }));
+        
+        printRow(cli, "fixed .2  ",
+            measure(count, [&](size_t i) { return String(reading(i), 2).length(); }),
+            measure(count, [&](size_t i) {
+                return (size_t)snprintf(buffer, sizeof(buffer), "%.2f", reading(i));
+            }),
+            measure(count, [&](size_t i) {
+                return (size_t)(CLIFormat::formatFixed(buffer, reading(i), 2) - buffer);
+            }));
+        
+        // What handlers did before: scale by hand, then format a float
+        printRow(cli, "bytes     ",
+            measure(count, [&](size_t i) { return (String(size(i) / 1024.0, 1) + " KB").length(); }),
+            measure(count, [&](size_t i) {
+                return (size_t)snprintf(buffer, sizeof(buffer), "%.1f KB", size(i) / 1024.0);
+            }),
+            measure(count, [&](size_t i) {
+                return (size_t)(CLIFormat::formatBytes(buffer, size(i)) - buffer);
+            }));
+    }
+    
+    // ========================================================================
+    // TIME / REPEAT
+    // ========================================================================
+    
+    // Counts what a command writes and passes it on unless muted. Input is
+    // read from the real stream, so Ctrl-C checks keep working.
+    class OutputTap : public Stream {
+    public:
+        OutputTap(Stream& output, bool mute) : target(output), muted(mute), bytes(0) {}
+        
+        int available() override { return target.available(); }
+        int read() override { return target.read(); }
+        int peek() override { return target.peek(); }
+        void flush() override { target.flush(); }
+        using Print::write;
+        
+        size_t write(uint8_t value) override {
+            bytes++;
+            return muted ? 1 : target.write(value);
+        }
+        
+        size_t write(const uint8_t* buffer, size_t size) override {
+            bytes += size;
+            return muted ? size : target.write(buffer, size);
+        }
+        
+        Stream& target;
+        bool muted;
+        size_t bytes;
+    };
+    
+    struct Run {
+        uint32_t micros;
+        uint32_t cycles;
+        size_t bytes;
+    };
+    
+    static Run runCommand(GenericCLI& cli, const String& commandLine, bool muted) {
+        OutputTap tap(cli.getStream(), muted);
+        Stream* previous = cli.swapStream(&tap);
+        
+        Run run;
+        uint32_t cyclesBefore = ESP.getCycleCount();
+        uint32_t start = micros();
+        cli.executeCommand(commandLine);
+        run.micros = micros() - start;
+        run.cycles = ESP.getCycleCount() - cyclesBefore;
+        
+        cli.swapStream(previous);
+        run.bytes = tap.bytes;
+        return run;
+    }
+    
+    static void printHeapDelta(GenericCLI& cli, uint32_t before, uint32_t after) {
+        Stream& io = cli.getStream();
+        io.print("heap    ");
+        if (before >= after) {
+            cli.printBytes(before - after);
+            io.println(before > after ? " kept" : "");
+        } else {
+            cli.printBytes(after - before);
+            io.println(" released");
+        }
+    }
+    
+    static void handleTime(GenericCLI& cli, const CLIArgs& args) {
+        // The rest of the line as typed, so quoting and flag order survive
+        String commandLine = args.line;
+        if (args.empty()) {
+            cli.printError("Usage: time <command...>");
+            return;
+        }
+        
+        uint32_t heapBefore = ESP.getFreeHeap();
+        Run run = runCommand(cli, commandLine, false);
+        uint32_t heapAfter = ESP.getFreeHeap();
+        
+        Stream& io = cli.getStream();
+        io.println();
+        io.print("real    ");
+        cli.printNum(run.micros);
+        io.println(" us");
+        // The counter wraps after 2^32 cycles (about 18 s at 240 MHz)
+        io.print("cycles  ");
+        if ((uint64_t)run.micros * ESP.getCpuFreqMHz() < 0xFFFFFFFFull) {
+            cli.printNum(run.cycles);
+            io.println();
+        } else {
+            io.println("(wrapped)");
+        }
+        printHeapDelta(cli, heapBefore, heapAfter);
+        io.print("output  ");
+        cli.printBytes(run.bytes);
+        io.println();
+    }
+    
+    static void handleRepeat(GenericCLI& cli, const CLIArgs& args) {
+        long requested = args.getPositional(0).toInt();
+        String commandLine = args.lineAfter(1);
+        if (args.size() < 2 || requested < 1) {
+            cli.printError("Usage: repeat <n> <command...>");
+            return;
+        }
+        size_t count = (size_t)std::min(requested, (long)MAX_REPEAT);
+        
+        uint32_t* times = (uint32_t*)malloc(count * sizeof(uint32_t));
+        if (times == nullptr) {
+            cli.printError("Not enough memory for " + String((unsigned long)count) + " runs");
+            return;
+        }
+        
+        Stream& io = cli.getStream();
+        uint32_t heapBefore = ESP.getFreeHeap();
+        uint64_t total = 0;
+        size_t bytes = 0;
+        size_t runs = 0;
+        while (runs < count) {
+            // Ctrl-C stops early; the runs so far are still reported
+            if (io.peek() == 0x03) {
+                io.read();
+                break;
+            }
+            Run run = runCommand(cli, commandLine, true);
+            times[runs++] = run.micros;
+            total += run.micros;
+            bytes += run.bytes;
+        }
+        uint32_t heapAfter = ESP.getFreeHeap();
+        
+        if (runs == 0) {
+            free(times);
+            return;
+        }
+        std::sort(times, times + runs);
+        size_t p99 = (runs * 99 + 99) / 100 - 1;
+        
+        cli.printInfo(String((unsigned long)runs) + " runs of '" + commandLine + "', output muted");
+        {
+            CLITable table(io);
+            table.column("Min us", 0, CLIAlign::RIGHT).column("Mean us", 0, CLIAlign::RIGHT)
+                 .column("P99 us", 0, CLIAlign::RIGHT).column("Max us", 0, CLIAlign::RIGHT)
+                 .column("Output/run", 0, CLIAlign::RIGHT);
+            table.cell(times[0]).cell((float)total / runs, 1).cell(times[p99]).cell(times[runs - 1])
+                 .cell((unsigned long)(bytes / runs));
+            table.endRow();
+        }
+        printHeapDelta(cli, heapBefore, heapAfter);
+        free(times);
+    }
+    
+    // ========================================================================
+    // CLIBENCH
+    // ========================================================================
+    
+    // Friend of GenericCLI
+    class Internals {
+    public:
+        static void run(GenericCLI& cli, const CLIArgs& args);
+    
+    private:
+        template<typename Operation>
+        static void row(CLITable& table, const char* name, size_t count, Operation operation) {
+            uint32_t allocationsBefore = heapAllocations;
+            uint32_t ns = measure(count, operation);
+            uint32_t allocated = heapAllocations - allocationsBefore;
+            
+            table.cell(name).cell(ns);
+            if (CLI_BENCH_COUNTS_ALLOCATIONS) {
+                table.cell((float)allocated / count, 2);
+            } else {
+                table.cell("-");
+            }
+            table.endRow();
+        }
+    };
+    
+    void Internals::run(GenericCLI& cli, const CLIArgs& args) {
+        long requested = args.getFlag("count", "2000").toInt();
+        size_t count = (size_t)std::min(100000L, std::max(100L, requested));
+        
+        // Representative input: short commands, flags, quoted values
+        static const char* const lines[] = {
+            "led on",
+            "gpio write 5 1 --force",
+            "wifi connect \"Home Network\" secret --timeout=15",
+            "ts export sensors --points=200 --channel=temperature --json"
+        };
+        const size_t lineCount = sizeof(lines) / sizeof(lines[0]);
+        std::vector<String> inputs(lines, lines + lineCount);
+        std::vector<String> names;
+        for (const CLICommand& command : cli.commands) {
+            names.push_back(command.name);
+        }
+        if (names.empty()) {
+            names.push_back("help");
+        }
+        String miss = "nosuchcommand";
+        String message = "Configuration saved to flash";
+        
+        cli.printInfo(String((unsigned long)count) + " operations per case" +
+                      (CLI_BENCH_COUNTS_ALLOCATIONS ? "" : " (allocations need CONFIG_HEAP_USE_HOOKS)"));
+        Stream& io = cli.getStream();
+        CLITable table(io);
+        table.column("Case").column("ns/op", 0, CLIAlign::RIGHT).column("allocs/op", 0, CLIAlign::RIGHT);
+        
+        row(table, "parseArguments", count, [&](size_t i) {
+            return cli.parseArguments(inputs[i % lineCount]).size();
+        });
+        row(table, "findCommand hit", count, [&](size_t i) {
+            return (size_t)(cli.findCommand(names[i % names.size()]) != nullptr);
+        });
+        row(table, "findCommand miss", count, [&](size_t i) {
+            return (size_t)(cli.findCommand(miss) != nullptr);
+        });
+        row(table, "formatMessage", count, [&](size_t i) {
+            return cli.formatMessage(MessageType::INFO, message).length();
+        });
+        
+        // On a copy of the history, which is put back afterwards
+        std::deque<String> savedHistory = cli.commandHistory;
+        row(table, "addToHistory", count, [&](size_t i) {
+            cli.addToHistory(inputs[i % lineCount]);
+            return cli.commandHistory.size();
+        });
+        cli.commandHistory.swap(savedHistory);
+        
+        // A 200 character line with the cursor in the middle, written to a sink
+        String savedInput = cli.inputBuffer;
+        size_t savedCursor = cli.cursorPos;
+        OutputTap sink(io, true);
+        Stream* previous = cli.swapStream(&sink);
+        cli.inputBuffer = "";
+        while (cli.inputBuffer.length() < 200) {
+            cli.inputBuffer += inputs[cli.inputBuffer.length() % lineCount];
+            cli.inputBuffer += ' ';
+        }
+        cli.cursorPos = cli.inputBuffer.length() / 2;
+        row(table, "redrawInputLine", count, [&](size_t i) {
+            cli.redrawInputLine(cli.cursorPos);
+            return sink.bytes;
+        });
+        cli.swapStream(previous);
+        cli.inputBuffer = savedInput;
+        cli.cursorPos = savedCursor;
+    }
+    
+    void registerBenchCommands(GenericCLI& cli) {
+        cli.registerCommand("fmtbench", "Benchmark number formatting", "fmtbench [--count=N]",
+            [&cli](const CLIArgs& args) { handleFormatBench(cli, args); }, "Debug");
+        cli.registerCommand("time", "Measure one run of a command", "time <command...>",
+            [&cli](const CLIArgs& args) { handleTime(cli, args); }, "Debug");
+        cli.registerCommand("repeat", "Run a command n times and time it", "repeat <n> <command...>",
+            [&cli](const CLIArgs& args) { handleRepeat(cli, args); }, "Debug");
+        cli.registerCommand("clibench", "Benchmark the CLI's own hot paths", "clibench [--count=N]",
+            [&cli](const CLIArgs& args) { Internals::run(cli, args); }, "Debug");
+    }
+}
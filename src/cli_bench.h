@@ -0,0 +1,47 @@
+#ifndef CLI_BENCH_H
+#define CLI_BENCH_H
+
+#include "generic_cli.h"
+
+/**
+ * Benchmark Commands
+ * 
+ * On-target measurements of the library's own hot paths, for checking an
+ * optimization on real hardware rather than on the host:
+ * 
+ *   fmtbench [--count=N]      Number formatting: String vs snprintf vs
+ *                             CLIFormat (printNum/printFixed/printBytes)
+ *   time <command...>         Runs a command once and reports wall time,
+ *                             CPU cycles, heap kept and bytes written
+ *   repeat <n> <command...>   Runs a command n times with its output muted
+ *                             and reports min/mean/p99/max time per run
+ *   clibench [--count=N]      Argument parsing, command lookup, message
+ *                             formatting, history and line redraw, timed
+ *                             in place (ns/op and allocations/op)
+ * 
+ * time and repeat run the rest of their line exactly as typed, quotes and
+ * flag order included.
+ * 
+ * fmtbench and clibench report nanoseconds per operation from micros(), so
+ * use a count large enough for a case to take a few milliseconds.
+ * Allocations are counted only when the IDF heap hooks are enabled
+ * (CONFIG_HEAP_USE_HOOKS); cli_bench.cpp then implements them, unless
+ * CLI_BENCH_NO_HEAP_HOOKS is defined.
+ * 
+ * time and repeat go through executeCommand(), so parsing and dispatch are
+ * part of the measurement. Output is counted through swapStream(), so
+ * text a handler writes to Serial directly instead of cli.getStream() is
+ * neither counted nor muted. Work a command leaves to a foreground job is
+ * not included.
+ * 
+ * Usage:
+ *   CLIBench::registerBenchCommands(cli);
+ */
+
+namespace CLIBench {
+    const size_t MAX_REPEAT = 10000;
+    
+    void registerBenchCommands(GenericCLI& cli);
+}
+
+#endif // CLI_BENCH_H
@@ -0,0 +1,496 @@
+#include "cli_codec.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace CLICodec {
+    
+    // Table for polynomial 0x1021, one entry per high byte
+    static const uint16_t crcTable[256] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+        0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+        0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+        0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+        0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+        0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+        0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+        0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+        0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+        0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+        0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+        0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+        0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+        0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+        0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+        0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+        0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+        0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+        0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+        0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+        0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+        0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+        0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+    };
+    
+    uint16_t crc16Update(uint16_t crc, uint8_t byte) {
+        return (crc << 8) ^ crcTable[((crc >> 8) ^ byte) & 0xFF];
+    }
+    
+    uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc) {
+        for (size_t i = 0; i < length; i++) {
+            crc = (crc << 8) ^ crcTable[((crc >> 8) ^ data[i]) & 0xFF];
+        }
+        return crc;
+    }
+}
+
+// ========================================================================
+// DECIMAL FORMATTING
+// ========================================================================
+
+namespace CLIFormat {
+    
+    static const char digitPairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233"
+        "34353637383940414243444546474849505152535455565758596061626364656667"
+        "6869707172737475767778798081828384858687888990919293949596979899";
+    
+    static const uint32_t powersOf10[MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    
+    static inline char* putPair(char* out, uint32_t pair) {
+        out[0] = digitPairs[pair * 2];
+        out[1] = digitPairs[pair * 2 + 1];
+        return out + 2;
+    }
+    
+    // Exactly `digits` digits, zero padded
+    static char* formatPadded(char* out, uint32_t value, uint8_t digits) {
+        char* end = out + digits;
+        char* p = end;
+        while (p - out >= 2) {
+            p -= 2;
+            putPair(p, value % 100);
+            value /= 100;
+        }
+        if (p > out) {
+            *--p = '0' + value % 10;
+        }
+        return end;
+    }
+    
+    static char* formatU32(char* out, uint32_t value) {
+        char digits[10];
+        char* p = digits + sizeof(digits);
+        while (value >= 100) {
+            p -= 2;
+            putPair(p, value % 100);
+            value /= 100;
+        }
+        if (value >= 10) {
+            p -= 2;
+            putPair(p, value);
+        } else {
+            *--p = '0' + value;
+        }
+        size_t length = digits + sizeof(digits) - p;
+        memcpy(out, p, length);
+        return out + length;
+    }
+    
+    char* formatUnsigned(char* out, uint64_t value) {
+        if (value <= UINT32_MAX) {
+            return formatU32(out, (uint32_t)value);
+        }
+        // 64-bit division is a library call on 32-bit cores: split into
+        // 8-digit chunks and format those with 32-bit arithmetic
+        out = formatUnsigned(out, value / 100000000);
+        return formatPadded(out, (uint32_t)(value % 100000000), 8);
+    }
+    
+    char* formatSigned(char* out, int64_t value) {
+        if (value < 0) {
+            *out++ = '-';
+            return formatUnsigned(out, 0 - (uint64_t)value);
+        }
+        return formatUnsigned(out, (uint64_t)value);
+    }
+    
+    char* formatFixed(char* out, float value, uint8_t decimals) {
+        if (value != value) {
+            memcpy(out, "nan", 3);
+            return out + 3;
+        }
+        if (signbit(value)) {
+            // Also for -0.0 and values that round to zero, as printf does
+            *out++ = '-';
+            value = -value;
+        }
+        if (isinf(value)) {
+            memcpy(out, "inf", 3);
+            return out + 3;
+        }
+        if (decimals > MAX_DECIMALS) {
+            decimals = MAX_DECIMALS;
+        }
+        if (value >= 1.8e19f) {
+            // Past 64 bits
+            return out + snprintf(out, NUMBER_SIZE - 1, "%.*e", decimals, value);
+        }
+        
+        // Splitting off the integer part is exact, so only the fraction is
+        // rounded; floats of 2^24 and up have no fraction at all
+        uint64_t whole;
+        float fraction;
+        if (value < 4294967296.0f) {
+            uint32_t integer = (uint32_t)value;
+            whole = integer;
+            fraction = value - (float)integer;
+        } else {
+            whole = (uint64_t)value;
+            fraction = 0;
+        }
+        
+        // A float has 24 significant bits and scale is below 2^20, so the
+        // product is exact in double and ties are real ties. They go to
+        // the even digit, like printf.
+        uint32_t scale = powersOf10[decimals];
+        double scaled = (double)fraction * scale;
+        uint32_t digits = (uint32_t)scaled;
+        double rest = scaled - digits;
+        bool odd = decimals > 0 ? (digits & 1) : (whole & 1);
+        if (rest > 0.5 || (rest == 0.5 && odd)) {
+            digits++;
+        }
+        if (digits >= scale) {
+            whole++;
+            digits -= scale;
+        }
+        
+        out = formatUnsigned(out, whole);
+        if (decimals > 0) {
+            *out++ = '.';
+            out = formatPadded(out, digits, decimals);
+        }
+        return out;
+    }
+    
+    char* formatBytes(char* out, uint64_t bytes) {
+        static const char* const units[] = { "KB", "MB", "GB", "TB" };
+        if (bytes < 1024) {
+            out = formatU32(out, (uint32_t)bytes);
+            memcpy(out, " B", 2);
+            return out + 2;
+        }
+        
+        // Tenths of the unit, rounded; 1023.96 KB becomes 1.0 MB. Whole
+        // units and the remainder are scaled separately, bytes * 10 would
+        // overflow above 1.8e18.
+        uint8_t unit = 0;
+        uint64_t tenths = 0;
+        while (true) {
+            unsigned shift = 10 * (unit + 1);
+            uint64_t remainder = bytes & (((uint64_t)1 << shift) - 1);
+            tenths = (bytes >> shift) * 10 + ((remainder * 10 + ((uint64_t)1 << (shift - 1))) >> shift);
+            if (tenths < 10240 || unit == 3) break;
+            unit++;
+        }
+        
+        out = formatUnsigned(out, tenths / 10);
+        *out++ = '.';
+        *out++ = '0' + tenths % 10;
+        *out++ = ' ';
+        memcpy(out, units[unit], 2);
+        return out + 2;
+    }
+}
+
+// ========================================================================
+// VARINTS
+// ========================================================================
+
+namespace CLIVarint {
+    
+    size_t put(uint8_t* out, uint32_t value) {
+        size_t length = 0;
+        while (value >= 0x80) {
+            out[length++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        out[length++] = (uint8_t)value;
+        return length;
+    }
+    
+    size_t get(const uint8_t* in, size_t available, uint32_t* value) {
+        uint32_t result = 0;
+        for (size_t i = 0; i < available && i < MAX_SIZE; i++) {
+            result |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+            if ((in[i] & 0x80) == 0) {
+                // The fifth byte only has 4 bits left for a 32-bit value
+                if (i == MAX_SIZE - 1 && in[i] > 0x0F) {
+                    return 0;
+                }
+                *value = result;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+}
+
+// ========================================================================
+// HEX FORMATTING
+// ========================================================================
+
+namespace CLIHex {
+    
+    // Both digits of every byte value, so each byte is a single two-char copy
+    static const char hexPairs[513] =
+        "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+        "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+        "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+        "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+        "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+        "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+        "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+        "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+    
+    char* formatByte(char* out, uint8_t value) {
+        out[0] = hexPairs[value * 2];
+        out[1] = hexPairs[value * 2 + 1];
+        return out + 2;
+    }
+    
+    char* formatWord(char* out, uint32_t value) {
+        out = formatByte(out, value >> 24);
+        out = formatByte(out, (value >> 16) & 0xFF);
+        out = formatByte(out, (value >> 8) & 0xFF);
+        return formatByte(out, value & 0xFF);
+    }
+    
+    size_t formatRow(char* line, uint32_t address, const uint8_t* data, size_t count) {
+        if (count > ROW_BYTES) {
+            count = ROW_BYTES;
+        }
+        
+        char* out = formatWord(line, address);
+        *out++ = ' ';
+        *out++ = ' ';
+        for (size_t i = 0; i < ROW_BYTES; i++) {
+            if (i < count) {
+                out = formatByte(out, data[i]);
+            } else {
+                *out++ = ' ';
+                *out++ = ' ';
+            }
+            *out++ = ' ';
+            if (i == 7) {
+                *out++ = ' ';
+            }
+        }
+        
+        *out++ = ' ';
+        *out++ = '|';
+        for (size_t i = 0; i < count; i++) {
+            uint8_t c = data[i];
+            *out++ = (c >= 0x20 && c < 0x7F) ? (char)c : '.';
+        }
+        *out++ = '|';
+        *out++ = '\r';
+        *out++ = '\n';
+        *out = '\0';
+        return out - line;
+    }
+}
+
+// ========================================================================
+// SHA-256
+// ========================================================================
+
+static const uint32_t sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+CLISha256::CLISha256() {
+    reset();
+}
+
+void CLISha256::reset() {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    for (int i = 0; i < 8; i++) state[i] = initial[i];
+    totalLength = 0;
+    buffered = 0;
+}
+
+void CLISha256::transform(const uint8_t block[64]) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void CLISha256::update(const uint8_t* data, size_t length) {
+    totalLength += length;
+    
+    // Top up a partial block first, then hash whole blocks straight from the input
+    if (buffered > 0) {
+        while (length > 0 && buffered < 64) {
+            buffer[buffered++] = *data++;
+            length--;
+        }
+        if (buffered < 64) return;
+        transform(buffer);
+        buffered = 0;
+    }
+    while (length >= 64) {
+        transform(data);
+        data += 64;
+        length -= 64;
+    }
+    while (length > 0) {
+        buffer[buffered++] = *data++;
+        length--;
+    }
+}
+
+void CLISha256::finish(uint8_t digest[DIGEST_SIZE]) {
+    uint64_t bits = totalLength * 8;
+    
+    buffer[buffered++] = 0x80;
+    if (buffered > 56) {
+        while (buffered < 64) buffer[buffered++] = 0;
+        transform(buffer);
+        buffered = 0;
+    }
+    while (buffered < 56) buffer[buffered++] = 0;
+    for (int i = 7; i >= 0; i--) {
+        buffer[buffered++] = (uint8_t)(bits >> (i * 8));
+    }
+    transform(buffer);
+    
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = state[i] >> 24;
+        digest[i * 4 + 1] = (state[i] >> 16) & 0xFF;
+        digest[i * 4 + 2] = (state[i] >> 8) & 0xFF;
+        digest[i * 4 + 3] = state[i] & 0xFF;
+    }
+    reset();
+}
+
+// ========================================================================
+// CHANNEL FRAMES
+// ========================================================================
+
+namespace CLIFrame {
+    
+    uint16_t encode(uint8_t* header, uint8_t channel, const uint8_t* payload, uint8_t length) {
+        header[0] = SYNC1;
+        header[1] = SYNC2;
+        header[2] = channel;
+        header[3] = length;
+        uint16_t crc = CLICodec::crc16(header + 2, 2);
+        return CLICodec::crc16(payload, length, crc);
+    }
+}
+
+CLIFrameDecoder::CLIFrameDecoder() : errors(0) {
+    reset();
+}
+
+void CLIFrameDecoder::reset() {
+    state = State::SYNC1;
+    frameChannel = 0;
+    frameLength = 0;
+    received = 0;
+    crc = 0xFFFF;
+}
+
+bool CLIFrameDecoder::feed(uint8_t byte) {
+    switch (state) {
+        case State::SYNC1:
+            if (byte == CLIFrame::SYNC1) state = State::SYNC2;
+            return false;
+            
+        case State::SYNC2:
+            if (byte == CLIFrame::SYNC2) state = State::CHANNEL;
+            else if (byte != CLIFrame::SYNC1) state = State::SYNC1;
+            return false;
+            
+        case State::CHANNEL:
+            frameChannel = byte;
+            crc = CLICodec::crc16Update(0xFFFF, byte);
+            state = State::LENGTH;
+            return false;
+            
+        case State::LENGTH:
+            frameLength = byte;
+            received = 0;
+            crc = CLICodec::crc16Update(crc, byte);
+            state = (frameLength > 0) ? State::PAYLOAD : State::CRC_HIGH;
+            return false;
+            
+        case State::PAYLOAD:
+            buffer[received++] = byte;
+            crc = CLICodec::crc16Update(crc, byte);
+            if (received == frameLength) state = State::CRC_HIGH;
+            return false;
+            
+        case State::CRC_HIGH:
+            if (byte != (crc >> 8)) {
+                errors++;
+                state = (byte == CLIFrame::SYNC1) ? State::SYNC2 : State::SYNC1;
+                return false;
+            }
+            state = State::CRC_LOW;
+            return false;
+            
+        case State::CRC_LOW:
+            state = State::SYNC1;
+            if (byte != (crc & 0xFF)) {
+                errors++;
+                if (byte == CLIFrame::SYNC1) state = State::SYNC2;
+                return false;
+            }
+            return true;
+    }
+    return false;
+}
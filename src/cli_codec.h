@@ -0,0 +1,248 @@
+#ifndef CLI_CODEC_H
+#define CLI_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Portable Encoding Helpers
+ * 
+ * Checksums and framing shared by the library and the host tools in
+ * tools/. Nothing in this file depends on Arduino, so host programs can
+ * compile cli_codec.cpp as is.
+ */
+
+namespace CLICodec {
+    
+    // CRC-16 with polynomial 0x1021, table driven.
+    // init 0xFFFF gives CRC-16/CCITT-FALSE, init 0 gives CRC-16/XMODEM.
+    uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+    uint16_t crc16Update(uint16_t crc, uint8_t byte);
+}
+
+// Variable length integers: 7 bits per byte, least significant group first,
+// high bit set on all but the last byte (LEB128). Zigzag maps small signed
+// values to small unsigned ones (0, -1, 1, -2 -> 0, 1, 2, 3).
+namespace CLIVarint {
+    const size_t MAX_SIZE = 5;          // Bytes for a 32-bit value
+    
+    inline uint32_t zigzag(int32_t value) {
+        return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    }
+    
+    inline int32_t unzigzag(uint32_t value) {
+        return (int32_t)((value >> 1) ^ (0u - (value & 1)));
+    }
+    
+    // Returns the bytes written (1 to MAX_SIZE)
+    size_t put(uint8_t* out, uint32_t value);
+    
+    // Returns the bytes consumed, 0 if the input ends early or is overlong
+    size_t get(const uint8_t* in, size_t available, uint32_t* value);
+}
+
+// Hex dump rows: "00000010  48 65 6C 6C 6F 0A                                 |Hello.|"
+// Formatting is table driven and writes into a caller supplied buffer, so a
+// whole row goes out with one write and nothing is allocated.
+namespace CLIHex {
+    const size_t ROW_BYTES = 16;
+    const size_t ROW_LINE_SIZE = 81;    // Longest row including CR LF and NUL
+    
+    // Formats up to ROW_BYTES bytes, short rows are padded to keep the ASCII
+    // column aligned. Returns the length written, excluding the NUL.
+    size_t formatRow(char* line, uint32_t address, const uint8_t* data, size_t count);
+    
+    // Two uppercase hex digits, not NUL terminated; returns out + 2
+    char* formatByte(char* out, uint8_t value);
+    
+    // Eight hex digits, not NUL terminated; returns out + 8
+    char* formatWord(char* out, uint32_t value);
+}
+
+// Decimal number formatting without printf or String: two digits per table
+// lookup and integer arithmetic throughout. Functions write into a caller
+// supplied buffer (NUMBER_SIZE is always enough), do not NUL terminate and
+// return the end of what they wrote.
+namespace CLIFormat {
+    const size_t NUMBER_SIZE = 32;
+    const uint8_t MAX_DECIMALS = 6;
+    
+    char* formatUnsigned(char* out, uint64_t value);
+    char* formatSigned(char* out, int64_t value);
+    
+    // value rounded to decimals places (at most MAX_DECIMALS), with the
+    // same digits as "%.2f": rounding is done on the exact value of the
+    // float, ties to even, and the sign of -0.0 is kept. nan and inf print
+    // as such; values of 1.8e19 and up use "%e" to fit NUMBER_SIZE.
+    char* formatFixed(char* out, float value, uint8_t decimals = 2);
+    
+    // Human readable size with 1024 based units: "512 B", "1.5 KB", "3.2 MB"
+    char* formatBytes(char* out, uint64_t bytes);
+}
+
+// Incremental SHA-256 (FIPS 180-4), for verifying images as they stream in
+class CLISha256 {
+public:
+    static const size_t DIGEST_SIZE = 32;
+    
+    CLISha256();
+    
+    void reset();
+    void update(const uint8_t* data, size_t length);
+    void finish(uint8_t digest[DIGEST_SIZE]);
+    
+private:
+    void transform(const uint8_t block[64]);
+    
+    uint32_t state[8];
+    uint64_t totalLength;
+    uint8_t buffer[64];
+    size_t buffered;
+};
+
+// ========================================================================
+// CHANNEL FRAMES
+// ========================================================================
+//
+//   +------+------+---------+--------+-----------------+-----------+
+//   | 0xA5 | 0x5A | channel | length | payload (0-255) | CRC16 (BE)|
+//   +------+------+---------+--------+-----------------+-----------+
+//
+// The CRC (CCITT-FALSE) covers channel, length and payload. A receiver that
+// loses sync hunts for the next 0xA5 0x5A and relies on the CRC to reject
+// false starts.
+
+namespace CLIFrame {
+    const uint8_t SYNC1 = 0xA5;
+    const uint8_t SYNC2 = 0x5A;
+    const size_t HEADER_SIZE = 4;
+    const size_t CRC_SIZE = 2;
+    const size_t MAX_PAYLOAD = 255;
+    
+    // Fills header[HEADER_SIZE] and returns the CRC to append after the payload
+    uint16_t encode(uint8_t* header, uint8_t channel, const uint8_t* payload, uint8_t length);
+}
+
+class CLIFrameDecoder {
+public:
+    CLIFrameDecoder();
+    
+    // Feed one received byte; returns true when a complete, valid frame is available
+    bool feed(uint8_t byte);
+    void reset();
+    
+    uint8_t channel() const { return frameChannel; }
+    uint8_t length() const { return frameLength; }
+    const uint8_t* payload() const { return buffer; }
+    
+    uint32_t crcErrors() const { return errors; }
+    
+private:
+    enum class State : uint8_t { SYNC1, SYNC2, CHANNEL, LENGTH, PAYLOAD, CRC_HIGH, CRC_LOW };
+    
+    State state;
+    uint8_t frameChannel;
+    uint8_t frameLength;
+    uint8_t received;
+    uint16_t crc;
+    uint8_t buffer[CLIFrame::MAX_PAYLOAD];
+    uint32_t errors;
+};
+
+// ========================================================================
+// OTA FRAMES
+// ========================================================================
+//
+// Firmware upload over channel frames. Every data frame carries its image
+// offset, so the device can acknowledge progress and ask for a resend from
+// the first missing byte (go-back-N). All integers are little endian.
+
+namespace CLIOtaFrame {
+    // Host -> device
+    const uint8_t BEGIN = 0x01;     // image size (u32), SHA-256 (32 bytes)
+    const uint8_t DATA = 0x02;      // offset (u32), image bytes
+    const uint8_t END = 0x03;       // no payload
+    const uint8_t ABORT = 0x04;     // no payload
+    
+    // Device -> host
+    const uint8_t ACK = 0x81;       // next expected offset (u32), window (u8)
+    const uint8_t NAK = 0x82;       // next expected offset (u32), resend from there
+    const uint8_t DONE = 0x83;      // status (u8, 0 = success), message text
+    
+    const size_t OFFSET_SIZE = 4;
+    const size_t MAX_CHUNK = CLIFrame::MAX_PAYLOAD - OFFSET_SIZE;
+    
+    inline void putU32(uint8_t* out, uint32_t value) {
+        out[0] = value & 0xFF;
+        out[1] = (value >> 8) & 0xFF;
+        out[2] = (value >> 16) & 0xFF;
+        out[3] = (value >> 24) & 0xFF;
+    }
+    
+    inline uint32_t getU32(const uint8_t* in) {
+        return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+    }
+}
+
+// ========================================================================
+// TIME-SERIES FRAMES
+// ========================================================================
+//
+// Binary export of CLITimeSeries samples in channel frames, one frame type
+// per record. Values are quantized to integers with a per-channel number
+// of decimals; every DATA frame starts from absolute values and then
+// carries deltas, so a corrupted frame loses only its own samples:
+//
+//   HEADER  version (u8), channels (u8), samples (u32),
+//           per channel: decimals (u8), name length (u8), name
+//   DATA    sample count (u8), then per sample:
+//           timestamp  varint - absolute in the first sample, else delta
+//           values     zigzag varint per channel - absolute, else delta
+//   END     samples sent (u32)
+//
+// Integers in HEADER/END are little endian (CLIOtaFrame::putU32).
+
+namespace CLISeriesFrame {
+    const uint8_t HEADER = 0x21;
+    const uint8_t DATA = 0x22;
+    const uint8_t END = 0x23;
+    
+    const uint8_t VERSION = 1;
+    const size_t MAX_NAME = 16;         // Longer channel names are cut
+    const uint8_t MAX_DECIMALS = 6;
+    
+    // Worst case encoded size of one sample
+    inline size_t maxSampleSize(uint8_t channels) {
+        return CLIVarint::MAX_SIZE * (1 + channels);
+    }
+}
+
+// ========================================================================
+// SESSION RECORDINGS
+// ========================================================================
+//
+// A CLI session as CLISessionRecorder writes it: the magic "CLIS" and a
+// version byte, then records of
+//
+//   kind (u8)       RX - bytes the CLI read, TX - bytes it wrote,
+//                   END - closes the recording (no data)
+//   time (varint)   milliseconds since the previous record
+//   length (varint) at most MAX_RECORD
+//   data
+//
+// Records are in the order the CLI read and wrote, so RX and TX can each
+// be followed on their own.
+
+namespace CLISessionFormat {
+    const uint8_t MAGIC[4] = { 'C', 'L', 'I', 'S' };
+    const uint8_t VERSION = 1;
+    
+    const uint8_t RX = 0x01;
+    const uint8_t TX = 0x02;
+    const uint8_t END = 0x03;
+    
+    const size_t MAX_RECORD = 128;
+    const size_t HEADER_SIZE = 5;
+}
+
+#endif // CLI_CODEC_H
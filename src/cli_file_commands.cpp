@@ -0,0 +1,374 @@
+#include "cli_file_commands.h"
+#include "cli_codec.h"
+
+namespace CLIFileCommands {
+    
+    static const size_t CHUNK_SIZE = 256;
+    static const uint32_t FOLLOW_INTERVAL_MS = 250;
+    
+    // ========================================================================
+    // HELPERS
+    // ========================================================================
+    
+    static String absolutePath(const String& path) {
+        return path.startsWith("/") ? path : "/" + path;
+    }
+    
+    static bool openFile(GenericCLI& cli, fs::FS& filesystem, const String& path, fs::File& file) {
+        file = filesystem.open(path, "r");
+        if (!file) {
+            cli.printError("Cannot open " + path);
+            return false;
+        }
+        if (file.isDirectory()) {
+            file.close();
+            cli.printError(path + " is a directory");
+            return false;
+        }
+        return true;
+    }
+    
+    // Writes text with bare LF line ends turned into CRLF for the terminal.
+    // lastChar carries the previous byte across chunk boundaries.
+    static void writeText(Stream& io, const uint8_t* data, size_t length, uint8_t& lastChar) {
+        size_t start = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (data[i] == '\n' && (i > 0 ? data[i - 1] : lastChar) != '\r') {
+                io.write(data + start, i - start);
+                io.write('\r');
+                start = i;
+            }
+        }
+        io.write(data + start, length - start);
+        if (length > 0) {
+            lastChar = data[length - 1];
+        }
+    }
+    
+    // Streams from the current position to the end of the file
+    static size_t streamRest(Stream& io, fs::File& file, uint8_t& lastChar) {
+        uint8_t buffer[CHUNK_SIZE];
+        size_t total = 0;
+        size_t n;
+        while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+            writeText(io, buffer, n, lastChar);
+            total += n;
+        }
+        return total;
+    }
+    
+    static void finishLine(Stream& io, uint8_t lastChar) {
+        if (lastChar != '\n' && lastChar != 0) {
+            io.println();
+        }
+    }
+    
+    // Position where the last `lines` lines of the file start. Reads
+    // backwards one chunk at a time; a newline ending the file does not
+    // count as an extra (empty) line.
+    static size_t findTailStart(fs::File& file, size_t lines) {
+        uint8_t buffer[CHUNK_SIZE];
+        size_t position = file.size();
+        bool atEnd = true;
+        
+        while (position > 0) {
+            size_t n = std::min(position, CHUNK_SIZE);
+            position -= n;
+            file.seek(position);
+            n = file.read(buffer, n);
+            
+            for (size_t i = n; i-- > 0;) {
+                if (buffer[i] != '\n') {
+                    atEnd = false;
+                    continue;
+                }
+                if (atEnd) {
+                    atEnd = false;
+                    continue;
+                }
+                if (lines-- <= 1) {
+                    return position + i + 1;
+                }
+            }
+        }
+        return 0;
+    }
+    
+    static size_t parseCount(const CLIArgs& args, const char* flag, size_t defaultValue) {
+        String value = args.getFlag(flag);
+        if (value.isEmpty()) {
+            return defaultValue;
+        }
+        // Accept hex offsets as well
+        return value.startsWith("0x") ? strtoul(value.c_str() + 2, nullptr, 16) : strtoul(value.c_str(), nullptr, 10);
+    }
+    
+    // ========================================================================
+    // COMMAND HANDLERS
+    // ========================================================================
+    
+    static void handleLs(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        Stream& io = cli.getStream();
+        String path = absolutePath(args.getPositional(0, "/"));
+        
+        fs::File dir = filesystem.open(path, "r");
+        if (!dir || !dir.isDirectory()) {
+            cli.printError("Not a directory: " + path);
+            return;
+        }
+        
+        size_t files = 0;
+        size_t bytes = 0;
+        fs::File entry = dir.openNextFile();
+        while (entry) {
+            if (entry.isDirectory()) {
+                io.printf("%10s  %s/\r\n", "<dir>", entry.name());
+            } else {
+                io.printf("%10u  %s\r\n", (unsigned)entry.size(), entry.name());
+                files++;
+                bytes += entry.size();
+            }
+            entry.close();
+            entry = dir.openNextFile();
+        }
+        dir.close();
+        io.printf("%u file(s), %u bytes\r\n", (unsigned)files, (unsigned)bytes);
+    }
+    
+    static void handleCat(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (args.empty()) {
+            cli.printError("Usage: cat <file>");
+            return;
+        }
+        fs::File file;
+        if (!openFile(cli, filesystem, absolutePath(args.getPositional(0)), file)) {
+            return;
+        }
+        uint8_t lastChar = 0;
+        streamRest(cli.getStream(), file, lastChar);
+        finishLine(cli.getStream(), lastChar);
+        file.close();
+    }
+    
+    static void handleHead(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (args.empty()) {
+            cli.printError("Usage: head [--lines=N] <file>");
+            return;
+        }
+        fs::File file;
+        if (!openFile(cli, filesystem, absolutePath(args.getPositional(0)), file)) {
+            return;
+        }
+        
+        Stream& io = cli.getStream();
+        size_t lines = parseCount(args, "lines", 10);
+        uint8_t buffer[CHUNK_SIZE];
+        uint8_t lastChar = 0;
+        size_t n;
+        while (lines > 0 && (n = file.read(buffer, sizeof(buffer))) > 0) {
+            // Cut the chunk after the last wanted newline
+            size_t end = 0;
+            while (end < n && lines > 0) {
+                if (buffer[end++] == '\n') {
+                    lines--;
+                }
+            }
+            writeText(io, buffer, end, lastChar);
+        }
+        finishLine(io, lastChar);
+        file.close();
+    }
+    
+    static void handleTail(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        // The parser only knows long flags; take the familiar -f as well
+        bool follow = args.hasFlag("follow");
+        String name;
+        for (const String& arg : args.positional) {
+            if (arg == "-f") {
+                follow = true;
+            } else if (arg.startsWith("-")) {
+                cli.printError("Unknown option " + arg + " (use --lines=N, --follow or -f)");
+                return;
+            } else if (name.isEmpty()) {
+                name = arg;
+            }
+        }
+        if (name.isEmpty()) {
+            cli.printError("Usage: tail [--lines=N] [--follow|-f] <file>");
+            return;
+        }
+        String path = absolutePath(name);
+        fs::File file;
+        if (!openFile(cli, filesystem, path, file)) {
+            return;
+        }
+        
+        Stream& io = cli.getStream();
+        size_t lines = parseCount(args, "lines", 10);
+        uint8_t lastChar = 0;
+        if (lines > 0) {
+            file.seek(findTailStart(file, lines));
+            streamRest(io, file, lastChar);
+        }
+        size_t position = file.size();
+        file.close();
+        
+        if (!follow) {
+            finishLine(io, lastChar);
+            return;
+        }
+        
+        // Poll for appended data; reopening picks up writes made through other handles
+        unsigned long lastPoll = millis();
+        cli.startJob([&cli, &filesystem, path, position, lastChar, lastPoll]() mutable {
+            if (millis() - lastPoll < FOLLOW_INTERVAL_MS) {
+                return true;
+            }
+            lastPoll = millis();
+            
+            fs::File file = filesystem.open(path, "r");
+            if (!file) {
+                cli.printWarning(path + " was removed");
+                return false;
+            }
+            size_t size = file.size();
+            if (size < position) {
+                // Truncated or rotated: start over
+                position = 0;
+            }
+            if (size > position) {
+                file.seek(position);
+                position += streamRest(cli.getStream(), file, lastChar);
+            }
+            file.close();
+            return true;
+        });
+    }
+    
+    static void handleHexdump(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (args.empty()) {
+            cli.printError("Usage: hexdump [--offset=N] [--length=N] <file>");
+            return;
+        }
+        fs::File file;
+        if (!openFile(cli, filesystem, absolutePath(args.getPositional(0)), file)) {
+            return;
+        }
+        
+        Stream& io = cli.getStream();
+        size_t offset = parseCount(args, "offset", 0);
+        size_t remaining = parseCount(args, "length", SIZE_MAX);
+        file.seek(offset);
+        
+        uint8_t buffer[CHUNK_SIZE];
+        char line[CLIHex::ROW_LINE_SIZE];
+        size_t n;
+        while (remaining > 0 && (n = file.read(buffer, std::min(remaining, sizeof(buffer)))) > 0) {
+            for (size_t row = 0; row < n; row += CLIHex::ROW_BYTES) {
+                size_t length = CLIHex::formatRow(line, (uint32_t)(offset + row), buffer + row, n - row);
+                io.write((const uint8_t*)line, length);
+            }
+            offset += n;
+            remaining -= n;
+        }
+        file.close();
+    }
+    
+    static void handleRm(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (args.empty()) {
+            cli.printError("Usage: rm <file>");
+            return;
+        }
+        String path = absolutePath(args.getPositional(0));
+        if (!filesystem.exists(path)) {
+            cli.printError("File not found: " + path);
+            return;
+        }
+        if (!filesystem.remove(path)) {
+            cli.printError("Cannot remove " + path);
+            return;
+        }
+        cli.printSuccess("Removed " + path);
+    }
+    
+    static void handleCp(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (args.size() < 2) {
+            cli.printError("Usage: cp <source> <destination>");
+            return;
+        }
+        String source = absolutePath(args.getPositional(0));
+        String destination = absolutePath(args.getPositional(1));
+        if (source == destination) {
+            cli.printError("Source and destination are the same file");
+            return;
+        }
+        
+        fs::File in;
+        if (!openFile(cli, filesystem, source, in)) {
+            return;
+        }
+        fs::File out = filesystem.open(destination, "w");
+        if (!out) {
+            in.close();
+            cli.printError("Cannot create " + destination);
+            return;
+        }
+        
+        uint8_t buffer[CHUNK_SIZE];
+        size_t total = 0;
+        size_t n;
+        bool failed = false;
+        while ((n = in.read(buffer, sizeof(buffer))) > 0) {
+            if (out.write(buffer, n) != n) {
+                failed = true;
+                break;
+            }
+            total += n;
+        }
+        in.close();
+        out.close();
+        
+        if (failed) {
+            filesystem.remove(destination);
+            cli.printError("Write failed (filesystem full?), " + destination + " removed");
+            return;
+        }
+        cli.printSuccess("Copied " + String((unsigned long)total) + " bytes to " + destination);
+    }
+    
+    // ========================================================================
+    // REGISTRATION
+    // ========================================================================
+    
+    void registerFileCommands(GenericCLI& cli, fs::FS& filesystem) {
+        cli.registerCommand("ls", "List files", "ls [path]",
+            [&cli, &filesystem](const CLIArgs& args) { handleLs(cli, filesystem, args); }, "Files");
+        cli.registerCommand("cat", "Print a file", "cat <file>",
+            [&cli, &filesystem](const CLIArgs& args) { handleCat(cli, filesystem, args); }, "Files");
+        cli.registerCommand("head", "Print the first lines of a file", "head [--lines=N] <file>",
+            [&cli, &filesystem](const CLIArgs& args) { handleHead(cli, filesystem, args); }, "Files");
+        cli.registerCommand("tail", "Print the last lines of a file", "tail [--lines=N] [--follow|-f] <file>",
+            [&cli, &filesystem](const CLIArgs& args) { handleTail(cli, filesystem, args); }, "Files");
+        cli.registerCommand("hexdump", "Show file contents in hex", "hexdump [--offset=N] [--length=N] <file>",
+            [&cli, &filesystem](const CLIArgs& args) { handleHexdump(cli, filesystem, args); }, "Files");
+        cli.registerCommand("rm", "Remove a file", "rm <file>",
+            [&cli, &filesystem](const CLIArgs& args) { handleRm(cli, filesystem, args); }, "Files");
+        cli.registerCommand("cp", "Copy a file", "cp <source> <destination>",
+            [&cli, &filesystem](const CLIArgs& args) { handleCp(cli, filesystem, args); }, "Files");
+    }
+    
+#if defined(ESP32)
+    void registerFileCommands(GenericCLI& cli, fs::LittleFSFS& filesystem) {
+        registerFileCommands(cli, static_cast<fs::FS&>(filesystem));
+        
+        cli.registerCommand("df", "Show filesystem usage", "df",
+            [&cli, &filesystem](const CLIArgs& args) {
+                size_t total = filesystem.totalBytes();
+                size_t used = filesystem.usedBytes();
+                cli.getStream().printf("Total: %u bytes\r\nUsed:  %u bytes (%u%%)\r\nFree:  %u bytes\r\n",
+                    (unsigned)total, (unsigned)used, total ? (unsigned)(used * 100 / total) : 0,
+                    (unsigned)(total - used));
+            }, "Files");
+    }
+#endif
+}
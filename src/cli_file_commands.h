@@ -0,0 +1,43 @@
+#ifndef CLI_FILE_COMMANDS_H
+#define CLI_FILE_COMMANDS_H
+
+#include "generic_cli.h"
+#include <FS.h>
+#if defined(ESP32)
+#include <LittleFS.h>
+#endif
+
+/**
+ * File Commands
+ * 
+ * A small shell for the on-board filesystem. File contents are streamed
+ * through the CLI stream in fixed-size chunks, so files of any size can be
+ * shown without buffering them.
+ * 
+ *   ls [path]                               List a directory
+ *   cat <file>                              Print a file
+ *   head [--lines=N] <file>                 First N lines (default 10)
+ *   tail [--lines=N] [--follow|-f] <file>   Last N lines, optionally keep following
+ *   hexdump [--offset=N] [--length=N] <file>
+ *   rm <file>
+ *   cp <source> <destination>
+ *   df                                      Filesystem usage (LittleFS overload)
+ * 
+ * `tail` seeks back from the end of the file instead of reading it all;
+ * `tail --follow` runs as a CLI job and stops with Ctrl-C.
+ * 
+ * Usage:
+ *   LittleFS.begin(true);
+ *   CLIFileCommands::registerFileCommands(cli, LittleFS);
+ */
+
+namespace CLIFileCommands {
+    void registerFileCommands(GenericCLI& cli, fs::FS& filesystem);
+    
+#if defined(ESP32)
+    // Same set plus df, which needs the capacity LittleFS reports
+    void registerFileCommands(GenericCLI& cli, fs::LittleFSFS& filesystem);
+#endif
+}
+
+#endif // CLI_FILE_COMMANDS_H
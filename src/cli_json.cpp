@@ -0,0 +1,320 @@
+#include "cli_json.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool isLiteralChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '-' || c == '+' || c == '.';
+}
+
+CLIJsonParser::CLIJsonParser(ValueHandler valueHandler) : handler(valueHandler) {
+    reset();
+}
+
+void CLIJsonParser::reset() {
+    state = State::VALUE;
+    stringIsKey = false;
+    depth = 0;
+    path[0] = '\0';
+    pathLength = 0;
+    value[0] = '\0';
+    valueLength = 0;
+    unicode = 0;
+    unicodeDigits = 0;
+    highSurrogate = 0;
+    offset = 0;
+    errorMessage = nullptr;
+}
+
+CLIJsonParser::Status CLIJsonParser::status() const {
+    if (state == State::DONE) return Status::DONE;
+    if (state == State::ERROR) return Status::ERROR;
+    return Status::MORE;
+}
+
+CLIJsonParser::Status CLIJsonParser::feed(char c) {
+    if (state != State::ERROR) {
+        offset++;
+        process(c);
+    }
+    return status();
+}
+
+CLIJsonParser::Status CLIJsonParser::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length && state != State::ERROR; i++) {
+        feed(data[i]);
+    }
+    return status();
+}
+
+// ========================================================================
+// HELPERS
+// ========================================================================
+
+bool CLIJsonParser::fail(const char* message) {
+    errorMessage = message;
+    state = State::ERROR;
+    return false;
+}
+
+bool CLIJsonParser::append(char c) {
+    if (valueLength >= MAX_VALUE) {
+        return fail("Value too long");
+    }
+    value[valueLength++] = c;
+    value[valueLength] = '\0';
+    return true;
+}
+
+bool CLIJsonParser::appendCodePoint(uint32_t code) {
+    // UTF-8 encoding of the \u escape
+    if (code < 0x80) {
+        return append((char)code);
+    }
+    if (code < 0x800) {
+        return append((char)(0xC0 | (code >> 6))) && append((char)(0x80 | (code & 0x3F)));
+    }
+    if (code < 0x10000) {
+        return append((char)(0xE0 | (code >> 12))) && append((char)(0x80 | ((code >> 6) & 0x3F))) &&
+               append((char)(0x80 | (code & 0x3F)));
+    }
+    return append((char)(0xF0 | (code >> 18))) && append((char)(0x80 | ((code >> 12) & 0x3F))) &&
+           append((char)(0x80 | ((code >> 6) & 0x3F))) && append((char)(0x80 | (code & 0x3F)));
+}
+
+bool CLIJsonParser::push(bool array) {
+    if (depth >= MAX_DEPTH) {
+        return fail("Nesting too deep");
+    }
+    stack[depth].array = array;
+    stack[depth].index = 0;
+    stack[depth].pathLength = pathLength;
+    depth++;
+    return true;
+}
+
+bool CLIJsonParser::pop(char closer) {
+    if (depth == 0 || stack[depth - 1].array != (closer == ']')) {
+        return fail("Mismatched bracket");
+    }
+    depth--;
+    pathLength = stack[depth].pathLength;
+    path[pathLength] = '\0';
+    endValue();
+    return true;
+}
+
+void CLIJsonParser::endValue() {
+    state = (depth > 0) ? State::COMMA_OR_END : State::DONE;
+}
+
+bool CLIJsonParser::setMemberPath() {
+    // Parent path + "." + key, the key being in the value buffer
+    uint8_t base = stack[depth - 1].pathLength;
+    size_t needed = base + (base > 0 ? 1 : 0) + valueLength;
+    if (needed > MAX_PATH) {
+        return fail("Path too long");
+    }
+    pathLength = base;
+    if (base > 0) {
+        path[pathLength++] = '.';
+    }
+    memcpy(path + pathLength, value, valueLength);
+    pathLength += valueLength;
+    path[pathLength] = '\0';
+    return true;
+}
+
+bool CLIJsonParser::setIndexPath() {
+    uint8_t base = stack[depth - 1].pathLength;
+    char index[8];
+    int length = snprintf(index, sizeof(index), "[%u]", (unsigned)stack[depth - 1].index);
+    if (base + length > (int)MAX_PATH) {
+        return fail("Path too long");
+    }
+    memcpy(path + base, index, length + 1);
+    pathLength = base + length;
+    return true;
+}
+
+void CLIJsonParser::emit(CLIJsonType type) {
+    if (handler) {
+        handler(path, type, value);
+    }
+}
+
+bool CLIJsonParser::finishLiteral() {
+    if (strcmp(value, "true") == 0 || strcmp(value, "false") == 0) {
+        emit(CLIJsonType::BOOL);
+    } else if (strcmp(value, "null") == 0) {
+        emit(CLIJsonType::NUL);
+    } else {
+        // JSON numbers: optional minus, digits, fraction, exponent (no hex, no leading +)
+        char* end = nullptr;
+        bool digitStart = value[0] == '-' ? (value[1] >= '0' && value[1] <= '9') : (value[0] >= '0' && value[0] <= '9');
+        strtod(value, &end);
+        if (!digitStart || *end != '\0' || strpbrk(value, "xXnN") != nullptr) {
+            return fail("Invalid literal");
+        }
+        emit(CLIJsonType::NUMBER);
+    }
+    endValue();
+    return true;
+}
+
+// ========================================================================
+// STATE MACHINE
+// ========================================================================
+
+bool CLIJsonParser::process(char c) {
+    switch (state) {
+        case State::ARRAY_FIRST:
+            if (isSpace(c)) return true;
+            if (c == ']') return pop(c);
+            // The character starts the first element
+            state = State::VALUE;
+            return process(c);
+            
+        case State::VALUE:
+            if (isSpace(c)) return true;
+            valueLength = 0;
+            value[0] = '\0';
+            if (c == '{') {
+                if (!push(false)) return false;
+                state = State::KEY_OR_END;
+            } else if (c == '[') {
+                if (!push(true) || !setIndexPath()) return false;
+                state = State::ARRAY_FIRST;
+            } else if (c == '"') {
+                stringIsKey = false;
+                state = State::STRING;
+            } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                state = State::LITERAL;
+                return append(c);
+            } else {
+                return fail("Expected a value");
+            }
+            return true;
+            
+        case State::KEY_OR_END:
+            if (isSpace(c)) return true;
+            if (c == '}') return pop(c);
+            state = State::KEY;
+            return process(c);
+            
+        case State::KEY:
+            if (isSpace(c)) return true;
+            if (c != '"') return fail("Expected a key");
+            valueLength = 0;
+            value[0] = '\0';
+            stringIsKey = true;
+            state = State::STRING;
+            return true;
+            
+        case State::COLON:
+            if (isSpace(c)) return true;
+            if (c != ':') return fail("Expected ':'");
+            state = State::VALUE;
+            return true;
+            
+        case State::COMMA_OR_END:
+            if (isSpace(c)) return true;
+            if (c == '}' || c == ']') return pop(c);
+            if (c != ',') return fail("Expected ',' or end of container");
+            if (stack[depth - 1].array) {
+                stack[depth - 1].index++;
+                state = State::VALUE;
+                return setIndexPath();
+            }
+            state = State::KEY;
+            return true;
+            
+        case State::STRING:
+            if (c == '"') {
+                if (highSurrogate) {
+                    return fail("Unpaired surrogate");
+                }
+                if (stringIsKey) {
+                    state = State::COLON;
+                    return setMemberPath();
+                }
+                emit(CLIJsonType::STRING);
+                endValue();
+                return true;
+            }
+            if (c == '\\') {
+                state = State::ESCAPE;
+                return true;
+            }
+            if ((uint8_t)c < 0x20) {
+                return fail("Control character in string");
+            }
+            return append(c);
+            
+        case State::ESCAPE: {
+            state = State::STRING;
+            const char* from = "\"\\/bfnrt";
+            const char* to = "\"\\/\b\f\n\r\t";
+            const char* match = strchr(from, c);
+            if (c == 'u') {
+                unicode = 0;
+                unicodeDigits = 0;
+                state = State::UNICODE;
+                return true;
+            }
+            if (c == '\0' || match == nullptr) {
+                return fail("Invalid escape");
+            }
+            return append(to[match - from]);
+        }
+            
+        case State::UNICODE: {
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else return fail("Invalid \\u escape");
+            
+            unicode = (unicode << 4) | digit;
+            if (++unicodeDigits < 4) {
+                return true;
+            }
+            state = State::STRING;
+            
+            if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+                if (highSurrogate) return fail("Unpaired surrogate");
+                highSurrogate = unicode;
+                return true;
+            }
+            if (unicode >= 0xDC00 && unicode <= 0xDFFF) {
+                if (!highSurrogate) return fail("Unpaired surrogate");
+                uint32_t code = 0x10000 + (((uint32_t)highSurrogate - 0xD800) << 10) + (unicode - 0xDC00);
+                highSurrogate = 0;
+                return appendCodePoint(code);
+            }
+            if (highSurrogate) return fail("Unpaired surrogate");
+            return appendCodePoint(unicode);
+        }
+            
+        case State::LITERAL:
+            if (isLiteralChar(c)) {
+                return append(c);
+            }
+            // The delimiter also belongs to the enclosing container
+            return finishLiteral() && process(c);
+            
+        case State::DONE:
+            if (isSpace(c)) return true;
+            return fail("Data after end of document");
+            
+        case State::ERROR:
+            return false;
+    }
+    return false;
+}
@@ -0,0 +1,97 @@
+#ifndef CLI_JSON_H
+#define CLI_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+/**
+ * Streaming JSON Parser
+ * 
+ * SAX-style parser fed one character at a time, for documents that arrive
+ * over the CLI stream and may be larger than the RAM available for them.
+ * No document tree is built: every scalar is reported with its path as
+ * soon as it is complete, and memory use is fixed by the limits below
+ * whatever the size of the input.
+ * 
+ * Paths join object keys with '.' and array indices with [n]:
+ * 
+ *   {"wifi": {"ssid": "home"}, "pins": [4, 5]}
+ *     -> wifi.ssid = "home", pins[0] = 4, pins[1] = 5
+ * 
+ * Like cli_codec, this file has no Arduino dependency.
+ */
+
+enum class CLIJsonType : uint8_t {
+    STRING,
+    NUMBER,
+    BOOL,
+    NUL
+};
+
+class CLIJsonParser {
+public:
+    static const size_t MAX_DEPTH = 8;
+    static const size_t MAX_PATH = 63;
+    static const size_t MAX_VALUE = 127;
+    
+    enum class Status : uint8_t {
+        MORE,       // Document not complete yet
+        DONE,       // Top-level value complete
+        ERROR
+    };
+    
+    // value is the decoded string, or the literal text of numbers, true/false and null
+    using ValueHandler = std::function<void(const char* path, CLIJsonType type, const char* value)>;
+    
+    explicit CLIJsonParser(ValueHandler handler);
+    
+    Status feed(char c);
+    Status feed(const char* data, size_t length);
+    void reset();
+    
+    Status status() const;
+    const char* error() const { return errorMessage; }
+    size_t position() const { return offset; }     // Characters consumed
+    
+private:
+    enum class State : uint8_t {
+        VALUE, ARRAY_FIRST, KEY_OR_END, KEY, COLON, COMMA_OR_END,
+        STRING, ESCAPE, UNICODE, LITERAL, DONE, ERROR
+    };
+    
+    struct Level {
+        bool array;
+        uint16_t index;
+        uint8_t pathLength;     // Length of the container's own path
+    };
+    
+    bool process(char c);
+    bool fail(const char* message);
+    bool append(char c);
+    bool appendCodePoint(uint32_t code);
+    bool push(bool array);
+    bool pop(char closer);
+    void endValue();
+    bool finishLiteral();
+    bool setMemberPath();
+    bool setIndexPath();
+    void emit(CLIJsonType type);
+    
+    ValueHandler handler;
+    State state;
+    bool stringIsKey;
+    Level stack[MAX_DEPTH];
+    uint8_t depth;
+    char path[MAX_PATH + 1];
+    uint8_t pathLength;
+    char value[MAX_VALUE + 1];
+    uint16_t valueLength;
+    uint16_t unicode;
+    uint8_t unicodeDigits;
+    uint16_t highSurrogate;
+    size_t offset;
+    const char* errorMessage;
+};
+
+#endif // CLI_JSON_H
@@ -0,0 +1,350 @@
+#include "cli_memory_commands.h"
+#include "cli_codec.h"
+#include <errno.h>
+
+#if defined(ESP32)
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <spi_flash_mmap.h>
+#else
+#include <esp_spi_flash.h>
+#endif
+#endif
+
+namespace CLIMemoryCommands {
+    
+    // ========================================================================
+    // MEMORY MAP
+    // ========================================================================
+    
+    // Internal memory of the target, from the technical reference manuals
+    static const Region defaultRegions[] = {
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        { "DROM",     0x3C000000, 0x3E000000, READ | MAPPED },
+        { "DRAM",     0x3FC88000, 0x3FD00000, READ | WRITE },
+        { "ROM",      0x40000000, 0x40060000, READ | WORD_ONLY },
+        { "IRAM",     0x40370000, 0x403E0000, READ | WRITE | WORD_ONLY },
+        { "RTC SLOW", 0x50000000, 0x50002000, READ | WRITE },
+        { "RTC FAST", 0x600FE000, 0x60100000, READ | WRITE },
+#elif defined(CONFIG_IDF_TARGET_ESP32C3)
+        { "DROM",     0x3C000000, 0x3C800000, READ | MAPPED },
+        { "DRAM",     0x3FC80000, 0x3FCE0000, READ | WRITE },
+        { "ROM",      0x40000000, 0x40060000, READ | WORD_ONLY },
+        { "IRAM",     0x4037C000, 0x403E0000, READ | WRITE | WORD_ONLY },
+        { "RTC FAST", 0x50000000, 0x50002000, READ | WRITE },
+#elif defined(ESP32)
+        { "DROM",     0x3F400000, 0x3F800000, READ | MAPPED },
+        { "RTC FAST", 0x3FF80000, 0x3FF82000, READ | WRITE },
+        { "DRAM",     0x3FFAE000, 0x40000000, READ | WRITE },
+        { "ROM",      0x40000000, 0x40070000, READ | WORD_ONLY },
+        { "IRAM",     0x40070000, 0x400C0000, READ | WRITE | WORD_ONLY },
+        { "RTC SLOW", 0x50000000, 0x50002000, READ | WRITE },
+#endif
+        { nullptr, 0, 0, 0 }
+    };
+    
+    static std::vector<Region>& regions() {
+        static std::vector<Region> table;
+        static bool initialized = false;
+        if (!initialized) {
+            initialized = true;
+            for (const Region* r = defaultRegions; r->name != nullptr; r++) {
+                table.push_back(*r);
+            }
+#if defined(ESP32) && !defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(CONFIG_IDF_TARGET_ESP32C3)
+            // External RAM is mapped behind the data bus when present; the
+            // window is 4 MB, larger chips are reached through himem only
+            size_t psram = std::min<size_t>(ESP.getPsramSize(), 0x400000);
+            if (psram > 0) {
+                table.push_back({ "PSRAM", 0x3F800000, 0x3F800000 + psram, READ | WRITE });
+            }
+#endif
+        }
+        return table;
+    }
+    
+    void addRegion(const char* name, uintptr_t start, size_t size, uint8_t flags) {
+        regions().push_back({ name, start, start + size, flags });
+    }
+    
+    const Region* findRegion(uintptr_t address, size_t length) {
+        for (const Region& region : regions()) {
+            if (address >= region.start && address < region.end && 
+                length <= region.end - address) {
+                return &region;
+            }
+        }
+        return nullptr;
+    }
+    
+    // Flash windows are only partly backed by cache MMU pages; reading an
+    // unmapped page raises a cache error instead of returning data
+    static bool mapped(uintptr_t address, size_t length) {
+#if defined(ESP32)
+        uintptr_t page = address & ~(uintptr_t)(SPI_FLASH_MMU_PAGE_SIZE - 1);
+        for (; page < address + length; page += SPI_FLASH_MMU_PAGE_SIZE) {
+            if (spi_flash_cache2phys((const void*)page) == SPI_FLASH_CACHE2PHYS_FAIL) {
+                return false;
+            }
+        }
+#endif
+        return true;
+    }
+    
+    // ========================================================================
+    // ACCESS
+    // ========================================================================
+    
+    // Word-wise copy: byte loads fault on the instruction bus regions
+    static void readMemory(uintptr_t address, uint8_t* out, size_t length) {
+        uintptr_t word = address & ~(uintptr_t)3;
+        size_t skip = address - word;
+        while (length > 0) {
+            uint32_t value = *reinterpret_cast<volatile const uint32_t*>(word);
+            for (size_t i = skip; i < 4 && length > 0; i++, length--) {
+                *out++ = (uint8_t)(value >> (i * 8));
+            }
+            skip = 0;
+            word += 4;
+        }
+    }
+    
+    static uint32_t readValue(uintptr_t address, uint8_t width) {
+        uint8_t bytes[4] = { 0, 0, 0, 0 };
+        readMemory(address, bytes, width);
+        return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    }
+    
+    static void writeValue(uintptr_t address, uint32_t value, uint8_t width, bool wordOnly) {
+        if (width == 4) {
+            *reinterpret_cast<volatile uint32_t*>(address) = value;
+        } else if (wordOnly) {
+            // Read-modify-write of the containing word
+            uintptr_t word = address & ~(uintptr_t)3;
+            unsigned shift = (address - word) * 8;
+            uint32_t mask = ((width == 1) ? 0xFFu : 0xFFFFu) << shift;
+            volatile uint32_t* target = reinterpret_cast<volatile uint32_t*>(word);
+            *target = (*target & ~mask) | ((value << shift) & mask);
+        } else if (width == 2) {
+            *reinterpret_cast<volatile uint16_t*>(address) = (uint16_t)value;
+        } else {
+            *reinterpret_cast<volatile uint8_t*>(address) = (uint8_t)value;
+        }
+    }
+    
+    // ========================================================================
+    // ARGUMENT HELPERS
+    // ========================================================================
+    
+    static bool parseNumber(const String& text, uintptr_t& value) {
+        // strtoull accepts a sign and wraps it; addresses above the pointer
+        // width must not be truncated into a valid one
+        if (text.isEmpty() || text[0] == '-' || text[0] == '+') {
+            return false;
+        }
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long parsed = strtoull(text.c_str(), &end, 0);   // 0x.. hex, otherwise decimal
+        if (end == nullptr || *end != '\0' || errno == ERANGE || parsed > UINTPTR_MAX) {
+            return false;
+        }
+        value = (uintptr_t)parsed;
+        return true;
+    }
+    
+    static bool parseWidth(GenericCLI& cli, const CLIArgs& args, uint8_t& width) {
+        long value = args.getFlag("width", "4").toInt();
+        if (value != 1 && value != 2 && value != 4) {
+            cli.printError("Width must be 1, 2 or 4");
+            return false;
+        }
+        width = (uint8_t)value;
+        return true;
+    }
+    
+    static const Region* checkRange(GenericCLI& cli, uintptr_t address, size_t length, uint8_t access) {
+        const Region* region = findRegion(address, length);
+        if (region == nullptr) {
+            char text[64];
+            snprintf(text, sizeof(text), "0x%08lX..0x%08lX is outside known memory",
+                     (unsigned long)address, (unsigned long)(address + length - 1));
+            cli.printError(String(text) + " (see 'regions')");
+            return nullptr;
+        }
+        if ((region->flags & access) != access) {
+            cli.printError(String(region->name) + " is read-only");
+            return nullptr;
+        }
+        if ((region->flags & MAPPED) && !mapped(address, length)) {
+            cli.printError("Part of the range is not mapped in " + String(region->name));
+            return nullptr;
+        }
+        return region;
+    }
+    
+    // ========================================================================
+    // COMMAND HANDLERS
+    // ========================================================================
+    
+    static void handleRegions(GenericCLI& cli, const CLIArgs& args) {
+        Stream& io = cli.getStream();
+        if (regions().empty()) {
+            cli.printInfo("No memory regions known on this target - use addRegion()");
+            return;
+        }
+        for (const Region& region : regions()) {
+            io.printf("%-10s 0x%08lX-0x%08lX %7lu KB  %s%s\r\n", region.name,
+                      (unsigned long)region.start, (unsigned long)(region.end - 1),
+                      (unsigned long)((region.end - region.start) / 1024),
+                      (region.flags & WRITE) ? "rw" : "ro",
+                      (region.flags & WORD_ONLY) ? ", 32-bit bus" :
+                      (region.flags & MAPPED) ? ", mapped pages only" : "");
+        }
+    }
+    
+    static void handlePeek(GenericCLI& cli, const CLIArgs& args) {
+        uintptr_t address;
+        uintptr_t length;
+        uint8_t width;
+        if (!parseNumber(args.getPositional(0), address) || !parseWidth(cli, args, width)) {
+            cli.printError("Usage: peek <addr> [length] [--width=1|2|4]");
+            return;
+        }
+        if (!parseNumber(args.getPositional(1, String(width)), length) || length == 0 || length > 256) {
+            cli.printError("Length must be between 1 and 256 bytes");
+            return;
+        }
+        if (address % width != 0) {
+            cli.printError("Address must be aligned to the access width");
+            return;
+        }
+        length = (length + width - 1) / width * width;
+        if (!checkRange(cli, address, length, READ)) {
+            return;
+        }
+        
+        // One line per 8 values: "3FFB0000: 12345678 9ABCDEF0 ..."
+        Stream& io = cli.getStream();
+        const size_t perLine = 8;
+        char line[8 + 2 + perLine * 9 + 3];
+        for (uintptr_t offset = 0; offset < length; offset += perLine * width) {
+            char* out = CLIHex::formatWord(line, (uint32_t)(address + offset));
+            *out++ = ':';
+            for (size_t i = 0; i < perLine && offset + i * width < length; i++) {
+                uint32_t value = readValue(address + offset + i * width, width);
+                *out++ = ' ';
+                if (width == 4) {
+                    out = CLIHex::formatWord(out, value);
+                } else {
+                    if (width == 2) out = CLIHex::formatByte(out, value >> 8);
+                    out = CLIHex::formatByte(out, value & 0xFF);
+                }
+            }
+            *out++ = '\r';
+            *out++ = '\n';
+            io.write((const uint8_t*)line, out - line);
+        }
+    }
+    
+    static void handlePoke(GenericCLI& cli, const CLIArgs& args) {
+        uintptr_t address;
+        uintptr_t value;
+        uint8_t width;
+        if (!parseNumber(args.getPositional(0), address) || !parseNumber(args.getPositional(1), value) ||
+            !parseWidth(cli, args, width)) {
+            cli.printError("Usage: poke <addr> <value> [--width=1|2|4]");
+            return;
+        }
+        if (address % width != 0) {
+            cli.printError("Address must be aligned to the access width");
+            return;
+        }
+        if (width < 4 && value >> (width * 8) != 0) {
+            cli.printError("Value does not fit in " + String(width) + " byte(s)");
+            return;
+        }
+        const Region* region = checkRange(cli, address, width, WRITE);
+        if (region == nullptr) {
+            return;
+        }
+        
+        uint32_t before = readValue(address, width);
+        writeValue(address, (uint32_t)value, width, region->flags & WORD_ONLY);
+        uint32_t after = readValue(address, width);
+        
+        // width is 1, 2 or 4; the bound lets the compiler see the text fits
+        int digits = std::min(width * 2, 8);
+        char text[64];
+        snprintf(text, sizeof(text), "0x%08lX: 0x%0*lX -> 0x%0*lX", (unsigned long)address,
+                 digits, (unsigned long)before, digits, (unsigned long)after);
+        if (after == (uint32_t)value) {
+            cli.printSuccess(text);
+        } else {
+            cli.printWarning(String(text) + " (read back differs)");
+        }
+    }
+    
+    // dump writes up to DUMP_INLINE_BYTES at once and longer ranges in
+    // DUMP_BLOCK_BYTES steps from a job
+    static const uintptr_t DUMP_INLINE_BYTES = 1024;
+    static const uintptr_t DUMP_BLOCK_BYTES = 256;
+    
+    // Rows from offset up to end; returns where it stopped
+    static uintptr_t dumpRows(Stream& io, uintptr_t address, uintptr_t offset, uintptr_t end) {
+        uint8_t row[CLIHex::ROW_BYTES];
+        char line[CLIHex::ROW_LINE_SIZE];
+        for (; offset < end; offset += CLIHex::ROW_BYTES) {
+            size_t count = std::min<size_t>(CLIHex::ROW_BYTES, end - offset);
+            readMemory(address + offset, row, count);
+            size_t n = CLIHex::formatRow(line, (uint32_t)(address + offset), row, count);
+            io.write((const uint8_t*)line, n);
+        }
+        return offset;
+    }
+    
+    static void handleDump(GenericCLI& cli, const CLIArgs& args) {
+        uintptr_t address;
+        uintptr_t length;
+        if (!parseNumber(args.getPositional(0), address)) {
+            cli.printError("Usage: dump <addr> [length]");
+            return;
+        }
+        if (!parseNumber(args.getPositional(1, "256"), length) || length == 0) {
+            cli.printError("Invalid length");
+            return;
+        }
+        if (!checkRange(cli, address, length, READ)) {
+            return;
+        }
+        
+        if (length <= DUMP_INLINE_BYTES) {
+            dumpRows(cli.getStream(), address, 0, length);
+            return;
+        }
+        
+        // Longer dumps continue as a job, a block per update(), so Ctrl-C
+        // stops them and the CLI is not blocked for the whole range
+        uintptr_t offset = 0;
+        cli.startJob([&cli, address, length, offset]() mutable {
+            uintptr_t end = offset + std::min(DUMP_BLOCK_BYTES, length - offset);
+            offset = dumpRows(cli.getStream(), address, offset, end);
+            return offset < length;
+        });
+    }
+    
+    // ========================================================================
+    // REGISTRATION
+    // ========================================================================
+    
+    void registerMemoryCommands(GenericCLI& cli) {
+        cli.registerCommand("regions", "List inspectable memory regions", "regions",
+            [&cli](const CLIArgs& args) { handleRegions(cli, args); }, "Debug");
+        cli.registerCommand("peek", "Read memory", "peek <addr> [length] [--width=1|2|4]",
+            [&cli](const CLIArgs& args) { handlePeek(cli, args); }, "Debug");
+        cli.registerCommand("poke", "Write memory", "poke <addr> <value> [--width=1|2|4]",
+            [&cli](const CLIArgs& args) { handlePoke(cli, args); }, "Debug",
+            CLIRoles::ADMIN | CLIRoles::FACTORY);
+        cli.registerCommand("dump", "Hex dump of memory", "dump <addr> [length]",
+            [&cli](const CLIArgs& args) { handleDump(cli, args); }, "Debug");
+    }
+}
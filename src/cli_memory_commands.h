@@ -0,0 +1,58 @@
+#ifndef CLI_MEMORY_COMMANDS_H
+#define CLI_MEMORY_COMMANDS_H
+
+#include "generic_cli.h"
+
+/**
+ * Memory Inspection Commands
+ * 
+ * Field debugging helpers that read and write raw memory:
+ * 
+ *   regions                                   List the accessible regions
+ *   peek <addr> [length] [--width=1|2|4]      Print values (default one word)
+ *   poke <addr> <value> [--width=1|2|4]       Write a value and read it back
+ *   dump <addr> [length]                      Hex + ASCII dump (default 256 bytes)
+ * 
+ * Every access is checked against a table of known memory regions, so a
+ * typo cannot fault the CPU. The table starts with the internal RAM, ROM
+ * and flash-mapped areas of the target chip; in the flash window only the
+ * pages the cache MMU maps can be read. Peripheral registers are not
+ * included because reading some of them has side effects - add the ones
+ * you need with addRegion(). Memory is always read in aligned 32-bit words,
+ * which also works for regions that fault on byte access (IRAM).
+ * 
+ * Dumps of more than 1 KB are written a block per update(), so they do
+ * not hold up the CLI and Ctrl-C stops them.
+ * 
+ * poke is restricted to the ADMIN and FACTORY roles.
+ * 
+ * Usage:
+ *   CLIMemoryCommands::registerMemoryCommands(cli);
+ *   CLIMemoryCommands::addRegion("GPIO", 0x3FF44000, 0x1000);
+ */
+
+namespace CLIMemoryCommands {
+    
+    // Region flags
+    const uint8_t READ = 0x01;
+    const uint8_t WRITE = 0x02;
+    const uint8_t WORD_ONLY = 0x04;     // Bus only supports 32-bit accesses
+    const uint8_t MAPPED = 0x08;        // Flash cache window, checked page by page
+    
+    struct Region {
+        const char* name;
+        uintptr_t start;
+        uintptr_t end;                  // Exclusive
+        uint8_t flags;
+    };
+    
+    void registerMemoryCommands(GenericCLI& cli);
+    
+    // Make another address range accessible (peripherals, a buffer under test)
+    void addRegion(const char* name, uintptr_t start, size_t size, uint8_t flags = READ | WRITE);
+    
+    // Region containing [address, address + length), nullptr if none does
+    const Region* findRegion(uintptr_t address, size_t length);
+}
+
+#endif // CLI_MEMORY_COMMANDS_H
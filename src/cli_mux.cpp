@@ -0,0 +1,205 @@
+#include "cli_mux.h"
+
+// ========================================================================
+// BYTE QUEUE
+// ========================================================================
+
+CLIByteQueue::CLIByteQueue(size_t size) :
+    data(new uint8_t[size]),
+    capacity(size),
+    head(0),
+    count(0) {}
+
+CLIByteQueue::~CLIByteQueue() {
+    delete[] data;
+}
+
+bool CLIByteQueue::push(uint8_t value) {
+    if (count == capacity) {
+        return false;
+    }
+    data[(head + count) % capacity] = value;
+    count++;
+    return true;
+}
+
+size_t CLIByteQueue::push(const uint8_t* values, size_t length) {
+    size_t accepted = 0;
+    while (accepted < length && count < capacity) {
+        // Copy the contiguous run up to the end of the storage
+        size_t tail = (head + count) % capacity;
+        size_t run = std::min(length - accepted, std::min(space(), capacity - tail));
+        memcpy(data + tail, values + accepted, run);
+        count += run;
+        accepted += run;
+    }
+    return accepted;
+}
+
+int CLIByteQueue::pop() {
+    if (count == 0) {
+        return -1;
+    }
+    uint8_t value = data[head];
+    head = (head + 1) % capacity;
+    count--;
+    return value;
+}
+
+size_t CLIByteQueue::pop(uint8_t* out, size_t maxLength) {
+    size_t taken = 0;
+    while (taken < maxLength && count > 0) {
+        size_t run = std::min(maxLength - taken, std::min(count, capacity - head));
+        memcpy(out + taken, data + head, run);
+        head = (head + run) % capacity;
+        count -= run;
+        taken += run;
+    }
+    return taken;
+}
+
+int CLIByteQueue::peek() const {
+    return (count == 0) ? -1 : data[head];
+}
+
+// ========================================================================
+// CHANNEL
+// ========================================================================
+
+CLIMuxChannel::CLIMuxChannel(CLIMux& owner, uint8_t id, size_t rxSize, size_t txSize) :
+    mux(owner),
+    channelId(id),
+    rx(rxSize),
+    tx(txSize),
+    dropped(0) {}
+
+int CLIMuxChannel::available() {
+    return rx.size();
+}
+
+int CLIMuxChannel::read() {
+    return rx.pop();
+}
+
+int CLIMuxChannel::peek() {
+    return rx.peek();
+}
+
+size_t CLIMuxChannel::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t CLIMuxChannel::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        written += tx.push(buffer + written, size - written);
+        if (written < size) {
+            // Queue full: block on the link like Serial does, but take a
+            // round-robin turn so the other channels keep their share
+            mux.sendRound();
+        }
+    }
+    return written;
+}
+
+int CLIMuxChannel::availableForWrite() {
+    return tx.space();
+}
+
+void CLIMuxChannel::flush() {
+    while (tx.size() > 0) {
+        mux.sendRound();
+    }
+}
+
+// ========================================================================
+// MULTIPLEXER
+// ========================================================================
+
+CLIMux::CLIMux(Stream& stream, size_t payloadSize) :
+    link(stream),
+    maxPayload(std::min(std::max<size_t>(payloadSize, 1), CLIFrame::MAX_PAYLOAD)),
+    nextChannel(0) {}
+
+CLIMux::~CLIMux() {
+    for (auto* channel : channels) {
+        delete channel;
+    }
+}
+
+CLIMuxChannel* CLIMux::addChannel(uint8_t id, size_t rxSize, size_t txSize) {
+    if (getChannel(id) != nullptr) {
+        return nullptr;
+    }
+    CLIMuxChannel* channel = new CLIMuxChannel(*this, id, rxSize, txSize);
+    channels.push_back(channel);
+    return channel;
+}
+
+CLIMuxChannel* CLIMux::getChannel(uint8_t id) {
+    for (auto* channel : channels) {
+        if (channel->channelId == id) {
+            return channel;
+        }
+    }
+    return nullptr;
+}
+
+void CLIMux::update() {
+    receive();
+    while (sendRound()) {}
+}
+
+bool CLIMux::sendRound() {
+    // Round-robin: one frame per channel per turn, starting after the
+    // channel that started the previous turn
+    bool pending = false;
+    for (size_t i = 0; i < channels.size(); i++) {
+        CLIMuxChannel& channel = *channels[(nextChannel + i) % channels.size()];
+        if (channel.tx.size() > 0) {
+            sendFrame(channel);
+            pending |= channel.tx.size() > 0;
+        }
+    }
+    if (!channels.empty()) {
+        nextChannel = (nextChannel + 1) % channels.size();
+    }
+    return pending;
+}
+
+void CLIMux::receive() {
+    while (link.available()) {
+        if (!decoder.feed(link.read())) {
+            continue;
+        }
+        
+        stats.framesReceived++;
+        CLIMuxChannel* channel = getChannel(decoder.channel());
+        if (channel == nullptr) {
+            stats.unknownChannel++;
+            continue;
+        }
+        size_t accepted = channel->rx.push(decoder.payload(), decoder.length());
+        channel->dropped += decoder.length() - accepted;
+    }
+}
+
+void CLIMux::sendFrame(CLIMuxChannel& channel) {
+    uint8_t payload[CLIFrame::MAX_PAYLOAD];
+    uint8_t header[CLIFrame::HEADER_SIZE];
+    
+    size_t length = channel.tx.pop(payload, maxPayload);
+    uint16_t crc = CLIFrame::encode(header, channel.channelId, payload, length);
+    uint8_t trailer[CLIFrame::CRC_SIZE] = { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+    
+    link.write(header, sizeof(header));
+    link.write(payload, length);
+    link.write(trailer, sizeof(trailer));
+    stats.framesSent++;
+}
+
+CLIMuxStats CLIMux::getStats() const {
+    CLIMuxStats result = stats;
+    result.crcErrors = decoder.crcErrors();
+    return result;
+}
@@ -0,0 +1,123 @@
+#ifndef CLI_MUX_H
+#define CLI_MUX_H
+
+#include <Arduino.h>
+#include <vector>
+#include "cli_codec.h"
+
+/**
+ * Virtual Channel Multiplexer
+ * 
+ * Carries several independent byte streams over one physical link using
+ * the CRC-protected frames from cli_codec.h. Every channel is a Stream, so
+ * a GenericCLI session, a machine protocol and a binary log can share one
+ * UART without interleaving raw bytes.
+ * 
+ * Usage:
+ *   CLIMux mux(Serial);
+ *   CLIConfig config;
+ *   config.stream = mux.addChannel(0);
+ *   GenericCLI cli(config);
+ *   CLIMuxChannel* log = mux.addChannel(2);
+ * 
+ *   void loop() {
+ *       mux.update();
+ *       cli.update();
+ *   }
+ * 
+ * Output is buffered per channel and sent round-robin, one frame per
+ * channel per turn, so a busy channel cannot starve the others. A write
+ * to a full channel blocks, sending whole turns until it fits.
+ * The host side is tools/cli_mux_demux.cpp.
+ */
+
+// Fixed-capacity byte FIFO
+class CLIByteQueue {
+public:
+    explicit CLIByteQueue(size_t capacity);
+    ~CLIByteQueue();
+    CLIByteQueue(const CLIByteQueue&) = delete;
+    CLIByteQueue& operator=(const CLIByteQueue&) = delete;
+    
+    bool push(uint8_t value);
+    size_t push(const uint8_t* values, size_t length);
+    int pop();
+    size_t pop(uint8_t* out, size_t maxLength);
+    int peek() const;
+    
+    size_t size() const { return count; }
+    size_t space() const { return capacity - count; }
+    
+private:
+    uint8_t* data;
+    size_t capacity;
+    size_t head;
+    size_t count;
+};
+
+class CLIMux;
+
+class CLIMuxChannel : public Stream {
+public:
+    // Stream interface
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int availableForWrite() override;
+    void flush() override;
+    using Print::write;
+    
+    uint8_t id() const { return channelId; }
+    uint32_t droppedBytes() const { return dropped; }   // Received while the RX queue was full
+    
+private:
+    friend class CLIMux;
+    CLIMuxChannel(CLIMux& owner, uint8_t id, size_t rxSize, size_t txSize);
+    
+    CLIMux& mux;
+    uint8_t channelId;
+    CLIByteQueue rx;
+    CLIByteQueue tx;
+    uint32_t dropped;
+};
+
+struct CLIMuxStats {
+    uint32_t framesSent;
+    uint32_t framesReceived;
+    uint32_t crcErrors;
+    uint32_t unknownChannel;    // Valid frames for channels that were never added
+    
+    CLIMuxStats() : framesSent(0), framesReceived(0), crcErrors(0), unknownChannel(0) {}
+};
+
+class CLIMux {
+public:
+    explicit CLIMux(Stream& link, size_t maxPayload = 64);
+    ~CLIMux();
+    
+    CLIMuxChannel* addChannel(uint8_t id, size_t rxSize = 128, size_t txSize = 256);
+    CLIMuxChannel* getChannel(uint8_t id);
+    
+    // Receive pending frames and send buffered output; call from loop()
+    void update();
+    
+    CLIMuxStats getStats() const;
+    
+private:
+    friend class CLIMuxChannel;
+    
+    void receive();
+    bool sendRound();       // True while output remains queued
+    void sendFrame(CLIMuxChannel& channel);
+    
+    Stream& link;
+    size_t maxPayload;
+    std::vector<CLIMuxChannel*> channels;
+    size_t nextChannel;
+    CLIFrameDecoder decoder;
+    CLIMuxStats stats;
+};
+
+#endif // CLI_MUX_H
@@ -0,0 +1,162 @@
+#include "cli_ota.h"
+
+static const uint32_t START_TIMEOUT_MS = 60000;
+static const uint32_t IDLE_TIMEOUT_MS = 10000;
+
+CLIOtaReceiver::CLIOtaReceiver(Stream& stream, uint8_t frames) :
+    link(stream),
+    window(frames > 0 ? frames : 1),
+    imageSize(0),
+    received(0) {
+    memset(expectedDigest, 0, sizeof(expectedDigest));
+}
+
+const char* CLIOtaReceiver::resultText(Result result) {
+    switch (result) {
+        case Result::OK: return "Image verified and committed";
+        case Result::ABORTED: return "Aborted by host";
+        case Result::TIMEOUT: return "Timeout";
+        case Result::STORAGE_ERROR: return "Storage error";
+        case Result::VERIFY_ERROR: return "SHA-256 mismatch";
+    }
+    return "Unknown";
+}
+
+void CLIOtaReceiver::sendFrame(uint8_t type, const uint8_t* payload, uint8_t length) {
+    uint8_t header[CLIFrame::HEADER_SIZE];
+    uint16_t crc = CLIFrame::encode(header, type, payload, length);
+    uint8_t trailer[CLIFrame::CRC_SIZE] = { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+    link.write(header, sizeof(header));
+    link.write(payload, length);
+    link.write(trailer, sizeof(trailer));
+}
+
+void CLIOtaReceiver::sendOffset(uint8_t type) {
+    uint8_t payload[CLIOtaFrame::OFFSET_SIZE + 1];
+    CLIOtaFrame::putU32(payload, received);
+    payload[CLIOtaFrame::OFFSET_SIZE] = window;
+    sendFrame(type, payload, sizeof(payload));
+}
+
+CLIOtaReceiver::Result CLIOtaReceiver::finish(CLITransferStorage& storage, Result result) {
+    String message = resultText(result);
+    if (result == Result::STORAGE_ERROR && storage.lastError().length() > 0) {
+        message += ": " + storage.lastError();
+    }
+    
+    uint8_t payload[CLIFrame::MAX_PAYLOAD];
+    size_t length = std::min<size_t>(message.length(), sizeof(payload) - 1);
+    payload[0] = (uint8_t)result;
+    memcpy(payload + 1, message.c_str(), length);
+    sendFrame(CLIOtaFrame::DONE, payload, length + 1);
+    link.flush();
+    return result;
+}
+
+CLIOtaReceiver::Result CLIOtaReceiver::receive(CLITransferStorage& storage, const String& name) {
+    bool started = false;
+    bool nakSent = false;
+    unsigned long lastFrame = millis();
+    
+    decoder.reset();
+    hash.reset();
+    imageSize = 0;
+    received = 0;
+    
+    while (true) {
+        if (!link.available()) {
+            uint32_t limit = started ? IDLE_TIMEOUT_MS : START_TIMEOUT_MS;
+            if (millis() - lastFrame > limit) {
+                if (started) storage.close(false);
+                return finish(storage, Result::TIMEOUT);
+            }
+            delay(1);
+            continue;
+        }
+        
+        if (!decoder.feed(link.read())) {
+            continue;
+        }
+        lastFrame = millis();
+        const uint8_t* payload = decoder.payload();
+        uint8_t length = decoder.length();
+        
+        switch (decoder.channel()) {
+            case CLIOtaFrame::BEGIN:
+                if (length != CLIOtaFrame::OFFSET_SIZE + CLISha256::DIGEST_SIZE) {
+                    break;
+                }
+                if (!started) {
+                    imageSize = CLIOtaFrame::getU32(payload);
+                    memcpy(expectedDigest, payload + CLIOtaFrame::OFFSET_SIZE, CLISha256::DIGEST_SIZE);
+                    if (!storage.openWrite(name, imageSize)) {
+                        return finish(storage, Result::STORAGE_ERROR);
+                    }
+                    started = true;
+                }
+                // A repeated BEGIN means our ACK was lost
+                sendOffset(CLIOtaFrame::ACK);
+                break;
+                
+            case CLIOtaFrame::DATA: {
+                if (!started || length <= CLIOtaFrame::OFFSET_SIZE) {
+                    break;
+                }
+                uint32_t offset = CLIOtaFrame::getU32(payload);
+                size_t chunk = length - CLIOtaFrame::OFFSET_SIZE;
+                
+                if (offset < received) {
+                    // Resent after a lost ACK; already written
+                    sendOffset(CLIOtaFrame::ACK);
+                } else if (offset > received) {
+                    // A frame went missing; one NAK per gap, the host rewinds
+                    if (!nakSent) {
+                        sendOffset(CLIOtaFrame::NAK);
+                        nakSent = true;
+                    }
+                } else if (received + chunk > imageSize) {
+                    storage.close(false);
+                    return finish(storage, Result::VERIFY_ERROR);
+                } else {
+                    const uint8_t* data = payload + CLIOtaFrame::OFFSET_SIZE;
+                    if (storage.write(data, chunk) != chunk) {
+                        storage.close(false);
+                        return finish(storage, Result::STORAGE_ERROR);
+                    }
+                    hash.update(data, chunk);
+                    received += chunk;
+                    nakSent = false;
+                    sendOffset(CLIOtaFrame::ACK);
+                }
+                break;
+            }
+                
+            case CLIOtaFrame::END: {
+                if (!started) {
+                    break;
+                }
+                if (received < imageSize) {
+                    sendOffset(CLIOtaFrame::NAK);
+                    break;
+                }
+                uint8_t digest[CLISha256::DIGEST_SIZE];
+                hash.finish(digest);
+                if (memcmp(digest, expectedDigest, sizeof(digest)) != 0) {
+                    storage.close(false);
+                    return finish(storage, Result::VERIFY_ERROR);
+                }
+                if (!storage.close(true)) {
+                    return finish(storage, Result::STORAGE_ERROR);
+                }
+                return finish(storage, Result::OK);
+            }
+                
+            case CLIOtaFrame::ABORT:
+                if (started) storage.close(false);
+                return finish(storage, Result::ABORTED);
+                
+            default:
+                break;
+        }
+    }
+}
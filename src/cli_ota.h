@@ -0,0 +1,57 @@
+#ifndef CLI_OTA_H
+#define CLI_OTA_H
+
+#include <Arduino.h>
+#include "cli_codec.h"
+#include "cli_storage.h"
+
+/**
+ * Serial Firmware Update
+ * 
+ * Receives a firmware image as OTA frames (see CLIOtaFrame in cli_codec.h)
+ * and streams it into a CLITransferStorage - on ESP32 the inactive app
+ * partition, anywhere else a file standing in for it. The image is hashed
+ * as it arrives and only committed if its SHA-256 matches the one the host
+ * announced, so no image-sized buffer is ever needed.
+ * 
+ * The host (tools/cli_ota_send) keeps up to `window` frames in flight;
+ * the device's receive buffer must be able to hold that many frames
+ * (about 260 bytes each) while a flash sector is being erased.
+ */
+
+class CLIOtaReceiver {
+public:
+    enum class Result {
+        OK,
+        ABORTED,
+        TIMEOUT,
+        STORAGE_ERROR,
+        VERIFY_ERROR
+    };
+    
+    CLIOtaReceiver(Stream& link, uint8_t window = 1);
+    
+    // Blocks until the image is committed, rejected or the host goes quiet
+    Result receive(CLITransferStorage& storage, const String& name);
+    
+    size_t getImageSize() const { return imageSize; }
+    size_t getBytesReceived() const { return received; }
+    uint32_t getFrameErrors() const { return decoder.crcErrors(); }
+    
+    static const char* resultText(Result result);
+    
+private:
+    void sendFrame(uint8_t type, const uint8_t* payload, uint8_t length);
+    void sendOffset(uint8_t type);
+    Result finish(CLITransferStorage& storage, Result result);
+    
+    Stream& link;
+    uint8_t window;
+    CLIFrameDecoder decoder;
+    CLISha256 hash;
+    uint8_t expectedDigest[CLISha256::DIGEST_SIZE];
+    size_t imageSize;
+    size_t received;
+};
+
+#endif // CLI_OTA_H
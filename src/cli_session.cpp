@@ -0,0 +1,428 @@
+#include "cli_session.h"
+
+// ========================================================================
+// RECORDER
+// ========================================================================
+
+CLISessionRecorder::CLISessionRecorder(Stream& output, Print& recording) :
+    link(output),
+    file(recording),
+    finished(false),
+    kind(0),
+    recordMs(0),
+    lastMs(millis()),
+    used(0),
+    rxBytes(0),
+    txBytes(0),
+    written(0) {
+    written += file.write(CLISessionFormat::MAGIC, sizeof(CLISessionFormat::MAGIC));
+    written += file.write(CLISessionFormat::VERSION);
+}
+
+int CLISessionRecorder::read() {
+    int value = link.read();
+    if (value >= 0) {
+        uint8_t byte = (uint8_t)value;
+        record(CLISessionFormat::RX, &byte, 1);
+    }
+    return value;
+}
+
+size_t CLISessionRecorder::write(uint8_t value) {
+    record(CLISessionFormat::TX, &value, 1);
+    return link.write(value);
+}
+
+size_t CLISessionRecorder::write(const uint8_t* data, size_t size) {
+    record(CLISessionFormat::TX, data, size);
+    return link.write(data, size);
+}
+
+void CLISessionRecorder::flush() {
+    link.flush();
+}
+
+void CLISessionRecorder::finish() {
+    if (finished) {
+        return;
+    }
+    writeRecord();
+    kind = CLISessionFormat::END;
+    recordMs = millis();
+    writeRecord();
+    finished = true;
+}
+
+void CLISessionRecorder::record(uint8_t recordKind, const uint8_t* data, size_t length) {
+    if (finished) {
+        return;
+    }
+    if (recordKind == CLISessionFormat::RX) {
+        rxBytes += length;
+    } else {
+        txBytes += length;
+    }
+    
+    uint32_t now = millis();
+    while (length > 0) {
+        if (used > 0 && (recordKind != kind || now != recordMs || used == sizeof(buffer))) {
+            writeRecord();
+        }
+        if (used == 0) {
+            kind = recordKind;
+            recordMs = now;
+        }
+        size_t chunk = std::min(length, sizeof(buffer) - used);
+        memcpy(buffer + used, data, chunk);
+        used += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void CLISessionRecorder::writeRecord() {
+    if (used == 0 && kind != CLISessionFormat::END) {
+        return;
+    }
+    uint8_t header[1 + 2 * CLIVarint::MAX_SIZE];
+    size_t length = 0;
+    header[length++] = kind;
+    length += CLIVarint::put(header + length, recordMs - lastMs);
+    length += CLIVarint::put(header + length, (uint32_t)used);
+    written += file.write(header, length);
+    written += file.write(buffer, used);
+    lastMs = recordMs;
+    used = 0;
+}
+
+// ========================================================================
+// REPLAY
+// ========================================================================
+
+static bool readByte(Stream& source, uint8_t& value) {
+    int c = source.read();
+    if (c < 0) {
+        return false;
+    }
+    value = (uint8_t)c;
+    return true;
+}
+
+static bool readVarint(Stream& source, uint32_t& value) {
+    uint8_t bytes[CLIVarint::MAX_SIZE];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        if (!readByte(source, bytes[i])) {
+            return false;
+        }
+        if ((bytes[i] & 0x80) == 0) {
+            return CLIVarint::get(bytes, i + 1, &value) == i + 1;
+        }
+    }
+    return false;
+}
+
+CLISessionReplay::CLISessionReplay(Stream& input, Stream& expected, bool paced) :
+    realtime(paced),
+    startMs(millis()) {
+    memset(&result, 0, sizeof(result));
+    result.firstMismatch = SIZE_MAX;
+    result.valid = readHeader(input) && readHeader(expected);
+    
+    rx.source = &input;
+    rx.length = rx.position = 0;
+    rx.timeMs = 0;
+    rx.ended = !result.valid;
+    tx = rx;
+    tx.source = &expected;
+}
+
+bool CLISessionReplay::readHeader(Stream& source) {
+    uint8_t header[CLISessionFormat::HEADER_SIZE];
+    for (size_t i = 0; i < sizeof(header); i++) {
+        if (!readByte(source, header[i])) {
+            return false;
+        }
+    }
+    return memcmp(header, CLISessionFormat::MAGIC, sizeof(CLISessionFormat::MAGIC)) == 0 &&
+           header[4] == CLISessionFormat::VERSION;
+}
+
+// Loads the next record of one kind into the cursor, skipping the others.
+// A damaged or truncated recording ends like one that reached END.
+bool CLISessionReplay::next(Cursor& cursor, uint8_t kind) {
+    while (!cursor.ended) {
+        uint8_t recordKind;
+        uint32_t delta;
+        uint32_t length;
+        if (!readByte(*cursor.source, recordKind) || !readVarint(*cursor.source, delta) ||
+            !readVarint(*cursor.source, length) || length > CLISessionFormat::MAX_RECORD ||
+            recordKind == CLISessionFormat::END) {
+            break;
+        }
+        cursor.timeMs += delta;
+        
+        bool wanted = recordKind == kind;
+        for (uint32_t i = 0; i < length; i++) {
+            uint8_t value;
+            if (!readByte(*cursor.source, value)) {
+                cursor.ended = true;
+                return false;
+            }
+            if (wanted) {
+                cursor.data[i] = value;
+            }
+        }
+        if (wanted && length > 0) {
+            cursor.length = length;
+            cursor.position = 0;
+            return true;
+        }
+    }
+    cursor.ended = true;
+    return false;
+}
+
+int CLISessionReplay::available() {
+    if (rx.position == rx.length && !next(rx, CLISessionFormat::RX)) {
+        return 0;
+    }
+    if (realtime && millis() - startMs < rx.timeMs) {
+        return 0;
+    }
+    return (int)(rx.length - rx.position);
+}
+
+int CLISessionReplay::read() {
+    if (available() == 0) {
+        return -1;
+    }
+    result.inputBytes++;
+    return rx.data[rx.position++];
+}
+
+int CLISessionReplay::peek() {
+    return available() > 0 ? rx.data[rx.position] : -1;
+}
+
+size_t CLISessionReplay::write(uint8_t value) {
+    if (tx.position == tx.length && !next(tx, CLISessionFormat::TX)) {
+        result.uncheckedBytes++;
+        return 1;
+    }
+    if (tx.data[tx.position++] != value) {
+        if (result.mismatches == 0) {
+            result.firstMismatch = result.outputBytes;
+        }
+        result.mismatches++;
+    }
+    result.outputBytes++;
+    return 1;
+}
+
+size_t CLISessionReplay::write(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        write(data[i]);
+    }
+    return size;
+}
+
+bool CLISessionReplay::inputDone() {
+    return rx.ended && rx.position == rx.length;
+}
+
+// Counts the recorded output that was never written
+CLISessionReplay::Result CLISessionReplay::finish() {
+    result.missingBytes += tx.length - tx.position;
+    tx.position = tx.length;
+    while (next(tx, CLISessionFormat::TX)) {
+        result.missingBytes += tx.length;
+        tx.position = tx.length;
+    }
+    result.elapsedMs = millis() - startMs;
+    return result;
+}
+
+CLISessionReplay::Result CLISessionReplay::run(GenericCLI& cli, Stream& input, Stream& expected, bool realtime) {
+    CLISessionReplay replay(input, expected, realtime);
+    if (!replay.result.valid) {
+        return replay.result;
+    }
+    
+    // Set the live session aside and start where a recording starts
+    String savedInput = cli.inputBuffer;
+    size_t savedCursor = cli.cursorPos;
+    uint8_t savedMode = cli.activeMode;
+    bool savedRunning = cli.isRunning;
+    std::deque<String> savedHistory;
+    savedHistory.swap(cli.commandHistory);
+    JobCallback savedJob;
+    std::swap(savedJob, cli.job);
+    cli.exitHistoryMode();
+    cli.inputBuffer = "";
+    cli.cursorPos = 0;
+    cli.activeMode = 0;
+    cli.escapeState = GenericCLI::EscapeState::NONE;
+    cli.lastWasCR = false;
+    cli.discardingInput = false;
+    
+    Stream* previous = cli.swapStream(&replay);
+    cli.printPrompt();
+    
+    while (!replay.inputDone() && cli.isRunning) {
+        uint32_t start = micros();
+        cli.update();
+        replay.result.updateMicros += micros() - start;
+        replay.result.updates++;
+        if (realtime) {
+            delay(1);
+        }
+    }
+    
+    cli.swapStream(previous);
+    cli.exitHistoryMode();
+    cli.inputBuffer = savedInput;
+    cli.cursorPos = savedCursor;
+    cli.activeMode = savedMode;
+    cli.isRunning = savedRunning;
+    cli.commandHistory.swap(savedHistory);
+    std::swap(savedJob, cli.job);
+    cli.escapeState = GenericCLI::EscapeState::NONE;
+    cli.lastWasCR = false;
+    cli.discardingInput = false;
+    return replay.finish();
+}
+
+// ========================================================================
+// COMMANDS
+// ========================================================================
+
+namespace CLISession {
+
+    static fs::File recordingFile;
+    static CLISessionRecorder* recorder = nullptr;
+    static bool replaying = false;
+    
+    static void handleRecord(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (recorder != nullptr) {
+            cli.printError("Already recording, use 'session stop' first");
+            return;
+        }
+        String path = args.getPositional(1);
+        if (path.isEmpty()) {
+            cli.printError("Usage: session record <file>");
+            return;
+        }
+        recordingFile = filesystem.open(path, "w");
+        if (!recordingFile) {
+            cli.printError("Cannot create " + path);
+            return;
+        }
+        
+        cli.printInfo("Recording to " + path + ", 'session stop' ends it");
+        recorder = new CLISessionRecorder(cli.getStream(), recordingFile);
+        cli.swapStream(recorder);
+    }
+    
+    static void handleStop(GenericCLI& cli) {
+        if (recorder == nullptr) {
+            cli.printError("Not recording");
+            return;
+        }
+        recorder->finish();
+        cli.swapStream(&recorder->getLink());
+        size_t input = recorder->inputBytes();
+        size_t output = recorder->outputBytes();
+        size_t size = recorder->fileBytes();
+        delete recorder;
+        recorder = nullptr;
+        recordingFile.close();
+        
+        cli.printSuccess("Recorded " + String((unsigned long)input) + " bytes in, " +
+                         String((unsigned long)output) + " bytes out, " +
+                         String((unsigned long)size) + " bytes written");
+    }
+    
+    static void handleReplay(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        String path = args.getPositional(1);
+        if (path.isEmpty()) {
+            cli.printError("Usage: session replay <file> [--realtime]");
+            return;
+        }
+        if (recorder != nullptr) {
+            cli.printError("Stop the recording first");
+            return;
+        }
+        fs::File input = filesystem.open(path, "r");
+        fs::File expected = filesystem.open(path, "r");
+        if (!input || !expected) {
+            cli.printError("Cannot open " + path);
+            return;
+        }
+        
+        replaying = true;
+        CLISessionReplay::Result result = CLISessionReplay::run(cli, input, expected, args.hasFlag("realtime"));
+        replaying = false;
+        input.close();
+        expected.close();
+        
+        if (!result.valid) {
+            cli.printError(path + " is not a session recording");
+            return;
+        }
+        
+        Stream& io = cli.getStream();
+        io.print("Input     ");
+        cli.printBytes(result.inputBytes);
+        io.print("\r\nOutput    ");
+        cli.printBytes(result.outputBytes);
+        io.print(" compared");
+        if (result.missingBytes > 0) {
+            io.print(", ");
+            cli.printBytes(result.missingBytes);
+            io.print(" missing");
+        }
+        io.print("\r\nupdate()  ");
+        cli.printNum(result.updateMicros);
+        io.print(" us in ");
+        cli.printNum(result.updates);
+        io.print(" calls");
+        if (result.inputBytes > 0) {
+            io.print(", ");
+            cli.printFixed((float)result.updateMicros / result.inputBytes, 1);
+            io.print(" us per input byte");
+        }
+        io.print("\r\nElapsed   ");
+        cli.printNum(result.elapsedMs);
+        io.print(" ms\r\n");
+        
+        if (result.mismatches == 0 && result.missingBytes == 0) {
+            cli.printSuccess("Output matches the recording");
+        } else {
+            cli.printWarning(String((unsigned long)result.mismatches) + " byte(s) differ, first at offset " +
+                             String((unsigned long)(result.mismatches > 0 ? result.firstMismatch : result.outputBytes)));
+        }
+    }
+    
+    void registerSessionCommands(GenericCLI& cli, fs::FS& filesystem) {
+        cli.registerCommand("session", "Record and replay CLI sessions",
+            "session <record <file>|stop|replay <file>> [--realtime]",
+            [&cli, &filesystem](const CLIArgs& args) {
+                String action = args.getPositional(0);
+                action.toLowerCase();
+                
+                // Commands replayed from a recording must not touch the recorder
+                if (replaying) {
+                    return;
+                }
+                if (action == "record") {
+                    handleRecord(cli, filesystem, args);
+                } else if (action == "stop") {
+                    handleStop(cli);
+                } else if (action == "replay") {
+                    handleReplay(cli, filesystem, args);
+                } else {
+                    cli.printError("Usage: session <record <file>|stop|replay <file>> [--realtime]");
+                }
+            }, "Debug");
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef CLI_SESSION_H
+#define CLI_SESSION_H
+
+#include "generic_cli.h"
+#include "cli_codec.h"
+#include <FS.h>
+
+/**
+ * Session Recording and Replay
+ * 
+ * CLISessionRecorder sits between the CLI and its stream and writes what
+ * the CLI reads (RX) and writes (TX), with millisecond timing, to a file
+ * (CLISessionFormat in cli_codec.h). Bytes are grouped per millisecond, so
+ * typing costs a few bytes per keystroke and command output is stored
+ * nearly as is.
+ * 
+ * CLISessionReplay feeds the recorded input back through update() and
+ * compares everything the CLI writes with the recorded output, byte by
+ * byte. A replay starts at the prompt of the global mode with an empty
+ * history, so record from there and recall only lines typed during the
+ * recording; the live input line, history and mode are put back
+ * afterwards. Output that depends on time or on the device state (uptime,
+ * free heap) differs by nature, so a recording made for regression checks
+ * should stick to deterministic commands.
+ * 
+ *   session record <file>                   Record until `session stop`
+ *   session stop
+ *   session replay <file> [--realtime]      Replay and compare
+ * 
+ * Without --realtime the input is available at once and the replay runs
+ * as fast as update() takes it (maxBytesPerUpdate still applies), which
+ * gives the processing time; with it, input is delivered at the recorded
+ * pace. Output after the end of the recording (that of `session stop`)
+ * is not compared. tools/cli_session replays a recording from the host
+ * against a device over the serial port; tools/test/session_replay runs
+ * the replay itself on the host.
+ * 
+ * Usage:
+ *   LittleFS.begin(true);
+ *   CLISession::registerSessionCommands(cli, LittleFS);
+ */
+
+class CLISessionRecorder : public Stream {
+public:
+    // Writes the file header; file must outlive the recorder
+    CLISessionRecorder(Stream& link, Print& file);
+    ~CLISessionRecorder() { finish(); }
+    
+    // Stream interface
+    int available() override { return link.available(); }
+    int read() override;
+    int peek() override { return link.peek(); }
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush() override;
+    using Print::write;
+    
+    // Writes the END record; later traffic passes through unrecorded
+    void finish();
+    
+    Stream& getLink() { return link; }
+    size_t inputBytes() const { return rxBytes; }
+    size_t outputBytes() const { return txBytes; }
+    size_t fileBytes() const { return written; }
+
+private:
+    CLISessionRecorder(const CLISessionRecorder&) = delete;
+    CLISessionRecorder& operator=(const CLISessionRecorder&) = delete;
+    
+    void record(uint8_t kind, const uint8_t* data, size_t length);
+    void writeRecord();
+    
+    Stream& link;
+    Print& file;
+    bool finished;
+    
+    // Record being collected: one kind, one millisecond
+    uint8_t kind;
+    uint32_t recordMs;
+    uint32_t lastMs;
+    uint8_t buffer[CLISessionFormat::MAX_RECORD];
+    size_t used;
+    
+    size_t rxBytes;
+    size_t txBytes;
+    size_t written;
+};
+
+class CLISessionReplay : public Stream {
+public:
+    struct Result {
+        bool valid;                 // Both inputs are recordings
+        size_t inputBytes;          // Recorded input fed to the CLI
+        size_t outputBytes;         // Output compared with the recording
+        size_t mismatches;          // Compared bytes that differ
+        size_t firstMismatch;       // Output offset of the first, SIZE_MAX if none
+        size_t missingBytes;        // Recorded output the CLI did not write
+        size_t uncheckedBytes;      // Written after the end of the recording
+        uint32_t updateMicros;      // Time spent in update()
+        uint32_t updates;
+        uint32_t elapsedMs;
+    };
+    
+    // input and expected read the same recording, each at its own position
+    // (e.g. the file opened twice); RX is taken from one, TX from the other
+    CLISessionReplay(Stream& input, Stream& expected, bool realtime = false);
+    
+    // Stream interface: reads give the recorded input, writes are compared
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush() override {}
+    using Print::write;
+    
+    bool inputDone();
+    Result finish();
+    
+    // Replays through cli.update() with the live session state set aside
+    static Result run(GenericCLI& cli, Stream& input, Stream& expected, bool realtime = false);
+
+private:
+    CLISessionReplay(const CLISessionReplay&) = delete;
+    CLISessionReplay& operator=(const CLISessionReplay&) = delete;
+    
+    struct Cursor {
+        Stream* source;
+        uint8_t data[CLISessionFormat::MAX_RECORD];
+        size_t length;
+        size_t position;
+        uint32_t timeMs;            // Of the record held, from the start
+        bool ended;
+    };
+    
+    static bool readHeader(Stream& source);
+    static bool next(Cursor& cursor, uint8_t kind);
+    
+    Cursor rx;
+    Cursor tx;
+    bool realtime;
+    uint32_t startMs;
+    Result result;
+};
+
+namespace CLISession {
+    void registerSessionCommands(GenericCLI& cli, fs::FS& filesystem);
+}
+
+#endif // CLI_SESSION_H
@@ -0,0 +1,651 @@
+#include "cli_settings.h"
+#include "cli_json.h"
+#include <errno.h>
+
+#if defined(ESP32)
+#include <nvs.h>
+#endif
+
+CLISettings::CLISettings(const char* ns) : storageNamespace(ns) {}
+
+// ========================================================================
+// REGISTRATION
+// ========================================================================
+
+bool CLISettings::add(const CLISetting& setting) {
+    size_t length = strlen(setting.name);
+    if (length == 0 || length > MAX_NAME_LENGTH || indexOf(setting.name) >= 0) {
+        return false;
+    }
+    
+    settings.push_back(setting);
+    applyDefault(settings.back());
+    settings.back().dirty = false;
+    
+    // Keep the name index sorted
+    uint16_t index = settings.size() - 1;
+    auto position = std::lower_bound(sorted.begin(), sorted.end(), setting.name,
+        [this](uint16_t i, const char* name) { return strcmp(settings[i].name, name) < 0; });
+    sorted.insert(position, index);
+    return true;
+}
+
+bool CLISettings::addBool(const char* name, bool* value, bool defaultValue, const char* description) {
+    return add({ name, description, CLISettingType::BOOL, value, sizeof(bool), 0, 1,
+                 defaultValue ? 1.0f : 0.0f, 0, 0, 0, nullptr, false, false });
+}
+
+bool CLISettings::addInt(const char* name, int32_t* value, int32_t defaultValue, 
+                         int32_t minimum, int32_t maximum, const char* description) {
+    return add({ name, description, CLISettingType::INT, value, sizeof(int32_t), 
+                 0, 0, 0, minimum, maximum, defaultValue, nullptr, false, false });
+}
+
+bool CLISettings::addFloat(const char* name, float* value, float defaultValue, 
+                           float minimum, float maximum, const char* description) {
+    return add({ name, description, CLISettingType::FLOAT, value, sizeof(float), 
+                 minimum, maximum, defaultValue, 0, 0, 0, nullptr, false, false });
+}
+
+bool CLISettings::addString(const char* name, char* buffer, size_t size, const char* defaultValue,
+                            const char* description, bool secret) {
+    if (size == 0 || strlen(defaultValue) >= size) {
+        return false;
+    }
+    return add({ name, description, CLISettingType::STRING, buffer, size, 0, 0, 0, 0, 0, 0,
+                 defaultValue, secret, false });
+}
+
+// ========================================================================
+// LOOKUP
+// ========================================================================
+
+int CLISettings::indexOf(const String& name) const {
+    auto position = std::lower_bound(sorted.begin(), sorted.end(), name,
+        [this](uint16_t i, const String& key) { return strcmp(settings[i].name, key.c_str()) < 0; });
+    if (position != sorted.end() && name.equals(settings[*position].name)) {
+        return *position;
+    }
+    return -1;
+}
+
+const CLISetting* CLISettings::find(const String& name) const {
+    int index = indexOf(name);
+    return index >= 0 ? &settings[index] : nullptr;
+}
+
+void CLISettings::complete(const String& prefix, std::vector<String>& names) const {
+    // All names with the prefix are adjacent in the sorted index
+    auto position = std::lower_bound(sorted.begin(), sorted.end(), prefix,
+        [this](uint16_t i, const String& key) { return strcmp(settings[i].name, key.c_str()) < 0; });
+    for (; position != sorted.end(); ++position) {
+        const char* name = settings[*position].name;
+        if (strncmp(name, prefix.c_str(), prefix.length()) != 0) {
+            break;
+        }
+        names.push_back(name);
+    }
+}
+
+// ========================================================================
+// VALUES
+// ========================================================================
+
+bool CLISettings::parse(const CLISetting& setting, const String& text, void* out) {
+    String value = text;
+    value.trim();
+    char* end = nullptr;
+    
+    switch (setting.type) {
+        case CLISettingType::BOOL: {
+            String lower = value;
+            lower.toLowerCase();
+            if (lower == "true" || lower == "1" || lower == "yes" || lower == "on") {
+                *static_cast<bool*>(out) = true;
+            } else if (lower == "false" || lower == "0" || lower == "no" || lower == "off") {
+                *static_cast<bool*>(out) = false;
+            } else {
+                error = "Expected true/false, yes/no, on/off or 1/0";
+                return false;
+            }
+            return true;
+        }
+        
+        case CLISettingType::INT: {
+            // 64-bit parse, so values beyond int32_t fail the range check
+            // instead of wrapping (long is 32 bits on the ESP32)
+            errno = 0;
+            long long number = strtoll(value.c_str(), &end, 0);
+            if (value.isEmpty() || *end != '\0') {
+                error = "Expected an integer";
+                return false;
+            }
+            if (errno == ERANGE || number < setting.intMinimum || number > setting.intMaximum) {
+                error = "Must be between " + String((long)setting.intMinimum) + " and " + String((long)setting.intMaximum);
+                return false;
+            }
+            *static_cast<int32_t*>(out) = (int32_t)number;
+            return true;
+        }
+        
+        case CLISettingType::FLOAT: {
+            float number = strtof(value.c_str(), &end);
+            if (value.isEmpty() || *end != '\0') {
+                error = "Expected a number";
+                return false;
+            }
+            // Written so that nan fails it too
+            if (!(number >= setting.minimum && number <= setting.maximum)) {
+                error = "Must be between " + String(setting.minimum, 3) + " and " + String(setting.maximum, 3);
+                return false;
+            }
+            *static_cast<float*>(out) = number;
+            return true;
+        }
+        
+        case CLISettingType::STRING:
+            // Strings are copied by set() straight into the application buffer
+            if (text.length() >= setting.size) {
+                error = "Too long (max " + String((unsigned long)setting.size - 1) + " characters)";
+                return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+bool CLISettings::set(const String& name, const String& value) {
+    int index = indexOf(name);
+    if (index < 0) {
+        error = "Unknown setting: " + name;
+        return false;
+    }
+    CLISetting& setting = settings[index];
+    
+    union { bool b; int32_t i; float f; } parsed;
+    if (!parse(setting, value, &parsed)) {
+        return false;
+    }
+    
+    bool different;
+    switch (setting.type) {
+        case CLISettingType::BOOL:
+            different = *static_cast<bool*>(setting.value) != parsed.b;
+            *static_cast<bool*>(setting.value) = parsed.b;
+            break;
+        case CLISettingType::INT:
+            different = *static_cast<int32_t*>(setting.value) != parsed.i;
+            *static_cast<int32_t*>(setting.value) = parsed.i;
+            break;
+        case CLISettingType::FLOAT:
+            different = *static_cast<float*>(setting.value) != parsed.f;
+            *static_cast<float*>(setting.value) = parsed.f;
+            break;
+        case CLISettingType::STRING:
+        default:
+            different = strcmp(static_cast<char*>(setting.value), value.c_str()) != 0;
+            strcpy(static_cast<char*>(setting.value), value.c_str());
+            break;
+    }
+    
+    if (different) {
+        changed(setting);
+    }
+    return true;
+}
+
+String CLISettings::format(const CLISetting& setting, bool reveal) {
+    switch (setting.type) {
+        case CLISettingType::BOOL:
+            return *static_cast<const bool*>(setting.value) ? "true" : "false";
+        case CLISettingType::INT:
+            return String((long)*static_cast<const int32_t*>(setting.value));
+        case CLISettingType::FLOAT:
+            return String(*static_cast<const float*>(setting.value), 3);
+        case CLISettingType::STRING: {
+            const char* text = static_cast<const char*>(setting.value);
+            if (setting.secret && !reveal && text[0] != '\0') {
+                return "********";
+            }
+            return text;
+        }
+    }
+    return "";
+}
+
+String CLISettings::get(const String& name) const {
+    const CLISetting* setting = find(name);
+    return setting ? format(*setting) : "";
+}
+
+void CLISettings::applyDefault(CLISetting& setting) {
+    switch (setting.type) {
+        case CLISettingType::BOOL:
+            *static_cast<bool*>(setting.value) = setting.defaultNumber != 0;
+            break;
+        case CLISettingType::INT:
+            *static_cast<int32_t*>(setting.value) = setting.intDefault;
+            break;
+        case CLISettingType::FLOAT:
+            *static_cast<float*>(setting.value) = setting.defaultNumber;
+            break;
+        case CLISettingType::STRING:
+            strcpy(static_cast<char*>(setting.value), setting.defaultText);
+            break;
+    }
+}
+
+void CLISettings::changed(CLISetting& setting) {
+    setting.dirty = true;
+    if (changeCallback) {
+        changeCallback(setting);
+    }
+}
+
+void CLISettings::resetDefaults() {
+    for (auto& setting : settings) {
+        String before = format(setting, true);
+        applyDefault(setting);
+        if (format(setting, true) != before) {
+            changed(setting);
+        }
+    }
+}
+
+size_t CLISettings::dirtyCount() const {
+    size_t count = 0;
+    for (const auto& setting : settings) {
+        if (setting.dirty) count++;
+    }
+    return count;
+}
+
+// ========================================================================
+// PERSISTENCE (NVS)
+// ========================================================================
+
+int CLISettings::load() {
+    int found = 0;
+#if defined(ESP32)
+    nvs_handle_t handle;
+    if (nvs_open(storageNamespace, NVS_READONLY, &handle) != ESP_OK) {
+        // Namespace is created by the first save
+        return 0;
+    }
+    
+    for (auto& setting : settings) {
+        bool loaded = false;
+        switch (setting.type) {
+            case CLISettingType::BOOL: {
+                uint8_t value;
+                if (nvs_get_u8(handle, setting.name, &value) == ESP_OK) {
+                    *static_cast<bool*>(setting.value) = value != 0;
+                    loaded = true;
+                }
+                break;
+            }
+            case CLISettingType::INT: {
+                int32_t value;
+                // Values outside a (since changed) range keep the default
+                if (nvs_get_i32(handle, setting.name, &value) == ESP_OK &&
+                    value >= setting.intMinimum && value <= setting.intMaximum) {
+                    *static_cast<int32_t*>(setting.value) = value;
+                    loaded = true;
+                }
+                break;
+            }
+            case CLISettingType::FLOAT: {
+                uint32_t bits;
+                float value;
+                if (nvs_get_u32(handle, setting.name, &bits) == ESP_OK) {
+                    memcpy(&value, &bits, sizeof(value));
+                    if (value >= setting.minimum && value <= setting.maximum) {
+                        *static_cast<float*>(setting.value) = value;
+                        loaded = true;
+                    }
+                }
+                break;
+            }
+            case CLISettingType::STRING: {
+                size_t length = setting.size;
+                if (nvs_get_str(handle, setting.name, static_cast<char*>(setting.value), &length) == ESP_OK) {
+                    loaded = true;
+                } else {
+                    applyDefault(setting);
+                }
+                break;
+            }
+        }
+        
+        setting.dirty = false;
+        if (loaded) {
+            found++;
+            if (changeCallback) {
+                changeCallback(setting);
+            }
+        }
+    }
+    nvs_close(handle);
+#endif
+    return found;
+}
+
+bool CLISettings::save(size_t* written) {
+    if (written) {
+        *written = 0;
+    }
+    if (dirtyCount() == 0) {
+        return true;
+    }
+    
+#if defined(ESP32)
+    nvs_handle_t handle;
+    esp_err_t result = nvs_open(storageNamespace, NVS_READWRITE, &handle);
+    if (result != ESP_OK) {
+        error = String("Cannot open NVS: ") + esp_err_to_name(result);
+        return false;
+    }
+    
+    // Stage every changed key, then commit once
+    size_t count = 0;
+    for (const auto& setting : settings) {
+        if (!setting.dirty) continue;
+        
+        switch (setting.type) {
+            case CLISettingType::BOOL:
+                result = nvs_set_u8(handle, setting.name, *static_cast<const bool*>(setting.value) ? 1 : 0);
+                break;
+            case CLISettingType::INT:
+                result = nvs_set_i32(handle, setting.name, *static_cast<const int32_t*>(setting.value));
+                break;
+            case CLISettingType::FLOAT: {
+                uint32_t bits;
+                memcpy(&bits, setting.value, sizeof(bits));
+                result = nvs_set_u32(handle, setting.name, bits);
+                break;
+            }
+            case CLISettingType::STRING:
+                result = nvs_set_str(handle, setting.name, static_cast<const char*>(setting.value));
+                break;
+        }
+        if (result != ESP_OK) {
+            error = String(setting.name) + ": " + esp_err_to_name(result);
+            nvs_close(handle);
+            return false;
+        }
+        count++;
+    }
+    
+    result = nvs_commit(handle);
+    nvs_close(handle);
+    if (result != ESP_OK) {
+        error = String("Commit failed: ") + esp_err_to_name(result);
+        return false;
+    }
+    
+    for (auto& setting : settings) {
+        setting.dirty = false;
+    }
+    if (written) {
+        *written = count;
+    }
+    return true;
+#else
+    error = "No persistent storage on this platform";
+    return false;
+#endif
+}
+
+// ========================================================================
+// JSON IMPORT / EXPORT
+// ========================================================================
+
+static void printJsonString(Stream& io, const char* text) {
+    io.print('"');
+    for (const char* p = text; *p; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            io.print('\\');
+            io.print(c);
+        } else if ((uint8_t)c < 0x20) {
+            io.printf("\\u%04x", (unsigned)c);
+        } else {
+            io.print(c);
+        }
+    }
+    io.print('"');
+}
+
+void CLISettings::exportJson(Stream& io, bool includeSecrets) const {
+    io.print("{");
+    bool first = true;
+    for (uint16_t index : sorted) {
+        const CLISetting& setting = settings[index];
+        if (setting.secret && !includeSecrets) continue;
+        
+        io.print(first ? "\r\n  " : ",\r\n  ");
+        first = false;
+        printJsonString(io, setting.name);
+        io.print(": ");
+        if (setting.type == CLISettingType::STRING) {
+            printJsonString(io, static_cast<const char*>(setting.value));
+        } else {
+            io.print(format(setting, true));
+        }
+    }
+    io.print("\r\n}\r\n");
+}
+
+CLISettings::ImportResult CLISettings::importJson(Stream& io, uint32_t timeoutMs, 
+                                                  std::function<void(const String&)> warn) {
+    ImportResult result = { 0, 0, 0, false, "" };
+    
+    // Values are applied as they are parsed; nothing but the parser state is kept
+    CLIJsonParser parser([&](const char* path, CLIJsonType type, const char* value) {
+        if (type == CLIJsonType::NUL) {
+            result.skipped++;
+            return;
+        }
+        // Nested objects map onto flat names: {"wifi": {"ssid": ..}} -> wifi_ssid
+        String name = path;
+        if (indexOf(name) < 0) {
+            name.replace(".", "_");
+        }
+        if (indexOf(name) < 0) {
+            result.skipped++;
+            if (warn) warn(String("Unknown setting: ") + path);
+            return;
+        }
+        if (set(name, value)) {
+            result.applied++;
+        } else {
+            result.rejected++;
+            if (warn) warn(name + ": " + error);
+        }
+    });
+    
+    unsigned long last = millis();
+    while (parser.status() == CLIJsonParser::Status::MORE) {
+        if (!io.available()) {
+            if (millis() - last > timeoutMs) {
+                result.error = "Timeout waiting for data";
+                return result;
+            }
+            delay(1);
+            continue;
+        }
+        char c = io.read();
+        last = millis();
+        if (c == 0x03) { // Ctrl-C
+            result.error = "Cancelled";
+            return result;
+        }
+        parser.feed(c);
+    }
+    
+    if (parser.status() == CLIJsonParser::Status::ERROR) {
+        result.error = String(parser.error()) + " at character " + String((unsigned long)parser.position());
+        // Discard the rest of the document so it does not reach the command line
+        last = millis();
+        while (millis() - last < 200) {
+            if (io.available()) {
+                io.read();
+                last = millis();
+            } else {
+                delay(1);
+            }
+        }
+        return result;
+    }
+    
+    // Swallow the line end that followed the closing brace
+    delay(20);
+    while (io.available() && (io.peek() == '\r' || io.peek() == '\n')) {
+        io.read();
+    }
+    result.complete = true;
+    return result;
+}
+
+// ========================================================================
+// COMMANDS
+// ========================================================================
+
+void CLISettings::registerCommands(GenericCLI& cli, const String& category, const String& command) {
+    String usage = command + " <get|set|list|save|import|export|reset> [name] [value] [--save] [--secrets]";
+    
+    cli.registerCommand(command, "Show, change, save, import or export settings", usage,
+        [this, &cli, command, usage](const CLIArgs& args) {
+            String action = args.getPositional(0);
+            String name = args.getPositional(1);
+            Stream& io = cli.getStream();
+            
+            if (action == "get") {
+                const CLISetting* setting = find(name);
+                if (setting == nullptr) {
+                    cli.printError(name.isEmpty() ? "Usage: " + command + " get <name>" : "Unknown setting: " + name);
+                    return;
+                }
+                
+                String details;
+                if (setting->type == CLISettingType::INT) {
+                    details = "int, " + String((long)setting->intMinimum) + ".." + String((long)setting->intMaximum) +
+                              ", default " + String((long)setting->intDefault);
+                } else if (setting->type == CLISettingType::FLOAT) {
+                    details = "float, " + String(setting->minimum, 3) + ".." + String(setting->maximum, 3) +
+                              ", default " + String(setting->defaultNumber, 3);
+                } else if (setting->type == CLISettingType::BOOL) {
+                    details = String("bool, default ") + (setting->defaultNumber != 0 ? "true" : "false");
+                } else {
+                    details = "string, max " + String((unsigned long)setting->size - 1) + " chars";
+                }
+                cli.println(String(setting->name) + " = " + format(*setting) + "  (" + details + ")");
+                if (strlen(setting->description) > 0) {
+                    cli.println("  " + String(setting->description));
+                }
+                return;
+            }
+            
+            if (action == "set") {
+                if (args.size() < 3) {
+                    cli.printError("Usage: " + command + " set <name> <value>");
+                    return;
+                }
+                if (!set(name, args.getPositional(2))) {
+                    cli.printError(error);
+                    return;
+                }
+                const CLISetting* setting = find(name);
+                cli.printSuccess(String(setting->name) + " = " + format(*setting) + 
+                                 (setting->dirty ? " (not saved)" : ""));
+                return;
+            }
+            
+            if (action == "list") {
+                size_t width = 0;
+                for (uint16_t index : sorted) {
+                    width = std::max(width, strlen(settings[index].name));
+                }
+                
+                for (uint16_t index : sorted) {
+                    const CLISetting& setting = settings[index];
+                    if (strncmp(setting.name, name.c_str(), name.length()) != 0) continue;
+                    io.printf("%c %-*s  %-20s  %s\r\n", setting.dirty ? '*' : ' ', (int)width, setting.name,
+                              format(setting).c_str(), setting.description);
+                }
+                size_t dirty = dirtyCount();
+                if (dirty > 0) {
+                    cli.printInfo(String((unsigned long)dirty) + " unsaved change(s), use '" + command + " save'");
+                }
+                return;
+            }
+    
+            if (action == "save") {
+                size_t written = 0;
+                if (!save(&written)) {
+                    cli.printError("Save failed: " + error);
+                    return;
+                }
+                if (written == 0) {
+                    cli.printInfo("No changes to save");
+                } else {
+                    cli.printSuccess("Saved " + String((unsigned long)written) + " setting(s)");
+                }
+                return;
+            }
+            
+            if (action == "export") {
+                exportJson(io, args.hasFlag("secrets"));
+                return;
+            }
+            
+            if (action == "import") {
+                cli.printInfo("Send a JSON object (Ctrl-C cancels)...");
+                ImportResult result = importJson(io, 10000, [&cli](const String& message) {
+                    cli.printWarning(message);
+                });
+                
+                String summary = String((unsigned long)result.applied) + " applied, " + 
+                                 String((unsigned long)result.rejected) + " rejected, " +
+                                 String((unsigned long)result.skipped) + " skipped";
+                if (!result.complete) {
+                    cli.printError("Import stopped: " + result.error + " (" + summary + ")");
+                    return;
+                }
+                cli.printSuccess("Import complete: " + summary);
+                if (args.hasFlag("save") && result.rejected == 0) {
+                    size_t written = 0;
+                    if (save(&written)) {
+                        cli.printSuccess("Saved " + String((unsigned long)written) + " setting(s)");
+                    } else {
+                        cli.printError("Save failed: " + error);
+                    }
+                } else if (dirtyCount() > 0) {
+                    cli.printInfo("Use '" + command + " save' to keep the changes");
+                }
+                return;
+            }
+            
+            if (action == "reset") {
+                resetDefaults();
+                cli.printSuccess("Settings reset to defaults (not saved)");
+                return;
+            }
+            
+            cli.printError("Usage: " + usage);
+        }, category);
+    
+    // Actions first, then setting names (for get, set and list prefixes)
+    cli.setCompleter(command, [this](size_t argIndex, const String& prefix, std::vector<String>& candidates) {
+        static const char* const actions[] = { "export", "get", "import", "list", "reset", "save", "set" };
+        if (argIndex == 0) {
+            for (const char* action : actions) {
+                if (strncmp(action, prefix.c_str(), prefix.length()) == 0) {
+                    candidates.push_back(action);
+                }
+            }
+        } else if (argIndex == 1) {
+            complete(prefix, candidates);
+        }
+    });
+}
@@ -0,0 +1,135 @@
+#ifndef CLI_SETTINGS_H
+#define CLI_SETTINGS_H
+
+#include "generic_cli.h"
+
+/**
+ * Settings Registry
+ * 
+ * Typed runtime settings backed by application variables. Each setting
+ * has a name, a type, an optional range and a default; the registry
+ * parses and validates values, tracks which ones changed since the last
+ * save and persists them in NVS (ESP32).
+ * 
+ *   config get <name>           Show one setting
+ *   config set <name> <value>   Change a setting (RAM only until saved)
+ *   config list [prefix]        Show all settings, * marks unsaved changes
+ *   config save                 Write changed settings to NVS in one commit
+ *   config import               Apply a JSON object sent over the CLI stream
+ *   config export               Print all settings as JSON
+ *   config reset                Back to the defaults
+ * 
+ * Everything is under one command so the registry does not take common
+ * names like `set` or `list` from the application; pass another name to
+ * registerCommands() if `config` is taken as well.
+ * 
+ * `config import` parses the document as it arrives (CLIJsonParser) and
+ * applies each value immediately, so documents of any size are accepted
+ * with constant memory.
+ * 
+ * Setting names are kept in a sorted index, which serves lookups and Tab
+ * completion of names. Names are also the NVS keys, so they are limited
+ * to 15 characters.
+ * 
+ * Usage:
+ *   int32_t interval;
+ *   CLISettings settings("app");
+ *   settings.addInt("interval", &interval, 5000, 1000, 60000, "Sensor interval (ms)");
+ *   settings.load();
+ *   settings.registerCommands(cli);
+ */
+
+enum class CLISettingType : uint8_t {
+    BOOL,
+    INT,
+    FLOAT,
+    STRING
+};
+
+struct CLISetting {
+    const char* name;
+    const char* description;
+    CLISettingType type;
+    void* value;                // Application variable
+    size_t size;                // STRING: buffer size including the NUL
+    float minimum;              // FLOAT range, inclusive
+    float maximum;
+    float defaultNumber;        // BOOL/FLOAT default
+    int32_t intMinimum;         // INT range, inclusive; kept as integers so
+    int32_t intMaximum;         // values above 2^24 stay exact
+    int32_t intDefault;
+    const char* defaultText;    // STRING default
+    bool secret;                // Masked by get/list
+    bool dirty;                 // Changed since load/save
+};
+
+class CLISettings {
+public:
+    static const size_t MAX_NAME_LENGTH = 15;
+    
+    explicit CLISettings(const char* storageNamespace = "cli");
+    
+    // Registration; the variable is set to its default immediately
+    bool addBool(const char* name, bool* value, bool defaultValue, const char* description = "");
+    bool addInt(const char* name, int32_t* value, int32_t defaultValue, 
+                int32_t minimum, int32_t maximum, const char* description = "");
+    bool addFloat(const char* name, float* value, float defaultValue, 
+                  float minimum, float maximum, const char* description = "");
+    bool addString(const char* name, char* buffer, size_t size, const char* defaultValue,
+                   const char* description = "", bool secret = false);
+    
+    // Access by name; set() validates and marks the setting dirty if it changed
+    const CLISetting* find(const String& name) const;
+    bool set(const String& name, const String& value);
+    String get(const String& name) const;
+    static String format(const CLISetting& setting, bool reveal = false);
+    const String& lastError() const { return error; }
+    
+    // Names starting with prefix, in order
+    void complete(const String& prefix, std::vector<String>& names) const;
+    
+    // Persistence. load() returns the number of values found in storage,
+    // save() writes only dirty settings and commits once.
+    int load();
+    bool save(size_t* written = nullptr);
+    void resetDefaults();
+    size_t dirtyCount() const;
+    
+    size_t size() const { return settings.size(); }
+    const CLISetting& at(size_t index) const { return settings[index]; }
+    
+    // JSON. importJson() reads one document from the stream and applies
+    // the values as they are parsed; warn (optional) receives per-key problems.
+    struct ImportResult {
+        size_t applied;
+        size_t rejected;
+        size_t skipped;
+        bool complete;          // Whole document parsed
+        String error;
+    };
+    void exportJson(Stream& io, bool includeSecrets = false) const;
+    ImportResult importJson(Stream& io, uint32_t timeoutMs = 10000, 
+                            std::function<void(const String&)> warn = nullptr);
+    
+    // Observer for changes made through set() / resetDefaults() / load()
+    void onChange(std::function<void(const CLISetting&)> callback) { changeCallback = callback; }
+    
+    // One command with get/set/list/save/import/export/reset and name completion
+    void registerCommands(GenericCLI& cli, const String& category = "Configuration",
+                          const String& command = "config");
+    
+private:
+    bool add(const CLISetting& setting);
+    int indexOf(const String& name) const;
+    bool parse(const CLISetting& setting, const String& text, void* out);
+    void applyDefault(CLISetting& setting);
+    void changed(CLISetting& setting);
+    
+    const char* storageNamespace;
+    std::vector<CLISetting> settings;
+    std::vector<uint16_t> sorted;       // Indices into settings, ordered by name
+    String error;
+    std::function<void(const CLISetting&)> changeCallback;
+};
+
+#endif // CLI_SETTINGS_H
@@ -1,4 +1,5 @@
 #include "cli_standard_commands.h"
+#include "cli_widgets.h"
 #include <Arduino.h>
 
 // Global state variables (outside namespace)
@@ -12,16 +13,9 @@ namespace CLIStandardCommands {
         g_cli = &cli;
     }
     
-    // Helper function to pad string to specified width
-    String padString(const String& text, int width) {
-        if (text.length() >= width) return text;
-        
-        String result = text;
-        int padding = width - text.length();
-        for (int i = 0; i < padding; i++) {
-            result += " ";
-        }
-        return result;
+    // Transport of the CLI the commands are registered with
+    Stream& io() {
+        return g_cli->getStream();
     }
     
     // ========================================================================
@@ -35,6 +29,8 @@ namespace CLIStandardCommands {
     void handleStatus(const CLIArgs& args);
     void handleColors(const CLIArgs& args);
     void handleHistory(const CLIArgs& args);
+    void handleBaud(const CLIArgs& args);
+    void handleStats(const CLIArgs& args);
     
     // ========================================================================
     // COMMAND REGISTRATION FUNCTIONS
@@ -72,10 +68,22 @@ namespace CLIStandardCommands {
     
     void registerHistoryCommand(GenericCLI& cli) {
         setCLIReference(cli);
-        cli.registerCommand("history", "Show command history", "history [clear] [--limit=n]",
+        cli.registerCommand("history", "Show command history", "history [clear] [--limit=n] [--csv|--json]",
             [](const CLIArgs& args) { handleHistory(args); }, "System");
     }
     
+    void registerBaudCommand(GenericCLI& cli) {
+        setCLIReference(cli);
+        cli.registerCommand("baud", "Change serial baud rate", "baud [rate] [--timeout=seconds]",
+            [](const CLIArgs& args) { handleBaud(args); }, "System");
+    }
+    
+    void registerStatsCommand(GenericCLI& cli) {
+        setCLIReference(cli);
+        cli.registerCommand("stats", "Show CLI input statistics", "stats [reset]",
+            [](const CLIArgs& args) { handleStats(args); }, "System");
+    }
+    
     void registerAllStandardCommands(GenericCLI& cli) {
         registerExitCommand(cli);
         registerClearCommand(cli);
@@ -83,6 +91,8 @@ namespace CLIStandardCommands {
         registerStatusCommand(cli);
         registerColorsCommand(cli);
         registerHistoryCommand(cli);
+        registerBaudCommand(cli);
+        registerStatsCommand(cli);
     }
     
     void registerBasicCommands(GenericCLI& cli) {
@@ -97,6 +107,11 @@ namespace CLIStandardCommands {
     // ========================================================================
     
     void handleExit(const CLIArgs& args) {
+        // Inside a mode, exit only leaves that mode
+        if (g_cli->exitMode()) {
+            return;
+        }
+        
         if (args.hasFlag("force")) {
             g_cli->printInfo("Force exit - goodbye!");
             g_exitRequested = true;
@@ -110,18 +125,18 @@ namespace CLIStandardCommands {
         String response = "";
         
         while (millis() < timeout) {
-            if (Serial.available()) {
-                char c = Serial.read();
+            if (io().available()) {
+                char c = io().read();
                 if (c == '\n' || c == '\r') {
                     break;
                 } else if (c >= 32 && c <= 126) {
                     response += c;
-                    Serial.print(c); // Echo the character
+                    io().print(c); // Echo the character
                 }
             }
             delay(10);
         }
-        Serial.println(); // New line after input
+        io().println(); // New line after input
         
         response.toLowerCase();
         if (response == "y" || response == "yes") {
@@ -136,7 +151,7 @@ namespace CLIStandardCommands {
     
     void handleClear(const CLIArgs& args) {
         // Clear screen using ANSI escape codes
-        Serial.print("\033[2J\033[H");
+        io().print("\033[2J\033[H");
         g_cli->printInfo("Screen cleared");
     }
     
@@ -153,104 +168,108 @@ namespace CLIStandardCommands {
             g_cli->printInfo("System will reboot in " + String(delaySeconds) + " seconds");
             g_cli->printInfo("Use 'reboot --force' for immediate restart");
             
-            for (int i = delaySeconds; i > 0; i--) {
-                Serial.println("Rebooting in " + String(i) + "...");
-                delay(1000);
+            uint32_t total = delaySeconds * 1000UL;
+            CLIProgress countdown(io(), total, "Rebooting", g_cli->getConfig().colorsEnabled);
+            countdown.setUnit(CLIProgressUnit::NONE);
+            uint32_t start = millis();
+            while (millis() - start < total) {
+                countdown.update(millis() - start);
+                delay(50);
             }
+            countdown.update(total);
+            countdown.finish();
+            io().flush();
             ESP.restart();
         }
     }
     
+    // "1h 2m 3s" (or "1h2m" compact), written without temporaries
+    static void printUptime(unsigned long seconds, bool compact) {
+        unsigned long hours = seconds / 3600;
+        unsigned long minutes = (seconds % 3600) / 60;
+        const char* separator = compact ? "" : " ";
+        if (hours > 0) {
+            g_cli->printNum(hours);
+            io().print('h');
+            io().print(separator);
+        }
+        if (hours > 0 || minutes > 0 || compact) {
+            g_cli->printNum(minutes);
+            io().print('m');
+            if (compact && hours > 0) return;
+            io().print(separator);
+        }
+        g_cli->printNum(seconds % 60);
+        io().print('s');
+    }
+    
+    // One "  "key": number," line of the JSON status
+    static void printJsonNumber(const char* key, int64_t value) {
+        io().print("  \"");
+        io().print(key);
+        io().print("\": ");
+        g_cli->printNum(value);
+        io().println(",");
+    }
+    
     void handleStatus(const CLIArgs& args) {
         bool compact = args.hasFlag("compact");
         bool jsonFormat = args.hasFlag("json");
         unsigned long uptime = millis() / 1000;
         
         if (jsonFormat) {
-            Serial.println("{");
-            Serial.println("  \"device\": \"" + String(ESP.getChipModel()) + "\",");
-            Serial.println("  \"uptime_seconds\": " + String(uptime) + ",");
-            Serial.println("  \"free_heap\": " + String(ESP.getFreeHeap()) + ",");
-            Serial.println("  \"total_heap\": " + String(ESP.getHeapSize()) + ",");
-            Serial.println("  \"cpu_freq_mhz\": " + String(ESP.getCpuFreqMHz()) + ",");
-            Serial.println("  \"flash_size\": " + String(ESP.getFlashChipSize()) + ",");
-            Serial.println("  \"chip_revision\": " + String(ESP.getChipRevision()) + ",");
-            Serial.println("  \"colors_enabled\": " + String(g_cli->getConfig().colorsEnabled ? "true" : "false"));
-            Serial.println("}");
+            io().println("{");
+            io().print("  \"device\": \"");
+            io().print(ESP.getChipModel());
+            io().println("\",");
+            printJsonNumber("uptime_seconds", uptime);
+            printJsonNumber("free_heap", ESP.getFreeHeap());
+            printJsonNumber("total_heap", ESP.getHeapSize());
+            printJsonNumber("cpu_freq_mhz", ESP.getCpuFreqMHz());
+            printJsonNumber("flash_size", ESP.getFlashChipSize());
+            printJsonNumber("chip_revision", ESP.getChipRevision());
+            io().print("  \"colors_enabled\": ");
+            io().println(g_cli->getConfig().colorsEnabled ? "true" : "false");
+            io().println("}");
         } else if (compact) {
-            String uptimeStr = "";
-            unsigned long hours = uptime / 3600;
-            unsigned long minutes = (uptime % 3600) / 60;
-            if (hours > 0) {
-                uptimeStr = String(hours) + "h" + String(minutes) + "m";
-            } else {
-                uptimeStr = String(minutes) + "m" + String(uptime % 60) + "s";
-            }
-            
-            String memStr = "";
-            size_t freeHeap = ESP.getFreeHeap();
-            if (freeHeap < 1024) {
-                memStr = String(freeHeap) + "B";
-            } else if (freeHeap < 1024 * 1024) {
-                memStr = String(freeHeap / 1024) + "KB";
-            } else {
-                memStr = String(freeHeap / (1024 * 1024)) + "MB";
-            }
-            
-            Serial.println("Status: " + String(ESP.getChipModel()) + 
-                         " | Up:" + uptimeStr + 
-                         " | RAM:" + memStr + 
-                         " | CPU:" + String(ESP.getCpuFreqMHz()) + "MHz");
+            io().print("Status: ");
+            io().print(ESP.getChipModel());
+            io().print(" | Up:");
+            printUptime(uptime, true);
+            io().print(" | RAM:");
+            g_cli->printBytes(ESP.getFreeHeap());
+            io().print(" | CPU:");
+            g_cli->printNum(ESP.getCpuFreqMHz());
+            io().println("MHz");
         } else {
-            Serial.println("\nSYSTEM STATUS");
-            Serial.println("=============");
+            io().println("\nSYSTEM STATUS");
+            io().println("=============");
             
-            String chipModel = String(ESP.getChipModel());
-            Serial.println("Chip: " + chipModel);
+            io().print("Chip: ");
+            io().println(ESP.getChipModel());
             
-            String cpuInfo = String(ESP.getCpuFreqMHz()) + " MHz";
-            Serial.println("CPU: " + cpuInfo);
+            io().print("CPU: ");
+            g_cli->printNum(ESP.getCpuFreqMHz());
+            io().println(" MHz");
             
-            // Format uptime
-            String uptimeStr = "";
-            unsigned long hours = uptime / 3600;
-            unsigned long minutes = (uptime % 3600) / 60;
-            unsigned long seconds = uptime % 60;
-            if (hours > 0) {
-                uptimeStr = String(hours) + "h " + String(minutes) + "m " + String(seconds) + "s";
-            } else if (minutes > 0) {
-                uptimeStr = String(minutes) + "m " + String(seconds) + "s";
-            } else {
-                uptimeStr = String(seconds) + "s";
-            }
-            Serial.println("Uptime: " + uptimeStr);
+            io().print("Uptime: ");
+            printUptime(uptime, false);
+            io().println();
             
-            // Format memory
-            String freeHeapStr = "";
-            size_t freeHeap = ESP.getFreeHeap();
-            if (freeHeap < 1024) {
-                freeHeapStr = String(freeHeap) + " B";
-            } else if (freeHeap < 1024 * 1024) {
-                freeHeapStr = String(freeHeap / 1024.0, 1) + " KB";
-            } else {
-                freeHeapStr = String(freeHeap / (1024.0 * 1024.0), 1) + " MB";
-            }
-            Serial.println("Free RAM: " + freeHeapStr);
+            io().print("Free RAM: ");
+            g_cli->printBytes(ESP.getFreeHeap());
+            io().println();
             
-            String totalHeapStr = "";
-            size_t totalHeap = ESP.getHeapSize();
-            if (totalHeap < 1024 * 1024) {
-                totalHeapStr = String(totalHeap / 1024) + " KB";
-            } else {
-                totalHeapStr = String(totalHeap / (1024 * 1024)) + " MB";
-            }
-            Serial.println("Total RAM: " + totalHeapStr);
+            io().print("Total RAM: ");
+            g_cli->printBytes(ESP.getHeapSize());
+            io().println();
             
-            String flashStr = String(ESP.getFlashChipSize() / (1024 * 1024)) + " MB";
-            Serial.println("Flash: " + flashStr);
+            io().print("Flash: ");
+            g_cli->printBytes(ESP.getFlashChipSize());
+            io().println();
             
-            String colorsStr = g_cli->getConfig().colorsEnabled ? "ENABLED" : "DISABLED";
-            Serial.println("Colors: " + colorsStr);
+            io().print("Colors: ");
+            io().println(g_cli->getConfig().colorsEnabled ? "ENABLED" : "DISABLED");
         }
     }
     
@@ -275,24 +294,24 @@ namespace CLIStandardCommands {
             CLIConfig config = g_cli->getConfig();
             config.colorsEnabled = false;
             g_cli->setConfig(config);
-            Serial.println("SUCCESS: ANSI colors disabled");
+            io().println("SUCCESS: ANSI colors disabled");
             
         } else if (action == "test") {
-            Serial.println("\nANSI COLOR TEST");
-            Serial.println("===============");
-            Serial.println();
-            Serial.println("Basic Colors:");
-            Serial.println("\033[31m■ Red\033[0m \033[32m■ Green\033[0m \033[33m■ Yellow\033[0m \033[34m■ Blue\033[0m \033[35m■ Magenta\033[0m \033[36m■ Cyan\033[0m");
-            Serial.println();
-            Serial.println("Icons and Symbols:");
-            Serial.println("\033[32m✓ Success\033[0m \033[31m✗ Error\033[0m \033[33m⚠ Warning\033[0m \033[36mℹ Info\033[0m");
-            Serial.println("→ ← ↑ ↓ • ★ ▲ ◆ ■ □ ▓ ░");
-            Serial.println();
-            Serial.println("Results:");
-            Serial.println("✓ If you see colored squares: type 'colors on'");
-            Serial.println("✗ If you see codes like [31m: ANSI not supported");
-            Serial.println("⚠ If mixed results: limited terminal support");
-            Serial.println();
+            io().println("\nANSI COLOR TEST");
+            io().println("===============");
+            io().println();
+            io().println("Basic Colors:");
+            io().println("\033[31m■ Red\033[0m \033[32m■ Green\033[0m \033[33m■ Yellow\033[0m \033[34m■ Blue\033[0m \033[35m■ Magenta\033[0m \033[36m■ Cyan\033[0m");
+            io().println();
+            io().println("Icons and Symbols:");
+            io().println("\033[32m✓ Success\033[0m \033[31m✗ Error\033[0m \033[33m⚠ Warning\033[0m \033[36mℹ Info\033[0m");
+            io().println("→ ← ↑ ↓ • ★ ▲ ◆ ■ □ ▓ ░");
+            io().println();
+            io().println("Results:");
+            io().println("✓ If you see colored squares: type 'colors on'");
+            io().println("✗ If you see codes like [31m: ANSI not supported");
+            io().println("⚠ If mixed results: limited terminal support");
+            io().println();
             
         } else {
             g_cli->printError("Invalid option. Use: on, off, or test");
@@ -316,28 +335,122 @@ namespace CLIStandardCommands {
         if (limit <= 0) limit = history.size();
         if (limit > (int)history.size()) limit = history.size();
         
-        Serial.println();
-        if (g_cli->getConfig().colorsEnabled) {
-            Serial.println("\033[97mCommand History:\033[0m");
-        } else {
-            Serial.println("Command History:");
+        CLITableFormat format = CLITable::formatFor(args);
+        if (format == CLITableFormat::TEXT) {
+            io().println();
         }
-        Serial.println("================");
         
         int start = max(0, (int)history.size() - limit);
-        for (int i = start; i < (int)history.size(); i++) {
-            if (g_cli->getConfig().colorsEnabled) {
-                Serial.println("\033[90m" + String(i + 1, DEC) + ".\033[0m " + history[i]);
-            } else {
-                Serial.println(String(i + 1) + ". " + history[i]);
+        {
+            CLITable table(io(), format);
+            table.column("#", 0, CLIAlign::RIGHT).column("Command");
+            for (int i = start; i < (int)history.size(); i++) {
+                table.cell(i + 1).cell(history[i]);
+                table.endRow();
             }
         }
+        if (format != CLITableFormat::TEXT) {
+            return;
+        }
         
-        Serial.println();
+        io().println();
         g_cli->printInfo("Showing last " + String(limit) + " of " + String(history.size()) + " commands");
         g_cli->printInfo("Use 'run <number>' to execute a command from history");
     }
     
+    void handleBaud(const CLIArgs& args) {
+#if ARDUINO_USB_CDC_ON_BOOT
+        g_cli->printWarning("Serial is USB CDC, the baud rate has no effect");
+#else
+        if (&g_cli->getStream() != &Serial) {
+            g_cli->printError("The CLI is not running on Serial");
+            return;
+        }
+        
+        unsigned long current = Serial.baudRate();
+        if (args.empty()) {
+            g_cli->println("Baud rate: " + String(current));
+            return;
+        }
+        
+        static const unsigned long validRates[] = {
+            9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1500000, 2000000
+        };
+        unsigned long rate = args.getPositional(0).toInt();
+        bool valid = false;
+        for (unsigned long r : validRates) {
+            if (r == rate) { valid = true; break; }
+        }
+        if (!valid) {
+            g_cli->printError("Unsupported baud rate: " + args.getPositional(0));
+            g_cli->printInfo("Use one of: 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1500000, 2000000");
+            return;
+        }
+        
+        int timeoutSeconds = args.getFlag("timeout", "10").toInt();
+        if (timeoutSeconds < 3) timeoutSeconds = 3;
+        if (timeoutSeconds > 60) timeoutSeconds = 60;
+        
+        g_cli->printInfo("Switching to " + String(rate) + " baud");
+        g_cli->printInfo("Reconnect at the new rate and press Enter within " + 
+                         String(timeoutSeconds) + " seconds, otherwise " + String(current) + " is restored");
+        Serial.flush(); // Let the notice leave at the old rate
+        Serial.updateBaudRate(rate);
+        
+        // Only Enter confirms: bytes received at a mismatched rate are mostly garbage
+        bool confirmed = false;
+        unsigned long start = millis();
+        while (millis() - start < (unsigned long)timeoutSeconds * 1000) {
+            if (Serial.available()) {
+                char c = Serial.read();
+                if (c == '\n' || c == '\r') {
+                    confirmed = true;
+                    break;
+                }
+            }
+            delay(10);
+        }
+        
+        if (confirmed) {
+            // Swallow the rest of a CR/LF pair so it does not produce an empty prompt
+            delay(10);
+            while (Serial.available() && (Serial.peek() == '\n' || Serial.peek() == '\r')) {
+                Serial.read();
+            }
+            g_cli->printSuccess("Baud rate is now " + String(rate));
+        } else {
+            Serial.flush();
+            Serial.updateBaudRate(current);
+            g_cli->printWarning("No confirmation received, restored " + String(current) + " baud");
+        }
+#endif
+    }
+    
+    void handleStats(const CLIArgs& args) {
+        if (args.getPositional(0).equalsIgnoreCase("reset")) {
+            g_cli->resetStats();
+            g_cli->printSuccess("Statistics reset");
+            return;
+        }
+        
+        const CLIStats& stats = g_cli->getStats();
+        const CLIConfig& config = g_cli->getConfig();
+        
+        io().println();
+        io().println("CLI STATISTICS");
+        io().println("==============");
+        io().println("Bytes received:    " + String(stats.bytesReceived));
+        io().println("Lines executed:    " + String(stats.linesExecuted));
+        io().println("Line overflows:    " + String(stats.overflows));
+        io().println("Dropped bytes:     " + String(stats.droppedBytes));
+        io().println("Rate limited:      " + String(stats.rateLimited) + " s");
+        io().println("Malformed escapes: " + String(stats.malformedEscapes));
+        io().println("Wakeups:           " + String(g_cli->getWakeups()));
+        io().println();
+        io().println("Max line length:   " + (config.maxLineLength ? String(config.maxLineLength) : String("unlimited")));
+        io().println("Input rate limit:  " + (config.inputRateLimit ? String(config.inputRateLimit) + " B/s" : String("unlimited")));
+    }
+    
 } // End namespace CLIStandardCommands
 
 // ========================================================================
@@ -29,6 +29,8 @@ namespace CLIStandardCommands {
     void registerStatusCommand(GenericCLI& cli);
     void registerColorsCommand(GenericCLI& cli);
     void registerHistoryCommand(GenericCLI& cli);
+    void registerBaudCommand(GenericCLI& cli);
+    void registerStatsCommand(GenericCLI& cli);
     
     // Convenience registration functions
     void registerAllStandardCommands(GenericCLI& cli);
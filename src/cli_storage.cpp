@@ -0,0 +1,123 @@
+#include "cli_storage.h"
+
+#if defined(ESP32)
+#include <Update.h>
+#endif
+
+// ========================================================================
+// FILESYSTEM STORAGE
+// ========================================================================
+
+CLIFileStorage::CLIFileStorage(fs::FS& filesystem, const String& dir, bool remote) :
+    fs(filesystem),
+    directory(dir),
+    remoteNames(remote),
+    writing(false) {
+    if (!directory.endsWith("/")) {
+        directory += "/";
+    }
+}
+
+String CLIFileStorage::resolve(const String& name, bool stripDirectories) const {
+    // Names sent by a remote peer must not escape the target directory
+    if (stripDirectories) {
+        return directory + name.substring(name.lastIndexOf('/') + 1);
+    }
+    return name.startsWith("/") ? name : directory + name;
+}
+
+bool CLIFileStorage::openWrite(const String& name, size_t size) {
+    path = resolve(name, remoteNames);
+    if (path.endsWith("/")) {
+        error = "Invalid file name";
+        return false;
+    }
+    int slash = path.lastIndexOf('/');
+    if (slash > 0 && !fs.exists(path.substring(0, slash))) {
+        error = "No such directory: " + path.substring(0, slash);
+        return false;
+    }
+    file = fs.open(path, "w");
+    if (!file) {
+        error = "Cannot create " + path;
+        return false;
+    }
+    writing = true;
+    return true;
+}
+
+size_t CLIFileStorage::write(const uint8_t* data, size_t length) {
+    size_t written = file.write(data, length);
+    if (written != length) {
+        error = "Write failed (filesystem full?)";
+    }
+    return written;
+}
+
+bool CLIFileStorage::openRead(const String& name, size_t& size) {
+    path = resolve(name, false);
+    file = fs.open(path, "r");
+    if (!file || file.isDirectory()) {
+        error = "Cannot open " + path;
+        return false;
+    }
+    writing = false;
+    size = file.size();
+    return true;
+}
+
+size_t CLIFileStorage::read(uint8_t* data, size_t length) {
+    return file.read(data, length);
+}
+
+bool CLIFileStorage::close(bool success) {
+    file.close();
+    if (writing && !success) {
+        fs.remove(path);
+    }
+    writing = false;
+    return true;
+}
+
+// ========================================================================
+// OTA PARTITION STORAGE
+// ========================================================================
+
+#if defined(ESP32)
+CLIUpdateStorage::CLIUpdateStorage() : active(false) {}
+
+bool CLIUpdateStorage::openWrite(const String& name, size_t size) {
+    if (!Update.begin(size > 0 ? size : UPDATE_SIZE_UNKNOWN)) {
+        error = Update.errorString();
+        return false;
+    }
+    active = true;
+    return true;
+}
+
+size_t CLIUpdateStorage::write(const uint8_t* data, size_t length) {
+    size_t written = Update.write(const_cast<uint8_t*>(data), length);
+    if (written != length) {
+        error = Update.errorString();
+    }
+    return written;
+}
+
+bool CLIUpdateStorage::close(bool success) {
+    if (!active) {
+        return false;
+    }
+    active = false;
+    
+    if (!success) {
+        Update.abort();
+        return false;
+    }
+    // Validates the image and marks the partition bootable
+    if (!Update.end(true)) {
+        error = Update.errorString();
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,78 @@
+#ifndef CLI_STORAGE_H
+#define CLI_STORAGE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+/**
+ * Transfer Storage
+ * 
+ * Destination or source of a file transfer (YMODEM, OTA). Protocols only
+ * see this interface, so the same code streams into a filesystem, into the
+ * inactive OTA partition, or into a file-backed stand-in on a host build.
+ */
+
+class CLITransferStorage {
+public:
+    virtual ~CLITransferStorage() {}
+    
+    // size is 0 when the sender did not announce it
+    virtual bool openWrite(const String& name, size_t size) = 0;
+    virtual size_t write(const uint8_t* data, size_t length) = 0;
+    
+    virtual bool openRead(const String& name, size_t& size) = 0;
+    virtual size_t read(uint8_t* data, size_t length) = 0;
+    
+    // success = false discards a partially written target
+    virtual bool close(bool success) = 0;
+    
+    virtual String lastError() const { return ""; }
+};
+
+// Files in a directory of any fs::FS (LittleFS, SPIFFS, SD).
+// With remoteNames, names to write come from the peer (YMODEM headers) and
+// only their last component is used, inside directory. Otherwise they are
+// paths given by the CLI user and are opened as given.
+class CLIFileStorage : public CLITransferStorage {
+public:
+    CLIFileStorage(fs::FS& filesystem, const String& directory = "/", bool remoteNames = true);
+    
+    bool openWrite(const String& name, size_t size) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    bool openRead(const String& name, size_t& size) override;
+    size_t read(uint8_t* data, size_t length) override;
+    bool close(bool success) override;
+    String lastError() const override { return error; }
+    
+private:
+    String resolve(const String& name, bool stripDirectories) const;
+    
+    fs::FS& fs;
+    String directory;
+    bool remoteNames;
+    fs::File file;
+    String path;
+    bool writing;
+    String error;
+};
+
+#if defined(ESP32)
+// The inactive OTA app partition, written through the Update library
+class CLIUpdateStorage : public CLITransferStorage {
+public:
+    CLIUpdateStorage();
+    
+    bool openWrite(const String& name, size_t size) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    bool openRead(const String& name, size_t& size) override { return false; }
+    size_t read(uint8_t* data, size_t length) override { return 0; }
+    bool close(bool success) override;
+    String lastError() const override { return error; }
+    
+private:
+    bool active;
+    String error;
+};
+#endif
+
+#endif // CLI_STORAGE_H
@@ -0,0 +1,693 @@
+#include "cli_timeseries.h"
+#include "cli_codec.h"
+#include "cli_widgets.h"
+#include <math.h>
+#include <memory>
+#include <new>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+// Samples summed in float before being added to the double total: keeps
+// the inner loop in single precision (hardware FPU) without the rounding
+// drift of a float accumulator over 100k samples
+static const size_t SUM_BLOCK = 256;
+
+CLITimeSeries* CLITimeSeries::firstSeries = nullptr;
+
+CLITimeSeries::CLITimeSeries(const char* seriesName, size_t seriesCapacity, uint8_t seriesChannels,
+                             bool psramPreferred)
+    : name(seriesName), capacity(seriesCapacity),
+      channels(seriesChannels == 0 ? 1 : seriesChannels > MAX_CHANNELS ? MAX_CHANNELS : seriesChannels),
+      preferPsram(psramPreferred), psram(false), timestamps(nullptr), start(0), count(0), next(nullptr) {
+    for (uint8_t channel = 0; channel < MAX_CHANNELS; channel++) {
+        data[channel] = nullptr;
+        channelNames[channel] = nullptr;
+        channelDecimals[channel] = 2;
+    }
+    
+    // Append to the registry, keeping construction order
+    CLITimeSeries** link = &firstSeries;
+    while (*link != nullptr) {
+        link = &(*link)->next;
+    }
+    *link = this;
+}
+
+CLITimeSeries::~CLITimeSeries() {
+    for (CLITimeSeries** link = &firstSeries; *link != nullptr; link = &(*link)->next) {
+        if (*link == this) {
+            *link = next;
+            break;
+        }
+    }
+    free(timestamps);
+}
+
+// ========================================================================
+// STORAGE
+// ========================================================================
+
+void* CLITimeSeries::allocate(size_t bytes) {
+#if defined(ESP32)
+    if (preferPsram) {
+        void* block = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (block != nullptr) {
+            psram = true;
+            return block;
+        }
+    }
+#endif
+    psram = false;
+    return malloc(bytes);
+}
+
+bool CLITimeSeries::begin() {
+    if (timestamps != nullptr) {
+        return true;
+    }
+    
+    // One block: timestamps, then one float array per channel
+    size_t bytesPerSample = sizeof(uint32_t) + channels * sizeof(float);
+    if (capacity == 0 || capacity > SIZE_MAX / bytesPerSample) {
+        return false;
+    }
+    
+    uint8_t* block = (uint8_t*)allocate(capacity * bytesPerSample);
+    if (block == nullptr) {
+        return false;
+    }
+    
+    timestamps = (uint32_t*)block;
+    float* column = (float*)(block + capacity * sizeof(uint32_t));
+    for (uint8_t channel = 0; channel < channels; channel++) {
+        data[channel] = column;
+        column += capacity;
+    }
+    clear();
+    return true;
+}
+
+size_t CLITimeSeries::memoryUsage() const {
+    return isReady() ? capacity * (sizeof(uint32_t) + channels * sizeof(float)) : 0;
+}
+
+void CLITimeSeries::setChannelName(uint8_t channel, const char* channelName, uint8_t decimals) {
+    if (channel < channels) {
+        channelNames[channel] = channelName;
+        channelDecimals[channel] = std::min(decimals, CLISeriesFrame::MAX_DECIMALS);
+    }
+}
+
+const char* CLITimeSeries::getChannelName(uint8_t channel) const {
+    return channel < channels ? channelNames[channel] : nullptr;
+}
+
+int CLITimeSeries::findChannel(const String& channelName) const {
+    for (uint8_t channel = 0; channel < channels; channel++) {
+        if (channelNames[channel] != nullptr && channelName.equalsIgnoreCase(channelNames[channel])) {
+            return channel;
+        }
+    }
+    
+    // Unnamed channels are addressed by number
+    if (channelName.length() > 0 && isdigit((unsigned char)channelName[0])) {
+        long channel = channelName.toInt();
+        if (channel >= 0 && channel < channels) {
+            return (int)channel;
+        }
+    }
+    return -1;
+}
+
+bool CLITimeSeries::add(uint32_t timestamp, const float* values) {
+    if (!isReady()) {
+        return false;
+    }
+    
+    size_t position;
+    if (count < capacity) {
+        position = physical(count);
+        count++;
+    } else {
+        position = start;
+        start = start + 1 == capacity ? 0 : start + 1;
+    }
+    
+    timestamps[position] = timestamp;
+    for (uint8_t channel = 0; channel < channels; channel++) {
+        data[channel][position] = values[channel];
+    }
+    return true;
+}
+
+void CLITimeSeries::clear() {
+    start = 0;
+    count = 0;
+}
+
+// ========================================================================
+// QUERIES
+// ========================================================================
+
+size_t CLITimeSeries::since(uint32_t windowMs) const {
+    if (count == 0) {
+        return 0;
+    }
+    
+    // Ages relative to the newest sample only decrease towards the end,
+    // and unsigned subtraction keeps them right across millis() wrap-around
+    uint32_t newest = timestampAt(count - 1);
+    size_t low = 0;
+    size_t high = count - 1;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if ((uint32_t)(newest - timestampAt(middle)) <= windowMs) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+template<typename Visit>
+void CLITimeSeries::forEachSpan(const float* column, size_t first, size_t length, Visit visit) const {
+    if (length == 0) {
+        return;
+    }
+    size_t begin = physical(first);
+    size_t head = std::min(length, capacity - begin);
+    visit(column + begin, head);
+    if (head < length) {
+        visit(column, length - head);
+    }
+}
+
+CLITimeSeries::Stats CLITimeSeries::stats(uint8_t channel, size_t first, size_t length) const {
+    Stats result = { 0, NAN, NAN, NAN };
+    if (channel >= channels || first >= count) {
+        return result;
+    }
+    length = std::min(length, count - first);
+    if (length == 0) {
+        return result;
+    }
+    
+    float minimum = INFINITY;
+    float maximum = -INFINITY;
+    double sum = 0;
+    forEachSpan(data[channel], first, length, [&](const float* values, size_t span) {
+        for (size_t offset = 0; offset < span; offset += SUM_BLOCK) {
+            size_t end = std::min(span, offset + SUM_BLOCK);
+            float partial = 0;
+            for (size_t i = offset; i < end; i++) {
+                float value = values[i];
+                minimum = value < minimum ? value : minimum;
+                maximum = value > maximum ? value : maximum;
+                partial += value;
+            }
+            sum += partial;
+        }
+    });
+    
+    result.count = length;
+    result.minimum = minimum;
+    result.maximum = maximum;
+    result.mean = (float)(sum / length);
+    return result;
+}
+
+float CLITimeSeries::percentile(uint8_t channel, size_t first, size_t length, float p) const {
+    Stats range = stats(channel, first, length);
+    if (range.count == 0) {
+        return NAN;
+    }
+    if (range.minimum == range.maximum) {
+        return range.minimum;
+    }
+    length = range.count;
+    
+    p = std::min(100.0f, std::max(0.0f, p));
+    size_t rank = (size_t)lroundf(p / 100.0f * (length - 1));
+    
+    // Pass 1: which of HISTOGRAM_BINS bins over [min, max] holds the rank
+    uint32_t histogram[HISTOGRAM_BINS];
+    memset(histogram, 0, sizeof(histogram));
+    float low = range.minimum;
+    float scale = HISTOGRAM_BINS / (range.maximum - range.minimum);
+    forEachSpan(data[channel], first, length, [&](const float* values, size_t span) {
+        for (size_t i = 0; i < span; i++) {
+            size_t bin = (size_t)((values[i] - low) * scale);
+            histogram[bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1]++;
+        }
+    });
+    
+    size_t target = 0;
+    size_t below = 0;
+    while (below + histogram[target] <= rank) {
+        below += histogram[target];
+        target++;
+    }
+    
+    // Pass 2: split that bin again, counting only its members
+    memset(histogram, 0, sizeof(histogram));
+    float subLow = low + target / scale;
+    float subScale = scale * HISTOGRAM_BINS;
+    forEachSpan(data[channel], first, length, [&](const float* values, size_t span) {
+        for (size_t i = 0; i < span; i++) {
+            size_t bin = (size_t)((values[i] - low) * scale);
+            if ((bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1) != target) continue;
+            float offset = (values[i] - subLow) * subScale;
+            size_t subBin = offset <= 0 ? 0 : (size_t)offset;
+            histogram[subBin < HISTOGRAM_BINS ? subBin : HISTOGRAM_BINS - 1]++;
+        }
+    });
+    
+    size_t subTarget = 0;
+    while (below + histogram[subTarget] <= rank) {
+        below += histogram[subTarget];
+        subTarget++;
+    }
+    
+    // Interpolate by the rank's position among the members of the sub-bin
+    float fraction = (rank - below + 0.5f) / histogram[subTarget];
+    float value = subLow + (subTarget + fraction) / subScale;
+    return std::min(range.maximum, std::max(range.minimum, value));
+}
+
+size_t CLITimeSeries::downsample(uint8_t channel, size_t first, size_t length,
+                                 size_t maxPoints, size_t* indices) const {
+    if (channel >= channels || first >= count || maxPoints == 0) {
+        return 0;
+    }
+    length = std::min(length, count - first);
+    
+    if (length <= maxPoints) {
+        for (size_t i = 0; i < length; i++) {
+            indices[i] = first + i;
+        }
+        return length;
+    }
+    if (maxPoints < 3) {
+        size_t written = 0;
+        if (maxPoints == 2) {
+            indices[written++] = first;
+        }
+        indices[written++] = first + length - 1;
+        return written;
+    }
+    
+    // Largest-Triangle-Three-Buckets: keep the first and last samples and
+    // from each bucket in between the one forming the largest triangle with
+    // the previously kept sample and the average of the next bucket
+    uint32_t origin = timestampAt(first);
+    auto x = [&](size_t index) { return (float)(uint32_t)(timestampAt(index) - origin); };
+    auto y = [&](size_t index) { return valueAt(channel, index); };
+    
+    size_t written = 0;
+    size_t previous = first;
+    indices[written++] = previous;
+    
+    float bucketSize = (float)(length - 2) / (maxPoints - 2);
+    for (size_t bucket = 0; bucket < maxPoints - 2; bucket++) {
+        size_t rangeStart = first + 1 + (size_t)(bucket * bucketSize);
+        size_t rangeEnd = first + 1 + (size_t)((bucket + 1) * bucketSize);
+        size_t nextStart = rangeEnd;
+        size_t nextEnd = std::min(first + 1 + (size_t)((bucket + 2) * bucketSize), first + length);
+        if (nextEnd <= nextStart) {
+            nextEnd = nextStart + 1;
+        }
+        
+        float averageX = 0;
+        float averageY = 0;
+        for (size_t i = nextStart; i < nextEnd; i++) {
+            averageX += x(i);
+            averageY += y(i);
+        }
+        averageX /= (nextEnd - nextStart);
+        averageY /= (nextEnd - nextStart);
+        
+        float previousX = x(previous);
+        float previousY = y(previous);
+        float largest = -1;
+        size_t chosen = rangeStart;
+        for (size_t i = rangeStart; i < rangeEnd; i++) {
+            float area = fabsf((previousX - averageX) * (y(i) - previousY) -
+                               (previousX - x(i)) * (averageY - previousY));
+            if (area > largest) {
+                largest = area;
+                chosen = i;
+            }
+        }
+        
+        indices[written++] = chosen;
+        previous = chosen;
+    }
+    
+    indices[written++] = first + length - 1;
+    return written;
+}
+
+// ========================================================================
+// BINARY EXPORT
+// ========================================================================
+
+static size_t writeFrame(Print& out, uint8_t type, const uint8_t* payload, size_t length) {
+    uint8_t header[CLIFrame::HEADER_SIZE];
+    uint16_t crc = CLIFrame::encode(header, type, payload, (uint8_t)length);
+    uint8_t trailer[CLIFrame::CRC_SIZE] = { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+    out.write(header, sizeof(header));
+    out.write(payload, length);
+    out.write(trailer, sizeof(trailer));
+    return sizeof(header) + length + sizeof(trailer);
+}
+
+// Fixed point with the channel's decimals; out of range values saturate
+static int32_t quantize(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled != scaled) return 0;
+    if (scaled >= 2147483520.0f) return INT32_MAX;
+    if (scaled <= -2147483520.0f) return INT32_MIN;
+    return (int32_t)lroundf(scaled);
+}
+
+size_t CLITimeSeries::exportBinary(Print& out, size_t first, size_t length) const {
+    if (!isReady() || first > count) {
+        return 0;
+    }
+    length = std::min(length, count - first);
+    
+    uint8_t payload[CLIFrame::MAX_PAYLOAD];
+    size_t used = 0;
+    size_t written = 0;
+    
+    payload[used++] = CLISeriesFrame::VERSION;
+    payload[used++] = channels;
+    CLIOtaFrame::putU32(payload + used, (uint32_t)length);
+    used += 4;
+    float scale[MAX_CHANNELS];
+    for (uint8_t channel = 0; channel < channels; channel++) {
+        const char* label = channelNames[channel] != nullptr ? channelNames[channel] : "";
+        size_t labelLength = std::min(strlen(label), CLISeriesFrame::MAX_NAME);
+        payload[used++] = channelDecimals[channel];
+        payload[used++] = (uint8_t)labelLength;
+        memcpy(payload + used, label, labelLength);
+        used += labelLength;
+        
+        scale[channel] = 1;
+        for (uint8_t d = 0; d < channelDecimals[channel]; d++) {
+            scale[channel] *= 10;
+        }
+    }
+    written += writeFrame(out, CLISeriesFrame::HEADER, payload, used);
+    
+    // Each DATA frame restarts from absolute values, then codes deltas
+    size_t index = first;
+    size_t end = first + length;
+    size_t sampleLimit = CLIFrame::MAX_PAYLOAD - CLISeriesFrame::maxSampleSize(channels);
+    while (index < end) {
+        uint8_t samples = 0;
+        uint32_t previousTime = 0;
+        uint32_t previous[MAX_CHANNELS] = {};
+        used = 1;
+        
+        while (index < end && samples < 255 && used <= sampleLimit) {
+            size_t position = physical(index);
+            uint32_t timestamp = timestamps[position];
+            used += CLIVarint::put(payload + used, timestamp - previousTime);
+            previousTime = timestamp;
+            
+            for (uint8_t channel = 0; channel < channels; channel++) {
+                uint32_t value = (uint32_t)quantize(data[channel][position], scale[channel]);
+                used += CLIVarint::put(payload + used, CLIVarint::zigzag((int32_t)(value - previous[channel])));
+                previous[channel] = value;
+            }
+            samples++;
+            index++;
+        }
+        
+        payload[0] = samples;
+        written += writeFrame(out, CLISeriesFrame::DATA, payload, used);
+    }
+    
+    CLIOtaFrame::putU32(payload, (uint32_t)length);
+    written += writeFrame(out, CLISeriesFrame::END, payload, 4);
+    return written;
+}
+
+// ========================================================================
+// COMMANDS
+// ========================================================================
+
+CLITimeSeries* CLITimeSeries::find(const String& seriesName) {
+    for (CLITimeSeries* series = firstSeries; series != nullptr; series = series->next) {
+        if (seriesName.equalsIgnoreCase(series->name)) {
+            return series;
+        }
+    }
+    return nullptr;
+}
+
+static String channelLabel(const CLITimeSeries& series, uint8_t channel) {
+    const char* label = series.getChannelName(channel);
+    return label != nullptr ? String(label) : "ch" + String(channel);
+}
+
+// Window selected by --window=ms or --last=n, default everything
+static size_t windowStart(const CLITimeSeries& series, const CLIArgs& args) {
+    if (args.hasFlag("window")) {
+        return series.since((uint32_t)args.getFlag("window").toInt());
+    }
+    if (args.hasFlag("last")) {
+        return series.last((size_t)std::max(0L, args.getFlag("last").toInt()));
+    }
+    return 0;
+}
+
+static void runBenchmark(GenericCLI& cli, size_t samples) {
+    Stream& io = cli.getStream();
+    
+    // Fall back to smaller sizes when the heap (no PSRAM) cannot hold it
+    std::unique_ptr<CLITimeSeries> series;
+    for (;;) {
+        series.reset(new CLITimeSeries("(bench)", samples, 1, true));
+        if (series->begin()) break;
+        if (samples <= 1000) {
+            cli.printError("Not enough memory for the benchmark");
+            return;
+        }
+        samples /= 2;
+    }
+    cli.printInfo("Benchmark: " + String((unsigned long)samples) + " samples, " +
+                  String((unsigned long)series->memoryUsage()) + " bytes in " +
+                  (series->inPsram() ? "PSRAM" : "internal RAM"));
+    
+    auto report = [&io, samples](const char* label, uint32_t elapsed) {
+        io.printf("  %-22s %8lu us  %8.1f ns/sample\r\n", label, (unsigned long)elapsed,
+                  elapsed * 1000.0f / samples);
+    };
+    
+    // Random walk from a fixed seed, so runs are comparable
+    uint32_t seed = 12345;
+    float value = 0;
+    uint32_t begin = micros();
+    for (size_t i = 0; i < samples; i++) {
+        seed = seed * 1664525 + 1013904223;
+        value += (float)((int32_t)(seed >> 16) - 32768) / 32768.0f;
+        series->add((uint32_t)i * 10, value);
+    }
+    report("add", micros() - begin);
+    
+    begin = micros();
+    CLITimeSeries::Stats result = series->stats(0, 0, samples);
+    report("stats", micros() - begin);
+    
+    begin = micros();
+    float p99 = series->percentile(0, 0, samples, 99);
+    report("percentile(99)", micros() - begin);
+    
+    const size_t points = 1000;
+    std::unique_ptr<size_t[]> indices(new size_t[points]);
+    begin = micros();
+    size_t written = series->downsample(0, 0, samples, points, indices.get());
+    report("downsample(1000)", micros() - begin);
+    
+    begin = micros();
+    size_t first = series->since(samples * 5);
+    report("since (binary search)", micros() - begin);
+    
+    io.printf("  mean %.3f  min %.3f  max %.3f  p99 %.3f  points %u  half at %u\r\n",
+              result.mean, result.minimum, result.maximum, p99, (unsigned)written, (unsigned)first);
+}
+
+void CLITimeSeries::registerCommands(GenericCLI& cli, const String& category) {
+    cli.registerCommand("ts", "Query time-series data",
+        "ts [stats|export|clear <series>] [--window=ms] [--last=n] [--points=n] [--channel=name] [--csv|--json|--binary] | ts bench [--samples=n]",
+        [&cli](const CLIArgs& args) {
+            Stream& io = cli.getStream();
+            String action = args.getPositional(0);
+            action.toLowerCase();
+            
+            if (action.isEmpty() || action == "list") {
+                if (firstSeries == nullptr) {
+                    cli.printInfo("No time series");
+                    return;
+                }
+                CLITable table(io, CLITable::formatFor(args));
+                table.column("Name").column("Samples", 0, CLIAlign::RIGHT).column("Capacity", 0, CLIAlign::RIGHT)
+                     .column("Ch", 0, CLIAlign::RIGHT).column("Bytes", 0, CLIAlign::RIGHT).column("Memory");
+                for (CLITimeSeries* series = firstSeries; series != nullptr; series = series->next) {
+                    table.cell(series->name).cell(series->count).cell(series->capacity)
+                         .cell(series->channels).cell(series->memoryUsage()).cell(series->psram ? "PSRAM" : "internal");
+                    table.endRow();
+                }
+                return;
+            }
+            
+            if (action == "bench") {
+                long samples = args.getFlag("samples", "100000").toInt();
+                runBenchmark(cli, (size_t)std::max(1000L, samples));
+                return;
+            }
+            
+            CLITimeSeries* series = find(args.getPositional(1));
+            if (series == nullptr) {
+                cli.printError(args.size() < 2 ? "Usage: ts " + action + " <series>"
+                                               : "Unknown series: " + args.getPositional(1));
+                return;
+            }
+            
+            if (action == "clear") {
+                series->clear();
+                cli.printSuccess(String(series->name) + " cleared");
+                return;
+            }
+            
+            size_t first = windowStart(*series, args);
+            size_t length = series->count - first;
+            if (length == 0) {
+                cli.printWarning("No samples in " + String(series->name));
+                return;
+            }
+            
+            if (action == "stats") {
+                uint32_t span = series->timestampAt(series->count - 1) - series->timestampAt(first);
+                CLITableFormat format = CLITable::formatFor(args);
+                if (format == CLITableFormat::TEXT) {
+                    cli.printInfo(String((unsigned long)length) + " samples over " +
+                                  String((unsigned long)span) + " ms");
+                }
+                
+                CLITable table(io, format);
+                table.column("Channel");
+                static const char* const titles[] = { "Min", "Max", "Mean", "P50", "P90", "P99" };
+                for (const char* title : titles) {
+                    table.column(title, 10, CLIAlign::RIGHT);
+                }
+                for (uint8_t channel = 0; channel < series->channels; channel++) {
+                    Stats result = series->stats(channel, first, length);
+                    table.cell(channelLabel(*series, channel))
+                         .cell(result.minimum, 3).cell(result.maximum, 3).cell(result.mean, 3)
+                         .cell(series->percentile(channel, first, length, 50), 3)
+                         .cell(series->percentile(channel, first, length, 90), 3)
+                         .cell(series->percentile(channel, first, length, 99), 3);
+                    table.endRow();
+                }
+                return;
+            }
+            
+            if (action == "export") {
+                // Binary exports every sample of the window, as recorded
+                if (args.hasFlag("binary")) {
+                    size_t bytes = series->exportBinary(io, first, length);
+                    io.print("\r\n");
+                    cli.printInfo(String((unsigned long)length) + " samples in " + 
+                                  String((unsigned long)bytes) + " bytes");
+                    return;
+                }
+                
+                int channel = 0;
+                if (args.hasFlag("channel")) {
+                    channel = series->findChannel(args.getFlag("channel"));
+                    if (channel < 0) {
+                        cli.printError("Unknown channel: " + args.getFlag("channel"));
+                        return;
+                    }
+                }
+                
+                // Rows are chosen by LTTB on one channel; all channels are
+                // printed with the decimals set for them
+                size_t points = (size_t)std::max(1L, args.getFlag("points", "200").toInt());
+                points = std::min(points, length);
+                std::unique_ptr<size_t[]> indices(new (std::nothrow) size_t[points]);
+                if (!indices) {
+                    cli.printError("Not enough memory for " + String((unsigned long)points) + " points");
+                    return;
+                }
+                size_t rows = series->downsample(channel, first, length, points, indices.get());
+                
+                bool json = args.hasFlag("json");
+                if (json) {
+                    // Names are escaped and nan/inf samples written as null,
+                    // which JSON has no numbers for
+                    io.print("{\"series\":");
+                    CLITable::printJsonString(io, series->name);
+                    io.print(",\"columns\":[\"timestamp\"");
+                    for (uint8_t c = 0; c < series->channels; c++) {
+                        io.print(',');
+                        CLITable::printJsonString(io, channelLabel(*series, c).c_str());
+                    }
+                    io.print("],\"rows\":[");
+                } else {
+                    io.print("timestamp");
+                    for (uint8_t c = 0; c < series->channels; c++) {
+                        io.printf(",%s", channelLabel(*series, c).c_str());
+                    }
+                    io.print("\r\n");
+                }
+                
+                for (size_t row = 0; row < rows; row++) {
+                    size_t index = indices[row];
+                    if (json) {
+                        io.print(row > 0 ? ",[" : "[");
+                    }
+                    cli.printNum(series->timestampAt(index));
+                    for (uint8_t c = 0; c < series->channels; c++) {
+                        io.print(',');
+                        float value = series->valueAt(c, index);
+                        if (json && !isfinite(value)) {
+                            io.print("null");
+                        } else {
+                            cli.printFixed(value, series->channelDecimals[c]);
+                        }
+                    }
+                    io.print(json ? "]" : "\r\n");
+                }
+                if (json) {
+                    io.print("]}\r\n");
+                }
+                return;
+            }
+            
+            cli.printError("Unknown action: " + action);
+            cli.printInfo("Available actions: list, stats, export, clear, bench");
+        }, category);
+    
+    cli.setCompleter("ts", [](size_t argIndex, const String& prefix, std::vector<String>& candidates) {
+        if (argIndex == 0) {
+            for (const char* action : { "list", "stats", "export", "clear", "bench" }) {
+                if (strncmp(action, prefix.c_str(), prefix.length()) == 0) {
+                    candidates.push_back(action);
+                }
+            }
+        } else if (argIndex == 1) {
+            for (CLITimeSeries* series = firstSeries; series != nullptr; series = series->getNext()) {
+                if (String(series->getName()).startsWith(prefix)) {
+                    candidates.push_back(series->getName());
+                }
+            }
+        }
+    });
+}
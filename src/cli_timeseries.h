@@ -0,0 +1,150 @@
+#ifndef CLI_TIMESERIES_H
+#define CLI_TIMESERIES_H
+
+#include "generic_cli.h"
+
+/**
+ * Time-Series Store
+ * 
+ * Fixed-capacity ring of timestamped samples with one or more float
+ * channels, for metrics that a device keeps a history of (sensor values,
+ * loop times, heap). Storage is struct-of-arrays: one timestamp array and
+ * one float array per channel, allocated once by begin() - from PSRAM when
+ * requested and present. A query over a channel therefore walks one or two
+ * contiguous float spans (the ring splits at most once), with loops simple
+ * enough for the compiler to unroll or vectorize.
+ * 
+ * Queries take a window of the most recent samples:
+ *   stats()        count, min, max and mean
+ *   percentile()   histogram based: two counting passes, no sorting and no
+ *                  copy, exact to 1/65536 of the value range
+ *   downsample()   Largest-Triangle-Three-Buckets - picks the samples that
+ *                  preserve the visual shape of a channel, for export
+ * 
+ * Every series constructed gets a name and is reachable from the `ts`
+ * command once registerCommands() has been called:
+ * 
+ *   ts                                      List series
+ *   ts stats <series> [--window=ms] [--last=n] [--csv|--json]
+ *   ts export <series> [--points=n] [--channel=name] [--window=ms] [--json|--binary]
+ *   ts clear <series>
+ *   ts bench [--samples=n]                  Time the queries on n samples
+ * 
+ * exportBinary() writes a window as checksummed frames with delta and
+ * varint coded samples (CLISeriesFrame in cli_codec.h), typically 2-3
+ * bytes per value against 6-10 as CSV text; tools/cli_ts_decode turns a
+ * capture back into CSV on the host.
+ * 
+ * Timestamps are millis() values and must not decrease; wrap-around of
+ * the 32-bit counter is handled.
+ * 
+ * Usage:
+ *   CLITimeSeries climate("climate", 1000, 2);
+ *   climate.setChannelName(0, "temperature");
+ *   climate.setChannelName(1, "humidity", 1);      // 1 decimal in exports
+ *   climate.begin();
+ *   CLITimeSeries::registerCommands(cli);
+ *   ...
+ *   float values[] = { temperature, humidity };
+ *   climate.add(millis(), values);
+ */
+
+class CLITimeSeries {
+public:
+    static const uint8_t MAX_CHANNELS = 8;
+    static const size_t HISTOGRAM_BINS = 256;
+    
+    struct Stats {
+        size_t count;
+        float minimum;
+        float maximum;
+        float mean;
+    };
+    
+    CLITimeSeries(const char* name, size_t capacity, uint8_t channels = 1, bool preferPsram = false);
+    ~CLITimeSeries();
+    
+    // Allocates the arrays; false if there is not enough memory
+    bool begin();
+    bool isReady() const { return timestamps != nullptr; }
+    bool inPsram() const { return psram; }
+    size_t memoryUsage() const;
+    
+    // decimals sets the resolution of text and binary exports
+    void setChannelName(uint8_t channel, const char* channelName, uint8_t decimals = 2);
+    const char* getChannelName(uint8_t channel) const;
+    int findChannel(const String& channelName) const;
+    
+    // Appends one sample, overwriting the oldest when full. values holds
+    // one entry per channel.
+    bool add(uint32_t timestamp, const float* values);
+    bool add(uint32_t timestamp, float value) { return add(timestamp, &value); }
+    void clear();
+    
+    const char* getName() const { return name; }
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    uint8_t getChannels() const { return channels; }
+    
+    // Sample access by age order: 0 is the oldest retained sample
+    uint32_t timestampAt(size_t index) const { return timestamps[physical(index)]; }
+    float valueAt(uint8_t channel, size_t index) const { return data[channel][physical(index)]; }
+    
+    // Windows are [first, first + length) in age order. last(n) is the
+    // newest n samples, since(ms) those no older than ms before the newest.
+    size_t last(size_t samples) const { return samples >= count ? 0 : count - samples; }
+    size_t since(uint32_t windowMs) const;
+    
+    Stats stats(uint8_t channel, size_t first, size_t length) const;
+    float percentile(uint8_t channel, size_t first, size_t length, float p) const;
+    
+    // Writes at most maxPoints sample indices (age order, ascending) and
+    // returns how many were written. A window that already fits returns
+    // every index; maxPoints below 3 keeps the last (and first) sample.
+    size_t downsample(uint8_t channel, size_t first, size_t length,
+                      size_t maxPoints, size_t* indices) const;
+    
+    // HEADER, DATA and END frames for the window; returns the bytes written
+    size_t exportBinary(Print& out, size_t first, size_t length) const;
+    
+    // Registered series, in construction order
+    static CLITimeSeries* find(const String& seriesName);
+    static CLITimeSeries* getFirst() { return firstSeries; }
+    CLITimeSeries* getNext() const { return next; }
+    
+    // The `ts` command for all series
+    static void registerCommands(GenericCLI& cli, const String& category = "Data");
+
+private:
+    CLITimeSeries(const CLITimeSeries&) = delete;
+    CLITimeSeries& operator=(const CLITimeSeries&) = delete;
+    
+    size_t physical(size_t index) const {
+        size_t position = start + index;
+        return position >= capacity ? position - capacity : position;
+    }
+    
+    // Calls visit(pointer, length) for the one or two contiguous spans of a window
+    template<typename Visit>
+    void forEachSpan(const float* column, size_t first, size_t length, Visit visit) const;
+    
+    void* allocate(size_t bytes);
+    
+    const char* name;
+    size_t capacity;
+    uint8_t channels;
+    bool preferPsram;
+    bool psram;
+    
+    uint32_t* timestamps;
+    float* data[MAX_CHANNELS];
+    const char* channelNames[MAX_CHANNELS];
+    uint8_t channelDecimals[MAX_CHANNELS];
+    size_t start;               // Physical index of the oldest sample
+    size_t count;
+    
+    CLITimeSeries* next;
+    static CLITimeSeries* firstSeries;
+};
+
+#endif // CLI_TIMESERIES_H
@@ -0,0 +1,171 @@
+#include "cli_transfer_commands.h"
+#include "cli_storage.h"
+#include "cli_ymodem.h"
+#include "cli_ota.h"
+
+namespace CLITransferCommands {
+    
+    // Swallow whatever the terminal program still sends after a transfer
+    // (trailing CANs, a repeated header) so it does not reach the line editor
+    static void drainInput(Stream& io) {
+        unsigned long last = millis();
+        while (millis() - last < 500) {
+            if (io.available()) {
+                io.read();
+                last = millis();
+            } else {
+                delay(1);
+            }
+        }
+    }
+    
+    static void reportResult(GenericCLI& cli, CLIYModem& modem, CLIYModem::Result result, 
+                             CLITransferStorage& storage) {
+        if (result == CLIYModem::Result::OK) {
+            cli.printSuccess("Transferred " + String((unsigned long)modem.getBytesTransferred()) + 
+                             " bytes in " + String((unsigned long)modem.getFileCount()) + " file(s)");
+            return;
+        }
+        
+        String message = String("Transfer failed: ") + CLIYModem::resultText(result);
+        if (result == CLIYModem::Result::STORAGE_ERROR && storage.lastError().length() > 0) {
+            message += " (" + storage.lastError() + ")";
+        }
+        cli.printError(message);
+    }
+    
+    static void handleReceive(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        Stream& io = cli.getStream();
+        bool streaming = args.hasFlag("stream");
+        
+#if defined(ESP32)
+        if (args.hasFlag("ota")) {
+            CLIUpdateStorage storage;
+            CLIYModem modem(io);
+            cli.printInfo("Waiting for firmware image (YMODEM" + String(streaming ? "-g" : "") + ")...");
+            CLIYModem::Result result = modem.receive(storage, streaming);
+            drainInput(io);
+            reportResult(cli, modem, result, storage);
+            if (result == CLIYModem::Result::OK) {
+                cli.printInfo("Update ready - reboot to apply");
+            }
+            return;
+        }
+#else
+        if (args.hasFlag("ota")) {
+            cli.printError("OTA updates are not supported on this platform");
+            return;
+        }
+#endif
+        
+        String dir = args.getFlag("dir", "/");
+        if (!dir.endsWith("/")) {
+            dir += "/";
+        }
+        
+        CLIFileStorage storage(filesystem, dir);
+        CLIYModem modem(io);
+        cli.printInfo("Waiting for files (YMODEM" + String(streaming ? "-g" : "") + ") into " + dir + "...");
+        CLIYModem::Result result = modem.receive(storage, streaming);
+        drainInput(io);
+        reportResult(cli, modem, result, storage);
+    }
+    
+    static void handleSend(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        if (args.empty()) {
+            cli.printError("Usage: sx <file>");
+            return;
+        }
+        
+        String path = args.getPositional(0);
+        if (!path.startsWith("/")) {
+            path = "/" + path;
+        }
+        if (!filesystem.exists(path)) {
+            cli.printError("File not found: " + path);
+            return;
+        }
+        
+        Stream& io = cli.getStream();
+        CLIFileStorage storage(filesystem);
+        CLIYModem modem(io);
+        cli.printInfo("Sending " + path + " (start YMODEM receive on the host)...");
+        CLIYModem::Result result = modem.send(storage, path);
+        drainInput(io);
+        reportResult(cli, modem, result, storage);
+    }
+    
+    static void handleOta(GenericCLI& cli, fs::FS& filesystem, const CLIArgs& args) {
+        Stream& io = cli.getStream();
+        long window = args.getFlag("window", "1").toInt();
+        if (window < 1 || window > 32) {
+            cli.printError("Window must be between 1 and 32 frames");
+            return;
+        }
+        CLIOtaReceiver receiver(io, (uint8_t)window);
+        
+        // --file writes the image to the filesystem instead of the app partition
+        String file = args.getFlag("file");
+        if (file.length() > 0) {
+            if (!file.startsWith("/")) {
+                file = "/" + file;
+            }
+            int slash = file.lastIndexOf('/');
+            if (slash > 0 && !filesystem.exists(file.substring(0, slash))) {
+                cli.printError("No such directory: " + file.substring(0, slash));
+                return;
+            }
+            
+            CLIFileStorage storage(filesystem, "/", false);
+            cli.printInfo("Waiting for image from cli_ota_send into " + file + "...");
+            CLIOtaReceiver::Result result = receiver.receive(storage, file);
+            drainInput(io);
+            if (result == CLIOtaReceiver::Result::OK) {
+                cli.printSuccess("Received " + String((unsigned long)receiver.getBytesReceived()) + " bytes, SHA-256 verified");
+            } else {
+                String message = String("Update failed: ") + CLIOtaReceiver::resultText(result);
+                if (storage.lastError().length() > 0) {
+                    message += " (" + storage.lastError() + ")";
+                }
+                cli.printError(message);
+            }
+            return;
+        }
+        
+#if defined(ESP32)
+        CLIUpdateStorage storage;
+        cli.printInfo("Waiting for firmware image from cli_ota_send...");
+        CLIOtaReceiver::Result result = receiver.receive(storage, "firmware");
+        drainInput(io);
+        if (result != CLIOtaReceiver::Result::OK) {
+            String message = String("Update failed: ") + CLIOtaReceiver::resultText(result);
+            if (storage.lastError().length() > 0) {
+                message += " (" + storage.lastError() + ")";
+            }
+            cli.printError(message);
+            return;
+        }
+        
+        cli.printSuccess("Firmware updated (" + String((unsigned long)receiver.getBytesReceived()) + " bytes, SHA-256 verified)");
+        if (args.hasFlag("reboot")) {
+            cli.printInfo("Rebooting...");
+            io.flush();
+            delay(100);
+            ESP.restart();
+        } else {
+            cli.printInfo("Reboot to run the new firmware");
+        }
+#else
+        cli.printError("No OTA partition on this platform - use --file=path");
+#endif
+    }
+    
+    void registerTransferCommands(GenericCLI& cli, fs::FS& filesystem) {
+        cli.registerCommand("rx", "Receive files via YMODEM", "rx [--dir=path] [--stream] [--ota]",
+            [&cli, &filesystem](const CLIArgs& args) { handleReceive(cli, filesystem, args); }, "Files");
+        cli.registerCommand("sx", "Send a file via YMODEM", "sx <file>",
+            [&cli, &filesystem](const CLIArgs& args) { handleSend(cli, filesystem, args); }, "Files");
+        cli.registerCommand("ota", "Receive a firmware update", "ota [--window=frames] [--reboot] [--file=path]",
+            [&cli, &filesystem](const CLIArgs& args) { handleOta(cli, filesystem, args); }, "System");
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef CLI_TRANSFER_COMMANDS_H
+#define CLI_TRANSFER_COMMANDS_H
+
+#include "generic_cli.h"
+#include <FS.h>
+
+/**
+ * File Transfer Commands
+ * 
+ * YMODEM receive and send over the CLI's own stream, so files move over
+ * the same serial port the terminal uses (e.g. `sz`/`rz` from lrzsz, or
+ * the transfer menu of Tera Term / ExtraPuTTY / minicom).
+ * 
+ *   rx [--dir=path] [--stream] [--ota]   Receive files (YMODEM / YMODEM-g)
+ *   sx <file>                            Send a file
+ *   ota [--window=N] [--reboot]          Firmware update from tools/cli_ota_send
+ * 
+ * With `rx --ota` (ESP32) the received image is written to the inactive app
+ * partition instead of the filesystem. `ota` uses its own framed protocol
+ * with a SHA-256 check of the whole image; `ota --file=path` writes the
+ * image to the filesystem instead, for boards without OTA partitions.
+ * 
+ * Usage:
+ *   LittleFS.begin(true);
+ *   CLITransferCommands::registerTransferCommands(cli, LittleFS);
+ */
+
+namespace CLITransferCommands {
+    void registerTransferCommands(GenericCLI& cli, fs::FS& filesystem);
+}
+
+#endif // CLI_TRANSFER_COMMANDS_H
@@ -0,0 +1,521 @@
+#include "cli_widgets.h"
+#include "cli_codec.h"
+
+// Characters (not bytes) in UTF-8 text: continuation bytes do not count
+static size_t displayWidth(const char* text, size_t length) {
+    size_t width = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (((uint8_t)text[i] & 0xC0) != 0x80) {
+            width++;
+        }
+    }
+    return width;
+}
+
+// Bytes of the first `width` characters
+static size_t prefixBytes(const char* text, size_t length, size_t width) {
+    size_t characters = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (((uint8_t)text[i] & 0xC0) != 0x80) {
+            if (characters == width) {
+                return i;
+            }
+            characters++;
+        }
+    }
+    return length;
+}
+
+// ========================================================================
+// TABLE
+// ========================================================================
+
+CLITable::CLITable(Print& output, CLITableFormat tableFormat) :
+    out(output),
+    format(tableFormat),
+    columnCount(0),
+    currentColumn(0),
+    lookahead(16),
+    rows(0),
+    started(false),
+    finished(false),
+    pending(nullptr),
+    pendingUsed(0),
+    pendingRows(0) {}
+
+CLITable::~CLITable() {
+    finish();
+    free(pending);
+}
+
+CLITableFormat CLITable::formatFor(const CLIArgs& args) {
+    if (args.hasFlag("json")) return CLITableFormat::JSON;
+    if (args.hasFlag("csv")) return CLITableFormat::CSV;
+    return CLITableFormat::TEXT;
+}
+
+CLITable& CLITable::column(const char* title, uint8_t width, CLIAlign align) {
+    if (columnCount < MAX_COLUMNS && !started && pendingUsed == 0) {
+        size_t titleWidth = displayWidth(title, strlen(title));
+        columns[columnCount++] = { title, (uint8_t)(width > 0 ? width : std::min<size_t>(titleWidth, MAX_AUTO_WIDTH)),
+                                   align, width == 0 };
+    }
+    return *this;
+}
+
+CLITable& CLITable::cell(const char* text) {
+    addCell(text, strlen(text), false);
+    return *this;
+}
+
+CLITable& CLITable::cell(long long value) {
+    char text[CLIFormat::NUMBER_SIZE];
+    addCell(text, CLIFormat::formatSigned(text, value) - text, true);
+    return *this;
+}
+
+CLITable& CLITable::cell(unsigned long long value) {
+    char text[CLIFormat::NUMBER_SIZE];
+    addCell(text, CLIFormat::formatUnsigned(text, value) - text, true);
+    return *this;
+}
+
+CLITable& CLITable::cell(float value, uint8_t decimals) {
+    char text[CLIFormat::NUMBER_SIZE];
+    char* end = CLIFormat::formatFixed(text, value, decimals);
+    // JSON has no nan/inf
+    bool numeric = value == value && value - value == 0;
+    addCell(text, end - text, numeric);
+    return *this;
+}
+
+void CLITable::addCell(const char* text, size_t length, bool numeric) {
+    if (finished || currentColumn >= columnCount) {
+        return;
+    }
+    
+    bool buffering = !started && format == CLITableFormat::TEXT && lookahead > 0;
+    if (buffering) {
+        if (pending == nullptr) {
+            pending = (char*)malloc(LOOKAHEAD_BYTES);
+        }
+        // No memory or no room: go with the widths seen so far
+        if (pending == nullptr || pendingUsed + length + 1 > LOOKAHEAD_BYTES) {
+            flushPending();
+        } else {
+            memcpy(pending + pendingUsed, text, length);
+            pending[pendingUsed + length] = '\0';
+            pendingUsed += length + 1;
+            
+            Column& column = columns[currentColumn];
+            if (column.autoWidth) {
+                size_t width = std::min<size_t>(displayWidth(text, length), MAX_AUTO_WIDTH);
+                column.width = std::max<size_t>(column.width, width);
+            }
+            currentColumn++;
+            return;
+        }
+    }
+    
+    if (!started) {
+        writeHeader();
+    }
+    writeCell(text, length, numeric);
+    currentColumn++;
+}
+
+void CLITable::endRow() {
+    if (finished || columnCount == 0) {
+        return;
+    }
+    while (currentColumn < columnCount) {
+        addCell("", 0, false);
+    }
+    
+    if (!started) {
+        pendingRows++;
+        currentColumn = 0;
+        if (pendingRows >= lookahead) {
+            flushPending();
+        }
+        return;
+    }
+    writeRowEnd();
+}
+
+void CLITable::finish() {
+    if (finished) {
+        return;
+    }
+    if (currentColumn > 0) {
+        endRow();
+    }
+    if (!started) {
+        flushPending();
+    }
+    if (format == CLITableFormat::JSON) {
+        out.print(rows > 0 ? "\r\n]\r\n" : "]\r\n");
+    }
+    finished = true;
+}
+
+// Header, then the held back rows; a partly added row continues to stream
+void CLITable::flushPending() {
+    // Before writeHeader(), which leaves currentColumn at 0
+    uint8_t savedColumn = currentColumn;
+    writeHeader();
+    
+    size_t position = 0;
+    currentColumn = 0;
+    while (position < pendingUsed) {
+        size_t length = strlen(pending + position);
+        writeCell(pending + position, length, false);
+        position += length + 1;
+        if (++currentColumn == columnCount) {
+            writeRowEnd();
+        }
+    }
+    currentColumn = savedColumn;
+    pendingUsed = 0;
+    pendingRows = 0;
+}
+
+void CLITable::writeHeader() {
+    if (started) {
+        return;
+    }
+    started = true;
+    
+    if (format == CLITableFormat::JSON) {
+        out.print('[');
+        return;
+    }
+    
+    for (uint8_t i = 0; i < columnCount; i++) {
+        currentColumn = i;
+        writeCell(columns[i].title, strlen(columns[i].title), false);
+    }
+    out.print("\r\n");
+    
+    if (format == CLITableFormat::TEXT) {
+        for (uint8_t i = 0; i < columnCount; i++) {
+            if (i > 0) writeSpaces(2);
+            for (uint8_t j = 0; j < columns[i].width; j++) {
+                out.print('-');
+            }
+        }
+        out.print("\r\n");
+    }
+    currentColumn = 0;
+}
+
+void CLITable::writeCell(const char* text, size_t length, bool numeric) {
+    const Column& column = columns[currentColumn];
+    bool first = currentColumn == 0;
+    bool last = currentColumn + 1 == columnCount;
+    
+    if (format == CLITableFormat::CSV) {
+        if (!first) out.print(',');
+        bool quote = false;
+        for (size_t i = 0; i < length && !quote; i++) {
+            quote = text[i] == ',' || text[i] == '"' || text[i] == '\r' || text[i] == '\n';
+        }
+        if (quote) {
+            writeEscaped(text, length, '"');
+        } else {
+            out.write((const uint8_t*)text, length);
+        }
+        return;
+    }
+    
+    if (format == CLITableFormat::JSON) {
+        out.print(first ? (rows > 0 ? ",\r\n{" : "\r\n{") : ",");
+        writeEscaped(column.title, strlen(column.title), '\\');
+        out.print(':');
+        if (numeric) {
+            out.write((const uint8_t*)text, length);
+        } else {
+            writeEscaped(text, length, '\\');
+        }
+        if (last) out.print('}');
+        return;
+    }
+    
+    // Cut to the column, marking the cut with '~'
+    size_t width = displayWidth(text, length);
+    bool cut = width > column.width;
+    if (cut) {
+        length = prefixBytes(text, length, column.width > 0 ? column.width - 1 : 0);
+        width = column.width;
+    }
+    
+    if (!first) writeSpaces(2);
+    size_t padding = column.width - width;
+    if (column.align == CLIAlign::RIGHT) {
+        writeSpaces(padding);
+    }
+    out.write((const uint8_t*)text, length);
+    if (cut && column.width > 0) {
+        out.print('~');
+    }
+    if (column.align == CLIAlign::LEFT && !last) {
+        writeSpaces(padding);
+    }
+}
+
+void CLITable::writeRowEnd() {
+    if (format != CLITableFormat::JSON) {
+        out.print("\r\n");
+    }
+    currentColumn = 0;
+    rows++;
+}
+
+// quote '"' doubles quotes (CSV), '\\' writes a JSON string
+void CLITable::writeEscaped(const char* text, size_t length, char quote) {
+    if (quote != '"') {
+        printJsonString(out, text, length);
+        return;
+    }
+    out.print('"');
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '"') out.print('"');
+        out.print(text[i]);
+    }
+    out.print('"');
+}
+
+void CLITable::printJsonString(Print& out, const char* text, size_t length) {
+    out.print('"');
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            out.print('\\');
+            out.print(c);
+        } else if ((uint8_t)c < 0x20) {
+            char escape[7] = { '\\', 'u', '0', '0' };
+            CLIHex::formatByte(escape + 4, (uint8_t)c);
+            out.write((const uint8_t*)escape, 6);
+        } else {
+            out.print(c);
+        }
+    }
+    out.print('"');
+}
+
+void CLITable::writeSpaces(size_t count) {
+    static const char spaces[] = "                ";
+    while (count > 0) {
+        size_t chunk = std::min(count, sizeof(spaces) - 1);
+        out.write((const uint8_t*)spaces, chunk);
+        count -= chunk;
+    }
+}
+
+// ========================================================================
+// STATUS LINE
+// ========================================================================
+
+CLIStatusLine::CLIStatusLine(Print& output, const char* lineLabel, bool redrawInPlace) :
+    out(output),
+    label(lineLabel != nullptr ? lineLabel : ""),
+    inPlace(redrawInPlace),
+    drawn(false),
+    finished(false),
+    interval(redrawInPlace ? REDRAW_INTERVAL_MS : LINE_INTERVAL_MS),
+    startMs(millis()),
+    lastDrawMs(0),
+    lineUsed(0),
+    lastLineUsed(0) {}
+
+// The first update always draws
+bool CLIStatusLine::due() {
+    uint32_t now = millis();
+    if (drawn && now - lastDrawMs < interval) {
+        return false;
+    }
+    drawn = true;
+    lastDrawMs = now;
+    return true;
+}
+
+void CLIStatusLine::startLine() {
+    lineUsed = 0;
+    append(label);
+}
+
+void CLIStatusLine::append(const char* text) {
+    append(text, strlen(text));
+}
+
+void CLIStatusLine::append(const char* text, size_t length) {
+    length = std::min(length, LINE_SIZE - lineUsed);
+    memcpy(line + lineUsed, text, length);
+    lineUsed += length;
+}
+
+// "m:ss", or "h:mm:ss" from an hour on
+void CLIStatusLine::appendDuration(uint32_t seconds) {
+    char text[CLIFormat::NUMBER_SIZE];
+    uint32_t hours = seconds / 3600;
+    uint32_t minutes = (seconds / 60) % 60;
+    if (hours > 0) {
+        append(text, CLIFormat::formatUnsigned(text, hours) - text);
+        append(minutes < 10 ? ":0" : ":");
+    }
+    append(text, CLIFormat::formatUnsigned(text, minutes) - text);
+    append(seconds % 60 < 10 ? ":0" : ":");
+    append(text, CLIFormat::formatUnsigned(text, seconds % 60) - text);
+}
+
+// The whole line goes out in one write so a redraw does not flicker
+void CLIStatusLine::writeLine(bool last) {
+    if (!inPlace) {
+        out.write((const uint8_t*)line, lineUsed);
+        out.print("\r\n");
+        return;
+    }
+    
+    out.print('\r');
+    out.write((const uint8_t*)line, lineUsed);
+    if (lastLineUsed > lineUsed) {
+        size_t extra = lastLineUsed - lineUsed;
+        for (size_t i = 0; i < extra; i++) out.print(' ');
+        for (size_t i = 0; i < extra && !last; i++) out.print('\b');
+    }
+    lastLineUsed = lineUsed;
+    if (last) {
+        out.print("\r\n");
+    }
+}
+
+// ========================================================================
+// PROGRESS
+// ========================================================================
+
+CLIProgress::CLIProgress(Print& output, uint32_t progressTotal, const char* progressLabel, bool redrawInPlace) :
+    CLIStatusLine(output, progressLabel, redrawInPlace),
+    total(progressTotal),
+    current(0),
+    unit(CLIProgressUnit::COUNT) {}
+
+void CLIProgress::update(uint32_t done) {
+    if (finished) {
+        return;
+    }
+    current = done;
+    if (due()) {
+        draw();
+        writeLine(false);
+    }
+}
+
+void CLIProgress::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    draw();
+    writeLine(true);
+}
+
+// label [#######-------]  45%  450/1000  12.5/s  ETA 0:05
+void CLIProgress::draw() {
+    char text[CLIFormat::NUMBER_SIZE];
+    uint32_t elapsedMs = elapsed();
+    startLine();
+    
+    if (total > 0) {
+        uint32_t shown = std::min(current, total);
+        uint8_t filled = (uint8_t)((uint64_t)shown * BAR_WIDTH / total);
+        append(lineUsed > 0 ? " [" : "[");
+        for (uint8_t i = 0; i < BAR_WIDTH; i++) {
+            append(i < filled ? "#" : "-");
+        }
+        append("] ");
+        
+        uint32_t percent = (uint32_t)((uint64_t)shown * 100 / total);
+        char* end = CLIFormat::formatUnsigned(text, percent);
+        for (size_t i = end - text; i < 3; i++) append(" ");
+        append(text, end - text);
+        append("%");
+    }
+    
+    if (unit != CLIProgressUnit::NONE) {
+        bool bytes = unit == CLIProgressUnit::BYTES;
+        append("  ");
+        append(text, (bytes ? CLIFormat::formatBytes(text, current) : CLIFormat::formatUnsigned(text, current)) - text);
+        if (total > 0) {
+            append("/");
+            append(text, (bytes ? CLIFormat::formatBytes(text, total) : CLIFormat::formatUnsigned(text, total)) - text);
+        }
+        
+        // Average since the start; the first half second says too little
+        if (elapsedMs >= 500) {
+            float rate = current * 1000.0f / elapsedMs;
+            append("  ");
+            append(text, (bytes ? CLIFormat::formatBytes(text, (uint64_t)rate) : CLIFormat::formatFixed(text, rate, 1)) - text);
+            append("/s");
+        }
+    }
+    
+    if (finished) {
+        append("  in ");
+        appendDuration(elapsedMs / 1000);
+    } else if (total > 0 && current > 0 && current < total && elapsedMs >= 500) {
+        uint64_t remainingMs = (uint64_t)elapsedMs * (total - current) / current;
+        append("  ETA ");
+        appendDuration((uint32_t)((remainingMs + 999) / 1000));
+    }
+}
+
+// ========================================================================
+// SPINNER
+// ========================================================================
+
+CLISpinner::CLISpinner(Print& output, const char* spinnerLabel, bool redrawInPlace) :
+    CLIStatusLine(output, spinnerLabel, redrawInPlace),
+    frame(0) {}
+
+void CLISpinner::tick(const char* status) {
+    if (finished || !due()) {
+        return;
+    }
+    draw(status, nullptr);
+    writeLine(false);
+}
+
+void CLISpinner::finish(const char* result) {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    draw(nullptr, result != nullptr ? result : "");
+    writeLine(true);
+}
+
+// label  /  0:03  status   -   label  result (0:03)
+void CLISpinner::draw(const char* status, const char* result) {
+    static const char frames[] = "|/-\\";
+    startLine();
+    if (result == nullptr) {
+        if (inPlace) {
+            append(lineUsed > 0 ? "  " : "");
+            append(frames + frame, 1);
+            frame = (frame + 1) % (sizeof(frames) - 1);
+        }
+        append(lineUsed > 0 ? "  " : "");
+        appendDuration(elapsed() / 1000);
+        if (status != nullptr && *status != '\0') {
+            append("  ");
+            append(status);
+        }
+        return;
+    }
+    
+    append(lineUsed > 0 ? "  " : "");
+    append(result);
+    append(" (");
+    appendDuration(elapsed() / 1000);
+    append(")");
+}
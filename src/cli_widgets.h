@@ -0,0 +1,212 @@
+#ifndef CLI_WIDGETS_H
+#define CLI_WIDGETS_H
+
+#include "generic_cli.h"
+
+/**
+ * Output Widgets
+ * 
+ * CLITable prints aligned columns, or the same rows as CSV or JSON, while
+ * the rows are produced. Cells are written straight to the output (numbers
+ * through CLIFormat), so no String is built per cell or per row.
+ * 
+ * Columns have a fixed width or are sized automatically: the first rows
+ * (look-ahead, 16 by default, at most LOOKAHEAD_BYTES of text) are held
+ * back until the widths are known, everything after that streams. Text
+ * longer than its column is cut to keep the rows aligned. Widths count
+ * UTF-8 characters, not bytes.
+ * 
+ * Usage:
+ *   CLITable table(cli.getStream(), CLITable::formatFor(args));   // --csv / --json
+ *   table.column("#", 3, CLIAlign::RIGHT).column("SSID").column("RSSI", 5, CLIAlign::RIGHT);
+ *   for (int i = 0; i < n; i++) {
+ *       table.cell(i + 1).cell(WiFi.SSID(i)).cell(WiFi.RSSI(i));
+ *       table.endRow();
+ *   }
+ *   table.finish();
+ * 
+ * CLIProgress and CLISpinner give feedback during long operations. They
+ * are meant to be called as often as convenient and draw at most every
+ * REDRAW_INTERVAL_MS, rewriting one line in place with '\r'. Terminals
+ * without ANSI support (inPlace false, usually colorsEnabled off) get a
+ * complete line per update instead, at most every LINE_INTERVAL_MS, so a
+ * log or a slow link is not flooded. Progress shows the rate and an ETA
+ * computed from the average rate since the start.
+ * 
+ *   CLIProgress progress(cli.getStream(), size, "Copying", cli.getConfig().colorsEnabled);
+ *   progress.setUnit(CLIProgressUnit::BYTES);
+ *   while (...) { ...; progress.advance(chunk); }
+ *   progress.finish();
+ */
+
+enum class CLIAlign : uint8_t {
+    LEFT,
+    RIGHT
+};
+
+enum class CLITableFormat : uint8_t {
+    TEXT,
+    CSV,
+    JSON            // Array of objects keyed by column title
+};
+
+class CLITable {
+public:
+    static const uint8_t MAX_COLUMNS = 12;
+    static const uint8_t MAX_AUTO_WIDTH = 40;
+    static const size_t LOOKAHEAD_BYTES = 1024;
+    
+    explicit CLITable(Print& out, CLITableFormat format = CLITableFormat::TEXT);
+    ~CLITable();
+    
+    // TEXT unless the command got --csv or --json
+    static CLITableFormat formatFor(const CLIArgs& args);
+    
+    // Declare columns before the first cell; width 0 sizes automatically.
+    // title must stay valid while the table is in use.
+    CLITable& column(const char* title, uint8_t width = 0, CLIAlign align = CLIAlign::LEFT);
+    void setLookahead(uint8_t rows) { lookahead = rows; }
+    
+    // Cells in column order; missing trailing cells are left empty
+    CLITable& cell(const char* text);
+    CLITable& cell(const String& text) { return cell(text.c_str()); }
+    CLITable& cell(long long value);
+    CLITable& cell(unsigned long long value);
+    CLITable& cell(int value) { return cell((long long)value); }
+    CLITable& cell(long value) { return cell((long long)value); }
+    CLITable& cell(unsigned int value) { return cell((unsigned long long)value); }
+    CLITable& cell(unsigned long value) { return cell((unsigned long long)value); }
+    CLITable& cell(float value, uint8_t decimals);
+    void endRow();
+    
+    // Writes held back rows and closes the JSON array; also run by the destructor
+    void finish();
+    size_t rowCount() const { return rows; }
+    
+    // text as a quoted JSON string, quotes, backslashes and control
+    // characters escaped; for JSON written outside a table
+    static void printJsonString(Print& out, const char* text, size_t length);
+    static void printJsonString(Print& out, const char* text) { printJsonString(out, text, strlen(text)); }
+
+private:
+    CLITable(const CLITable&) = delete;
+    CLITable& operator=(const CLITable&) = delete;
+    
+    struct Column {
+        const char* title;
+        uint8_t width;
+        CLIAlign align;
+        bool autoWidth;
+    };
+    
+    void addCell(const char* text, size_t length, bool numeric);
+    void writeCell(const char* text, size_t length, bool numeric);
+    void writeRowEnd();
+    void writeHeader();
+    void flushPending();
+    void writeEscaped(const char* text, size_t length, char quote);
+    void writeSpaces(size_t count);
+    
+    Print& out;
+    CLITableFormat format;
+    Column columns[MAX_COLUMNS];
+    uint8_t columnCount;
+    uint8_t currentColumn;
+    uint8_t lookahead;
+    size_t rows;
+    bool started;                   // Header written, widths final
+    bool finished;
+    
+    // Look-ahead rows as NUL terminated cells (TEXT mode only)
+    char* pending;
+    size_t pendingUsed;
+    uint8_t pendingRows;
+};
+
+enum class CLIProgressUnit : uint8_t {
+    COUNT,          // 450/1000  12.5/s
+    BYTES,          // 1.5 KB/10.0 KB  2.0 KB/s
+    NONE            // Percentage and time only
+};
+
+// Rate limited status line shared by CLIProgress and CLISpinner
+class CLIStatusLine {
+public:
+    static const uint16_t REDRAW_INTERVAL_MS = 250;
+    static const uint16_t LINE_INTERVAL_MS = 2000;
+    static const size_t LINE_SIZE = 128;
+    
+    // Minimum time between two draws; 0 draws on every update
+    void setInterval(uint16_t ms) { interval = ms; }
+    uint32_t elapsed() const { return millis() - startMs; }
+    bool isFinished() const { return finished; }
+
+protected:
+    CLIStatusLine(Print& out, const char* label, bool inPlace);
+    CLIStatusLine(const CLIStatusLine&) = delete;
+    CLIStatusLine& operator=(const CLIStatusLine&) = delete;
+    
+    bool due();
+    void startLine();
+    void append(const char* text);
+    void append(const char* text, size_t length);
+    void appendDuration(uint32_t seconds);
+    void writeLine(bool last);
+    
+    Print& out;
+    const char* label;
+    bool inPlace;
+    bool drawn;
+    bool finished;
+    uint16_t interval;
+    uint32_t startMs;
+    uint32_t lastDrawMs;
+    
+    char line[LINE_SIZE];
+    size_t lineUsed;
+    size_t lastLineUsed;        // To blank the rest of a shorter redraw
+};
+
+class CLIProgress : public CLIStatusLine {
+public:
+    static const uint8_t BAR_WIDTH = 20;
+    
+    // total 0 means unknown: no bar, percentage or ETA
+    CLIProgress(Print& out, uint32_t total, const char* label = "", bool inPlace = true);
+    ~CLIProgress() { finish(); }
+    
+    void setUnit(CLIProgressUnit progressUnit) { unit = progressUnit; }
+    void setTotal(uint32_t progressTotal) { total = progressTotal; }
+    
+    void update(uint32_t done);
+    void advance(uint32_t delta = 1) { update(current + delta); }
+    
+    // Draws the final state and ends the line
+    void finish();
+
+private:
+    void draw();
+    
+    uint32_t total;
+    uint32_t current;
+    CLIProgressUnit unit;
+};
+
+class CLISpinner : public CLIStatusLine {
+public:
+    CLISpinner(Print& out, const char* label = "", bool inPlace = true);
+    ~CLISpinner() { finish(); }
+    
+    // status, if given, is shown after the elapsed time
+    void tick(const char* status = nullptr);
+    
+    // Replaces the spinner by the result and ends the line
+    void finish(const char* result = "done");
+
+private:
+    void draw(const char* status, const char* result);
+    
+    uint8_t frame;
+};
+
+#endif // CLI_WIDGETS_H
@@ -0,0 +1,347 @@
+#include "cli_ymodem.h"
+#include "cli_codec.h"
+
+// Protocol bytes
+static const uint8_t SOH = 0x01;    // 128 byte block
+static const uint8_t STX = 0x02;    // 1024 byte block
+static const uint8_t EOT = 0x04;
+static const uint8_t ACK = 0x06;
+static const uint8_t NAK = 0x15;
+static const uint8_t CAN = 0x18;
+static const uint8_t CPMEOF = 0x1A; // Padding of the last block
+
+static const int MAX_RETRIES = 10;
+static const uint32_t BYTE_TIMEOUT_MS = 1000;
+static const uint32_t PACKET_TIMEOUT_MS = 3000;
+static const uint32_t START_TIMEOUT_MS = 60000;
+
+CLIYModem::CLIYModem(Stream& stream) :
+    link(stream),
+    bytesTransferred(0),
+    fileCount(0) {}
+
+const char* CLIYModem::resultText(Result result) {
+    switch (result) {
+        case Result::OK: return "OK";
+        case Result::CANCELLED: return "Cancelled by peer";
+        case Result::TIMEOUT: return "Timeout";
+        case Result::STORAGE_ERROR: return "Storage error";
+        case Result::PROTOCOL_ERROR: return "Protocol error";
+    }
+    return "Unknown";
+}
+
+// ========================================================================
+// LOW LEVEL I/O
+// ========================================================================
+
+int CLIYModem::readByte(uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (!link.available()) {
+        if (millis() - start >= timeoutMs) {
+            return -1;
+        }
+        delay(1);
+    }
+    return link.read();
+}
+
+size_t CLIYModem::readBytes(uint8_t* data, size_t length, uint32_t timeoutMs) {
+    size_t received = 0;
+    unsigned long last = millis();
+    while (received < length) {
+        int available = link.available();
+        if (available > 0) {
+            received += link.readBytes(data + received, std::min<size_t>(available, length - received));
+            last = millis();
+        } else if (millis() - last >= timeoutMs) {
+            break;
+        } else {
+            delay(1);
+        }
+    }
+    return received;
+}
+
+void CLIYModem::purge() {
+    // Wait for the line to go quiet so a NAK lands between packets
+    while (readByte(100) >= 0) {}
+}
+
+void CLIYModem::cancel() {
+    const uint8_t sequence[] = { CAN, CAN, CAN, CAN, CAN };
+    link.write(sequence, sizeof(sequence));
+    link.flush();
+}
+
+// ========================================================================
+// RECEIVE
+// ========================================================================
+
+CLIYModem::Packet CLIYModem::receivePacket(uint8_t* data, size_t& length, 
+                                           uint8_t& sequence, uint32_t timeoutMs) {
+    int c = readByte(timeoutMs);
+    switch (c) {
+        case -1: return Packet::TIMEOUT;
+        case SOH: length = 128; break;
+        case STX: length = 1024; break;
+        case EOT: return Packet::END;
+        case CAN: return (readByte(BYTE_TIMEOUT_MS) == CAN) ? Packet::CANCEL : Packet::ERROR;
+        default: return Packet::ERROR;
+    }
+    
+    uint8_t header[2];
+    if (readBytes(header, 2, BYTE_TIMEOUT_MS) != 2 || (uint8_t)(header[0] ^ header[1]) != 0xFF) {
+        return Packet::ERROR;
+    }
+    sequence = header[0];
+    
+    uint8_t trailer[2];
+    if (readBytes(data, length, BYTE_TIMEOUT_MS) != length ||
+        readBytes(trailer, 2, BYTE_TIMEOUT_MS) != 2) {
+        return Packet::ERROR;
+    }
+    uint16_t crc = ((uint16_t)trailer[0] << 8) | trailer[1];
+    return (CLICodec::crc16(data, length, 0) == crc) ? Packet::DATA : Packet::ERROR;
+}
+
+CLIYModem::Result CLIYModem::receive(CLITransferStorage& storage, bool streaming) {
+    const uint8_t startChar = streaming ? 'G' : 'C';
+    uint8_t data[1024];
+    size_t length = 0;
+    uint8_t sequence = 0;
+    
+    bytesTransferred = 0;
+    fileCount = 0;
+    
+    // Batch: a header block (sequence 0) starts each file, an empty one ends the batch
+    while (true) {
+        bool fileOpen = false;
+        bool eotSeen = false;
+        uint8_t expected = 0;
+        size_t remaining = 0;
+        bool sizeKnown = false;
+        int errors = 0;
+        unsigned long waitStart = millis();
+        
+        link.write(startChar);
+        
+        while (true) {
+            Packet packet = receivePacket(data, length, sequence, PACKET_TIMEOUT_MS);
+            
+            if (packet == Packet::CANCEL) {
+                if (fileOpen) storage.close(false);
+                return Result::CANCELLED;
+            }
+            
+            if (packet == Packet::TIMEOUT || packet == Packet::ERROR) {
+                // Waiting for the sender to start is allowed to take a while
+                bool starting = !fileOpen && fileCount == 0;
+                if (streaming && fileOpen) {
+                    // YMODEM-g has no retransmission
+                    cancel();
+                    storage.close(false);
+                    return Result::PROTOCOL_ERROR;
+                }
+                if ((starting && millis() - waitStart > START_TIMEOUT_MS) ||
+                    (!starting && ++errors > MAX_RETRIES)) {
+                    cancel();
+                    if (fileOpen) storage.close(false);
+                    return (packet == Packet::TIMEOUT) ? Result::TIMEOUT : Result::PROTOCOL_ERROR;
+                }
+                purge();
+                link.write(fileOpen ? NAK : startChar);
+                continue;
+            }
+            
+            if (packet == Packet::END) {
+                if (!fileOpen) {
+                    link.write(ACK);
+                    continue;
+                }
+                // NAK the first EOT to rule out a corrupted byte, ACK the repeat
+                if (!eotSeen && !streaming) {
+                    eotSeen = true;
+                    link.write(NAK);
+                    continue;
+                }
+                link.write(ACK);
+                if (!storage.close(true)) {
+                    return Result::STORAGE_ERROR;
+                }
+                fileCount++;
+                break;
+            }
+            
+            errors = 0;
+            
+            if (!fileOpen) {
+                if (sequence != 0) {
+                    // Stray data block before the header, ask again
+                    link.write(NAK);
+                    continue;
+                }
+                if (data[0] == 0) {
+                    // Empty header block: end of batch
+                    link.write(ACK);
+                    return Result::OK;
+                }
+                
+                // Header: file name, NUL, decimal size, optional fields
+                data[length - 1] = 0;
+                fileName = String((const char*)data);
+                const char* sizeField = (const char*)data + strlen((const char*)data) + 1;
+                remaining = strtoul(sizeField, nullptr, 10);
+                sizeKnown = remaining > 0;
+                
+                if (!storage.openWrite(fileName, remaining)) {
+                    cancel();
+                    return Result::STORAGE_ERROR;
+                }
+                fileOpen = true;
+                expected = 1;
+                link.write(ACK);
+                link.write(startChar);
+                continue;
+            }
+            
+            if (sequence == (uint8_t)(expected - 1)) {
+                // Our ACK got lost, the sender repeated the block
+                if (!streaming) link.write(ACK);
+                continue;
+            }
+            if (sequence != expected) {
+                cancel();
+                storage.close(false);
+                return Result::PROTOCOL_ERROR;
+            }
+            
+            // The announced size tells which part of the last block is padding
+            size_t useful = sizeKnown ? std::min(length, remaining) : length;
+            if (useful > 0 && storage.write(data, useful) != useful) {
+                cancel();
+                storage.close(false);
+                return Result::STORAGE_ERROR;
+            }
+            remaining -= sizeKnown ? useful : 0;
+            bytesTransferred += useful;
+            expected++;
+            if (!streaming) link.write(ACK);
+        }
+    }
+}
+
+// ========================================================================
+// SEND
+// ========================================================================
+
+bool CLIYModem::sendPacket(uint8_t sequence, const uint8_t* data, size_t length, bool waitForAck) {
+    uint8_t header[3] = { (uint8_t)(length == 1024 ? STX : SOH), sequence, (uint8_t)~sequence };
+    uint16_t crc = CLICodec::crc16(data, length, 0);
+    uint8_t trailer[2] = { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+    
+    for (int attempt = 0; attempt < MAX_RETRIES; attempt++) {
+        link.write(header, sizeof(header));
+        link.write(data, length);
+        link.write(trailer, sizeof(trailer));
+        if (!waitForAck) {
+            return true;
+        }
+        
+        int c = readByte(PACKET_TIMEOUT_MS * 3);
+        if (c == ACK) return true;
+        if (c == CAN && readByte(BYTE_TIMEOUT_MS) == CAN) return false;
+        // NAK, garbage or timeout: send again
+    }
+    return false;
+}
+
+CLIYModem::Result CLIYModem::send(CLITransferStorage& storage, const String& name) {
+    uint8_t data[1024];
+    size_t size = 0;
+    
+    bytesTransferred = 0;
+    fileCount = 0;
+    fileName = name.substring(name.lastIndexOf('/') + 1);
+    
+    if (!storage.openRead(name, size)) {
+        return Result::STORAGE_ERROR;
+    }
+    
+    // Wait for the receiver to ask for CRC mode ('C') or streaming ('G')
+    int c;
+    unsigned long start = millis();
+    do {
+        c = readByte(1000);
+        if (c == CAN && readByte(BYTE_TIMEOUT_MS) == CAN) {
+            storage.close(true);
+            return Result::CANCELLED;
+        }
+        if (millis() - start > START_TIMEOUT_MS) {
+            storage.close(true);
+            return Result::TIMEOUT;
+        }
+    } while (c != 'C' && c != 'G');
+    bool streaming = (c == 'G');
+    
+    // Header block: name and size
+    memset(data, 0, 128);
+    String sizeText = String((unsigned long)size);
+    size_t nameLength = std::min<size_t>(fileName.length(), 128 - sizeText.length() - 2);
+    memcpy(data, fileName.c_str(), nameLength);
+    memcpy(data + nameLength + 1, sizeText.c_str(), sizeText.length());
+    if (!sendPacket(0, data, 128, true)) {
+        storage.close(true);
+        return Result::CANCELLED;
+    }
+    
+    // The receiver asks again before the first data block
+    c = readByte(PACKET_TIMEOUT_MS * 3);
+    if (c != 'C' && c != 'G') {
+        cancel();
+        storage.close(true);
+        return Result::PROTOCOL_ERROR;
+    }
+    
+    uint8_t sequence = 1;
+    size_t remaining = size;
+    while (remaining > 0) {
+        size_t blockSize = (remaining > 128) ? 1024 : 128;
+        size_t chunk = std::min(remaining, blockSize);
+        if (storage.read(data, chunk) != chunk) {
+            cancel();
+            storage.close(true);
+            return Result::STORAGE_ERROR;
+        }
+        memset(data + chunk, CPMEOF, blockSize - chunk);
+        
+        if (!sendPacket(sequence, data, blockSize, !streaming)) {
+            cancel();
+            storage.close(true);
+            return Result::CANCELLED;
+        }
+        sequence++;
+        remaining -= chunk;
+        bytesTransferred += chunk;
+    }
+    storage.close(true);
+    
+    // End of file: repeat EOT until acknowledged
+    bool acknowledged = false;
+    for (int attempt = 0; attempt < MAX_RETRIES && !acknowledged; attempt++) {
+        link.write(EOT);
+        acknowledged = (readByte(PACKET_TIMEOUT_MS) == ACK);
+    }
+    if (!acknowledged) {
+        return Result::TIMEOUT;
+    }
+    fileCount = 1;
+    
+    // End of batch: empty header block
+    c = readByte(PACKET_TIMEOUT_MS);
+    if (c == 'C' || c == 'G') {
+        memset(data, 0, 128);
+        sendPacket(0, data, 128, !streaming);
+    }
+    return Result::OK;
+}
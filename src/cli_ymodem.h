@@ -0,0 +1,59 @@
+#ifndef CLI_YMODEM_H
+#define CLI_YMODEM_H
+
+#include <Arduino.h>
+#include "cli_storage.h"
+
+/**
+ * YMODEM File Transfer
+ * 
+ * Batch YMODEM with CRC16 and 1K blocks over any Stream, reading from or
+ * writing to a CLITransferStorage as blocks arrive (no whole-file buffer).
+ * Receiving also supports YMODEM-g, the streaming variant without
+ * per-block acknowledgements, for links that are known to be reliable.
+ * 
+ * Both directions block until the transfer ends; the caller owns the
+ * stream for that time (e.g. a command handler running inside update()).
+ */
+
+class CLIYModem {
+public:
+    enum class Result {
+        OK,
+        CANCELLED,
+        TIMEOUT,
+        STORAGE_ERROR,
+        PROTOCOL_ERROR
+    };
+    
+    explicit CLIYModem(Stream& link);
+    
+    // Receive a batch of files; every file is written through storage
+    Result receive(CLITransferStorage& storage, bool streaming = false);
+    
+    // Send one file read from storage
+    Result send(CLITransferStorage& storage, const String& name);
+    
+    size_t getBytesTransferred() const { return bytesTransferred; }
+    size_t getFileCount() const { return fileCount; }
+    const String& getFileName() const { return fileName; }
+    
+    static const char* resultText(Result result);
+    
+private:
+    enum class Packet { DATA, END, CANCEL, TIMEOUT, ERROR };
+    
+    Packet receivePacket(uint8_t* data, size_t& length, uint8_t& sequence, uint32_t timeoutMs);
+    bool sendPacket(uint8_t sequence, const uint8_t* data, size_t length, bool waitForAck);
+    int readByte(uint32_t timeoutMs);
+    size_t readBytes(uint8_t* data, size_t length, uint32_t timeoutMs);
+    void purge();
+    void cancel();
+    
+    Stream& link;
+    size_t bytesTransferred;
+    size_t fileCount;
+    String fileName;
+};
+
+#endif // CLI_YMODEM_H
@@ -1,12 +1,59 @@
 #include "generic_cli.h"
+#include "cli_codec.h"
 #include <algorithm>
 
+// Shared string table
+namespace CLIStrings {
+    static std::vector<String>& table() {
+        static std::vector<String> strings(1, String("General"));
+        return strings;
+    }
+    
+    uint16_t intern(const String& text) {
+        std::vector<String>& strings = table();
+        for (size_t i = 0; i < strings.size(); i++) {
+            if (strings[i].equals(text)) {
+                return i;
+            }
+        }
+        strings.push_back(text);
+        return strings.size() - 1;
+    }
+    
+    const String& lookup(uint16_t id) {
+        const std::vector<String>& strings = table();
+        return (id < strings.size()) ? strings[id] : strings[GENERAL];
+    }
+    
+    size_t count() {
+        return table().size();
+    }
+}
+
 // Constructor
 GenericCLI::GenericCLI() : 
+    io(&Serial),
+    activeMode(CLI_GLOBAL_MODE),
     historyIndex(-1), 
     inHistoryMode(false),
     cursorPos(0),
-    isRunning(false) {
+    isRunning(false),
+    hostConnected(false),
+    executing(false),
+    escapeState(EscapeState::NONE),
+    escapeLength(0),
+    lastWasCR(false),
+    discardingInput(false),
+    rateWindowStart(0),
+    rateWindowBytes(0),
+    wakeups(0)
+#if defined(ESP32)
+    , eventTask(nullptr),
+    taskPollInterval(0)
+#endif
+    {
+    
+    modes.push_back({ "", "", CLI_GLOBAL_MODE });
     
     // Register built-in commands
     registerCommand("help", "Show available commands", "help [command]", 
@@ -20,6 +67,9 @@ GenericCLI::GenericCLI() :
     
     registerCommand("exit", "Exit CLI", "exit",
         [this](const CLIArgs& args) { handleExitCommand(args); }, "Built-in");
+    
+    registerCommand("apropos", "Search commands by keyword", "apropos <keyword...>",
+        [this](const CLIArgs& args) { handleAproposCommand(args); }, "Built-in");
 }
 
 GenericCLI::GenericCLI(const CLIConfig& cfg) : GenericCLI() {
@@ -33,6 +83,7 @@ GenericCLI::~GenericCLI() {
 // Configuration methods
 void GenericCLI::setConfig(const CLIConfig& cfg) {
     config = cfg;
+    io = (config.stream != nullptr) ? config.stream : &Serial;
     
     // Adjust history size if needed
     while (commandHistory.size() > config.historySize) {
@@ -56,6 +107,10 @@ void GenericCLI::setEchoEnabled(bool enabled) {
     config.echoEnabled = enabled;
 }
 
+void GenericCLI::setRole(uint8_t role) {
+    config.role = role;
+}
+
 void GenericCLI::setHistorySize(size_t size) {
     config.historySize = size;
     while (commandHistory.size() > config.historySize) {
@@ -66,30 +121,34 @@ void GenericCLI::setHistorySize(size_t size) {
 // Command registration
 bool GenericCLI::registerCommand(const String& name, const String& description, 
                                 const String& usage, CommandCallback callback, 
-                                const String& category) {
-    // Check if command already exists
-    if (findCommand(name) != nullptr) {
-        Serial.printf("[%s] Warning: Command '%s' already exists, overwriting\n", 
-                     config.logTag.c_str(), name.c_str());
-        unregisterCommand(name);
-    }
-    
-    CLICommand cmd(name, description, usage, callback, false, category);
-    commands.push_back(cmd);
-    return true;
+                                const String& category, uint8_t access, bool hidden) {
+    return registerCommand(CLICommand(name, description, usage, callback, hidden, category, access));
 }
 
 bool GenericCLI::registerCommand(const CLICommand& command) {
-    if (findCommand(command.name) != nullptr) {
+    // Check if command already exists in the same mode
+    if (findCommandInMode(command.name, command.mode) != nullptr) {
         Serial.printf("[%s] Warning: Command '%s' already exists, overwriting\n", 
                      config.logTag.c_str(), command.name.c_str());
-        unregisterCommand(command.name);
+        removeCommand(command.name, command.mode);
     }
     
     commands.push_back(command);
+    indexCommand(commands.size() - 1);
     return true;
 }
 
+bool GenericCLI::setCompleter(const String& name, CompletionCallback completer) {
+    bool found = false;
+    for (auto& cmd : commands) {
+        if (config.caseSensitive ? cmd.name.equals(name) : cmd.name.equalsIgnoreCase(name)) {
+            cmd.completer = completer;
+            found = true;
+        }
+    }
+    return found;
+}
+
 bool GenericCLI::unregisterCommand(const String& name) {
     auto it = std::remove_if(commands.begin(), commands.end(),
         [&](const CLICommand& cmd) { 
@@ -98,6 +157,23 @@ bool GenericCLI::unregisterCommand(const String& name) {
     
     if (it != commands.end()) {
         commands.erase(it, commands.end());
+        // Postings refer to table positions, which just shifted
+        rebuildSearchIndex();
+        return true;
+    }
+    return false;
+}
+
+bool GenericCLI::removeCommand(const String& name, uint8_t mode) {
+    auto it = std::remove_if(commands.begin(), commands.end(),
+        [&](const CLICommand& cmd) { 
+            return cmd.mode == mode &&
+                   (config.caseSensitive ? cmd.name.equals(name) : cmd.name.equalsIgnoreCase(name));
+        });
+    
+    if (it != commands.end()) {
+        commands.erase(it, commands.end());
+        rebuildSearchIndex();
         return true;
     }
     return false;
@@ -105,104 +181,545 @@ bool GenericCLI::unregisterCommand(const String& name) {
 
 void GenericCLI::clearCommands() {
     commands.clear();
+    searchIndex.clear();
+}
+
+// Modes
+bool GenericCLI::addMode(const String& name, const String& description, const String& parent,
+                         uint8_t access) {
+    int parentId = parent.isEmpty() ? CLI_GLOBAL_MODE : findMode(parent);
+    if (parentId < 0) {
+        Serial.printf("[%s] Warning: Parent mode '%s' not found\n", 
+                     config.logTag.c_str(), parent.c_str());
+        return false;
+    }
+    if (name.isEmpty() || findMode(name) >= 0 || modes.size() > UINT8_MAX) {
+        Serial.printf("[%s] Warning: Cannot add mode '%s'\n", 
+                     config.logTag.c_str(), name.c_str());
+        return false;
+    }
+    
+    modes.push_back({ name, description, (uint8_t)parentId });
+    
+    // The mode is entered through a command of the same name in its parent
+    CLICommand entry(name, description, name,
+        [this, name](const CLIArgs& args) { enterMode(name); }, false, "Modes", access);
+    entry.mode = parentId;
+    return registerCommand(entry);
+}
+
+bool GenericCLI::registerModeCommand(const String& mode, const String& name, 
+                                     const String& description, const String& usage, 
+                                     CommandCallback callback, const String& category,
+                                     uint8_t access) {
+    int modeId = findMode(mode);
+    if (modeId < 0) {
+        Serial.printf("[%s] Warning: Mode '%s' not found for command '%s'\n", 
+                     config.logTag.c_str(), mode.c_str(), name.c_str());
+        return false;
+    }
+    
+    CLICommand cmd(name, description, usage, callback, false, 
+                   category.isEmpty() ? mode : category, access);
+    cmd.mode = modeId;
+    return registerCommand(cmd);
+}
+
+bool GenericCLI::enterMode(const String& name) {
+    int modeId = findMode(name);
+    if (modeId < 0) {
+        return false;
+    }
+    activeMode = modeId;
+    return true;
+}
+
+bool GenericCLI::exitMode() {
+    if (activeMode == CLI_GLOBAL_MODE) {
+        return false;
+    }
+    activeMode = modes[activeMode].parent;
+    return true;
+}
+
+String GenericCLI::getModePath() const {
+    String path;
+    for (uint8_t mode = activeMode; mode != CLI_GLOBAL_MODE; mode = modes[mode].parent) {
+        path = path.isEmpty() ? modes[mode].name : modes[mode].name + "/" + path;
+    }
+    return path;
+}
+
+int GenericCLI::findMode(const String& name) const {
+    for (size_t i = 1; i < modes.size(); i++) {
+        if (config.caseSensitive ? modes[i].name.equals(name) : modes[i].name.equalsIgnoreCase(name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Search index
+void GenericCLI::tokenize(const String& text, std::vector<String>& tokens) {
+    static const char* const stopWords[] = { "the", "and", "for", "of", "to", "in", "on", "or", "with" };
+    
+    String token;
+    for (size_t i = 0; i <= text.length(); i++) {
+        char c = (i < text.length()) ? text[i] : ' ';
+        if (isalnum((uint8_t)c)) {
+            token += (char)tolower((uint8_t)c);
+            continue;
+        }
+        if (token.length() >= 2) {
+            bool skip = false;
+            for (const char* word : stopWords) {
+                if (token == word) { skip = true; break; }
+            }
+            if (!skip) tokens.push_back(token);
+        }
+        token = "";
+    }
+}
+
+void GenericCLI::indexCommand(size_t index) {
+    const CLICommand& cmd = commands[index];
+    
+    // Collect the command's distinct tokens with the weight of every field they occur in
+    std::vector<std::pair<String, uint8_t>> weighted;
+    auto addField = [&weighted](const String& text, uint8_t weight) {
+        std::vector<String> tokens;
+        tokenize(text, tokens);
+        for (const auto& token : tokens) {
+            auto it = std::find_if(weighted.begin(), weighted.end(),
+                [&token](const std::pair<String, uint8_t>& w) { return w.first == token; });
+            if (it == weighted.end()) {
+                weighted.push_back(std::make_pair(token, weight));
+            } else {
+                it->second = std::min(255, it->second + weight);
+            }
+        }
+    };
+    addField(cmd.name, 8);
+    addField(cmd.category(), 4);
+    addField(cmd.usage, 2);
+    addField(cmd.description, 1);
+    
+    for (const auto& w : weighted) {
+        auto it = std::lower_bound(searchIndex.begin(), searchIndex.end(), w.first,
+            [](const CLIIndexEntry& entry, const String& token) { return entry.token < token; });
+        if (it == searchIndex.end() || it->token != w.first) {
+            CLIIndexEntry entry;
+            entry.token = w.first;
+            it = searchIndex.insert(it, entry);
+        }
+        it->postings.push_back({ (uint16_t)index, w.second });
+    }
+}
+
+void GenericCLI::rebuildSearchIndex() {
+    searchIndex.clear();
+    for (size_t i = 0; i < commands.size(); i++) {
+        indexCommand(i);
+    }
+}
+
+std::vector<const CLICommand*> GenericCLI::searchCommands(const String& query) const {
+    std::vector<String> terms;
+    tokenize(query, terms);
+    
+    // Per command: number of query terms matched and accumulated weight
+    std::vector<uint8_t> matched(commands.size(), 0);
+    std::vector<uint16_t> score(commands.size(), 0);
+    
+    for (const auto& term : terms) {
+        std::vector<bool> seen(commands.size(), false);
+        
+        // Every token starting with the term is a hit, exact hits count double
+        auto it = std::lower_bound(searchIndex.begin(), searchIndex.end(), term,
+            [](const CLIIndexEntry& entry, const String& token) { return entry.token < token; });
+        for (; it != searchIndex.end() && it->token.startsWith(term); ++it) {
+            uint8_t factor = (it->token.length() == term.length()) ? 2 : 1;
+            for (const auto& posting : it->postings) {
+                score[posting.command] += posting.weight * factor;
+                if (!seen[posting.command]) {
+                    seen[posting.command] = true;
+                    matched[posting.command]++;
+                }
+            }
+        }
+    }
+    
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (matched[i] > 0 && !commands[i].hidden && inScope(commands[i])) {
+            hits.push_back(i);
+        }
+    }
+    std::stable_sort(hits.begin(), hits.end(), [&](size_t a, size_t b) {
+        if (matched[a] != matched[b]) return matched[a] > matched[b];
+        return score[a] > score[b];
+    });
+    
+    std::vector<const CLICommand*> result;
+    for (size_t i : hits) {
+        result.push_back(&commands[i]);
+    }
+    return result;
 }
 
 // Core functionality
 void GenericCLI::begin() {
-    Serial.begin(115200);
-    while (!Serial) {
-        delay(10);
+    if (io == &Serial && config.baudRate > 0) {
+        Serial.begin(config.baudRate);
     }
     
+    // No waiting for the host here: welcome and prompt are sent by
+    // update() once the transport reports a connection
     isRunning = true;
+    hostConnected = false;
+    update();
+}
+
+#if defined(ESP32)
+bool GenericCLI::beginTask(uint32_t stackSize, UBaseType_t priority, uint32_t pollIntervalMs) {
+    if (eventTask != nullptr) {
+        return false;
+    }
     
-    if (config.colorsEnabled) {
-        // Enable ANSI sequences
-        Serial.print("\033[?25h"); // Show cursor
+    bool rxEvents = false;
+#if !ARDUINO_USB_CDC_ON_BOOT
+    if (io == &Serial) {
+        // Called from the UART driver's event queue task
+        Serial.onReceive([this]() { notify(); });
+        rxEvents = true;
     }
+#endif
+    taskPollInterval = (pollIntervalMs > 0 || rxEvents) ? pollIntervalMs : 20;
     
-    printWelcome();
-    printPrompt();
+    begin();
+    if (xTaskCreate(eventTaskMain, "cli", stackSize, this, priority, &eventTask) != pdPASS) {
+        eventTask = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void GenericCLI::eventTaskMain(void* param) {
+    GenericCLI* cli = static_cast<GenericCLI*>(param);
+    while (cli->isRunning) {
+        // A running job needs regular calls even without input
+        uint32_t interval = cli->taskPollInterval;
+        if (cli->job && (interval == 0 || interval > 20)) {
+            interval = 20;
+        }
+        TickType_t wait = interval ? pdMS_TO_TICKS(interval) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+        cli->update();
+    }
+    cli->eventTask = nullptr;
+    vTaskDelete(nullptr);
+}
+#endif
+
+void GenericCLI::notify() {
+#if defined(ESP32)
+    if (eventTask != nullptr) {
+        xTaskNotifyGive(eventTask);
+    }
+#endif
+}
+
+bool GenericCLI::isIdle() {
+    return !executing && !job && io->available() == 0;
+}
+
+void GenericCLI::startJob(JobCallback callback) {
+    job = callback;
+}
+
+void GenericCLI::stopJob() {
+    if (!job) {
+        return;
+    }
+    job = nullptr;
+    if (isRunning) {
+        printPrompt();
+    }
+}
+
+bool GenericCLI::hostPresent() {
+    // USB-CDC ports report whether a host has the port open,
+    // other transports are considered always connected
+    if (io == &Serial) {
+        return (bool)Serial;
+    }
+    return true;
 }
 
 void GenericCLI::update() {
     if (!isRunning) {
         return;
     }
+    wakeups++;
     
-    while (Serial.available()) {
-        char c = Serial.read();
+    bool present = hostPresent();
+    if (present != hostConnected) {
+        hostConnected = present;
+        if (hostConnected) {
+            if (config.colorsEnabled) {
+                // Enable ANSI sequences
+                io->print("\033[?25h"); // Show cursor
+            }
+            printWelcome();
+            printPrompt();
+        }
+    }
+    if (!hostConnected) {
+        return;
+    }
+    
+    if (job) {
+        // While a job runs, input is only checked for Ctrl-C
+        while (io->available()) {
+            stats.bytesReceived++;
+            if (io->read() == 0x03) {
+                io->println("^C");
+                stopJob();
+                return;
+            }
+        }
+        if (!job()) {
+            stopJob();
+        }
+        return;
+    }
+    
+    // Refill the per-second input budget
+    unsigned long now = millis();
+    if (now - rateWindowStart >= 1000) {
+        rateWindowStart = now;
+        rateWindowBytes = 0;
+    }
+    
+    // Bounded work per call keeps loop() responsive under a flood
+    size_t remaining = config.maxBytesPerUpdate > 0 ? config.maxBytesPerUpdate : SIZE_MAX;
+    while (remaining-- > 0 && io->available()) {
+        char c = io->read();
+        stats.bytesReceived++;
         
-        // Handle special sequences (ANSI escape codes)
-        if (c == '\033') { // ESC
-            if (Serial.available() >= 2) {
-                char seq1 = Serial.read();
-                char seq2 = Serial.read();
-                if (seq1 == '[') {
-                    switch (seq2) {
-                        case 'A': processArrowUp(); break;
-                        case 'B': processArrowDown(); break;
-                        case 'C': // Right arrow - move cursor right
-                            if (cursorPos < inputBuffer.length()) {
-                                Serial.print("\033[C");
-                                cursorPos++;
-                            }
-                            break;
-                        case 'D': // Left arrow - move cursor left
-                            if (cursorPos > 0) {
-                                Serial.print("\033[D");
-                                cursorPos--;
-                            }
-                            break;
-                        case 'H': processHome(); break;
-                        case 'F': processEnd(); break;
-                        case '3': // Delete key sequence
-                            if (Serial.available() && Serial.read() == '~') {
-                                processDelete();
-                            }
-                            break;
-                    }
+        if (config.inputRateLimit > 0 && ++rateWindowBytes > config.inputRateLimit) {
+            if (rateWindowBytes == config.inputRateLimit + 1) {
+                stats.rateLimited++;
+                if (!discardingInput) {
+                    io->println();
+                    printWarning("Input rate limit exceeded, discarding until newline");
+                    startDiscarding();
                 }
             }
+            stats.droppedBytes++;
             continue;
         }
         
-        // Handle regular characters
-        if (c == '\n' || c == '\r') {
-            Serial.println();
-            if (!inputBuffer.isEmpty()) {
-                executeCommand(inputBuffer);
-                addToHistory(inputBuffer);
-                inputBuffer = "";
-                cursorPos = 0;
-            }
+        processInput(c);
+        if (!isRunning) {
+            break;
+        }
+    }
+}
+
+void GenericCLI::processInput(char c) {
+    // Nothing is decoded while discarding, escape sequences included, so
+    // a flood cannot recall a history line that the newline would run
+    if (discardingInput) {
+        bool lineEnd = c == '\r' || (c == '\n' && !lastWasCR);
+        lastWasCR = (c == '\r');
+        if (lineEnd) {
+            discardingInput = false;
+            escapeState = EscapeState::NONE;
+            inputBuffer = "";
+            cursorPos = 0;
             exitHistoryMode();
-            
-            // Only print prompt if CLI is still running
-            if (isRunning) {
-                printPrompt();
+            printPrompt();
+        } else if (c != '\n') {
+            stats.droppedBytes++;
+        }
+        return;
+    }
+    
+    // Handle special sequences (ANSI escape codes)
+    if (escapeState != EscapeState::NONE) {
+        processEscape(c);
+        return;
+    }
+    if (c == '\033') { // ESC
+        escapeState = EscapeState::ESC;
+        escapeLength = 0;
+        return;
+    }
+    
+    // Treat CR LF as a single line end
+    if (c == '\n' && lastWasCR) {
+        lastWasCR = false;
+        return;
+    }
+    lastWasCR = (c == '\r');
+    
+    // Handle regular characters
+    if (c == '\n' || c == '\r') {
+        io->println();
+        if (!inputBuffer.isEmpty()) {
+            stats.linesExecuted++;
+            executeCommand(inputBuffer);
+            addToHistory(inputBuffer);
+            inputBuffer = "";
+            cursorPos = 0;
+        }
+        exitHistoryMode();
+        
+        // Only print prompt if CLI is still running and no job took over
+        if (isRunning && !job) {
+            printPrompt();
+        }
+    } else if (c == '\b' || c == 127) { // Backspace
+        processBackspace();
+    } else if (c == '\t') { // Tab completion
+        processTab();
+    } else if (c >= 32 && c <= 126) { // Printable characters
+        if (config.maxLineLength > 0 && inputBuffer.length() >= config.maxLineLength) {
+            stats.overflows++;
+            stats.droppedBytes += inputBuffer.length() + 1;
+            io->println();
+            printWarning("Input line too long (max " + String(config.maxLineLength) + 
+                         " characters), discarding until newline");
+            startDiscarding();
+            return;
+        }
+        
+        if (cursorPos == inputBuffer.length()) {
+            // Append to end
+            inputBuffer += c;
+            cursorPos++;
+            if (config.echoEnabled) {
+                io->print(c);
             }
-        } else if (c == '\b' || c == 127) { // Backspace
-            processBackspace();
-        } else if (c >= 32 && c <= 126) { // Printable characters
-            if (cursorPos == inputBuffer.length()) {
-                // Append to end
-                inputBuffer += c;
-                if (config.echoEnabled) {
-                    Serial.print(c);
-                }
+        } else {
+            // Insert at cursor position
+            inputBuffer = inputBuffer.substring(0, cursorPos) + c + 
+                         inputBuffer.substring(cursorPos);
+            cursorPos++;
+            redrawInputLine(cursorPos - 1);
+        }
+        exitHistoryMode();
+    }
+}
+
+void GenericCLI::processEscape(char c) {
+    switch (escapeState) {
+        case EscapeState::ESC:
+            if (c == '[') {
+                escapeState = EscapeState::CSI;
+            } else if (c == 'O') {
+                escapeState = EscapeState::SS3; // Application cursor keys
             } else {
-                // Insert at cursor position
-                inputBuffer = inputBuffer.substring(0, cursorPos) + c + 
-                             inputBuffer.substring(cursorPos);
-                if (config.echoEnabled) {
-                    redrawInputLine();
+                stats.malformedEscapes++;
+                escapeState = EscapeState::NONE;
+            }
+            return;
+            
+        case EscapeState::CSI:
+            if ((c >= '0' && c <= '9') || c == ';') {
+                // Overlong parameters are swallowed up to the final byte
+                if (escapeLength < sizeof(escapeParams)) {
+                    escapeParams[escapeLength] = c;
+                }
+                if (escapeLength <= sizeof(escapeParams)) {
+                    escapeLength++;
                 }
+                return;
             }
-            cursorPos++;
-            exitHistoryMode();
+            break;
+            
+        case EscapeState::SS3:
+            break;
+            
+        default:
+            escapeState = EscapeState::NONE;
+            return;
+    }
+    
+    // Final byte of a CSI or SS3 sequence
+    escapeState = EscapeState::NONE;
+    if (c < 0x40 || c > 0x7E || escapeLength > sizeof(escapeParams)) {
+        stats.malformedEscapes++;
+        return;
+    }
+    
+    char param = (escapeLength == 1) ? escapeParams[0] : 0;
+    switch (c) {
+        case 'A': processArrowUp(); break;
+        case 'B': processArrowDown(); break;
+        case 'C': // Right arrow - move cursor right
+            if (cursorPos < inputBuffer.length()) {
+                io->print("\033[C");
+                cursorPos++;
+            }
+            break;
+        case 'D': // Left arrow - move cursor left
+            if (cursorPos > 0) {
+                io->print("\033[D");
+                cursorPos--;
+            }
+            break;
+        case 'H': processHome(); break;
+        case 'F': processEnd(); break;
+        case '~': // VT-style keys: 1/7 Home, 3 Delete, 4/8 End
+            if (param == '3') processDelete();
+            else if (param == '1' || param == '7') processHome();
+            else if (param == '4' || param == '8') processEnd();
+            break;
+        default:
+            break; // Well-formed but unsupported (function keys etc.)
+    }
+}
+
+void GenericCLI::startDiscarding() {
+    discardingInput = true;
+    escapeState = EscapeState::NONE;
+    inputBuffer = "";
+    cursorPos = 0;
+    exitHistoryMode();
+}
+
+void GenericCLI::resetStats() {
+    stats = CLIStats();
+}
+
+Stream* GenericCLI::swapStream(Stream* stream) {
+    Stream* previous = io;
+    if (stream != nullptr) {
+        io = stream;
+    }
+    return previous;
+}
+
+// Index after count words of text and the spaces that follow them; a word
+// ends at an unquoted space, as in parseArguments()
+static size_t skipWords(const String& text, size_t count) {
+    size_t i = 0;
+    while (i < text.length() && text[i] == ' ') i++;
+    for (; count > 0 && i < text.length(); count--) {
+        bool inQuotes = false;
+        while (i < text.length() && (inQuotes || text[i] != ' ')) {
+            if (text[i] == '"') inQuotes = !inQuotes;
+            i++;
         }
+        while (i < text.length() && text[i] == ' ') i++;
     }
+    return i;
+}
+
+String CLIArgs::lineAfter(size_t count) const {
+    return line.substring(skipWords(line, count));
 }
 
 void GenericCLI::executeCommand(const String& commandLine) {
@@ -222,10 +739,14 @@ void GenericCLI::executeCommand(const String& commandLine) {
     
     // Remove command name from positional args
     args.positional.erase(args.positional.begin());
+    args.line = commandLine.substring(skipWords(commandLine, 1));
     
     // Find and execute command
     CLICommand* cmd = findCommand(commandName);
     if (cmd != nullptr) {
+        // Commands may run other commands (time, repeat)
+        bool wasExecuting = executing;
+        executing = true;
         try {
             cmd->callback(args);
         } catch (const std::exception& e) {
@@ -233,12 +754,20 @@ void GenericCLI::executeCommand(const String& commandLine) {
         } catch (...) {
             printError("Unknown error occurred during command execution");
         }
+        executing = wasExecuting;
     } else {
-        printError("Unknown command: '" + commandName + "'. Type 'help' for available commands.");
+        String suggestions = suggestCommands(commandName);
+        if (suggestions.isEmpty()) {
+            printError("Unknown command: '" + commandName + "'. Type 'help' for available commands.");
+        } else {
+            printError("Unknown command: '" + commandName + "'");
+            printInfo("Did you mean: " + suggestions + "?");
+        }
     }
 }
 
 // Argument parsing
+
 CLIArgs GenericCLI::parseArguments(const String& input) {
     CLIArgs args;
     String current = "";
@@ -249,50 +778,50 @@ CLIArgs GenericCLI::parseArguments(const String& input) {
     for (size_t i = 0; i < input.length(); i++) {
         char c = input[i];
         
-        if (c == '"' && !inFlag) {
+        if (c == '"') {
             inQuotes = !inQuotes;
         } else if (c == ' ' && !inQuotes) {
-            if (!current.isEmpty()) {
-                if (inFlag) {
+            // A flag value may be empty (--name= ), a positional may not
+            if (inFlag) {
+                if (!flagName.isEmpty()) {
                     args.flags[flagName] = current;
-                    inFlag = false;
-                    flagName = "";
-                } else {
-                    args.positional.push_back(current);
                 }
-                current = "";
+                inFlag = false;
+                flagName = "";
+            } else if (!current.isEmpty()) {
+                args.positional.push_back(current);
             }
-        } else if (c == '-' && !inQuotes && current.isEmpty() && i + 1 < input.length() && input[i + 1] == '-') {
-            // Long flag (--flag=value or --flag)
-            i++; // Skip second dash
-            size_t eqPos = input.indexOf('=', i + 1);
-            if (eqPos != -1 && eqPos < input.indexOf(' ', i + 1)) {
-                // --flag=value format
-                flagName = input.substring(i + 1, eqPos);
-                i = eqPos;
+            current = "";
+        } else if (c == '-' && !inQuotes && !inFlag && current.isEmpty() &&
+                   i + 1 < input.length() && input[i + 1] == '-') {
+            // Long flag: the name runs to '=' (a value follows), a space or the end
+            size_t nameEnd = i + 2;
+            while (nameEnd < input.length() && input[nameEnd] != '=' && input[nameEnd] != ' ') {
+                nameEnd++;
+            }
+            flagName = input.substring(i + 2, nameEnd);
+            if (nameEnd < input.length() && input[nameEnd] == '=') {
                 inFlag = true;
+                i = nameEnd;
             } else {
-                // --flag format (boolean flag)
-                size_t spacePos = input.indexOf(' ', i + 1);
-                if (spacePos == -1) spacePos = input.length();
-                flagName = input.substring(i + 1, spacePos);
-                args.flags[flagName] = "true";
-                i = spacePos - 1;
+                if (!flagName.isEmpty()) {
+                    args.flags[flagName] = "true";
+                }
+                flagName = "";
+                i = nameEnd - 1;
             }
-        } else if (c == '=' && inFlag) {
-            // Continue parsing flag value
         } else {
             current += c;
         }
     }
     
     // Handle remaining content
-    if (!current.isEmpty()) {
-        if (inFlag) {
+    if (inFlag) {
+        if (!flagName.isEmpty()) {
             args.flags[flagName] = current;
-        } else {
-            args.positional.push_back(current);
         }
+    } else if (!current.isEmpty()) {
+        args.positional.push_back(current);
     }
     
     return args;
@@ -342,7 +871,7 @@ void GenericCLI::processArrowUp() {
         inputBuffer = commandHistory[historyIndex];
         cursorPos = inputBuffer.length();
         if (config.echoEnabled) {
-            Serial.print(inputBuffer);
+            io->print(inputBuffer);
         }
     }
 }
@@ -356,7 +885,7 @@ void GenericCLI::processArrowDown() {
         inputBuffer = commandHistory[historyIndex];
         cursorPos = inputBuffer.length();
         if (config.echoEnabled) {
-            Serial.print(inputBuffer);
+            io->print(inputBuffer);
         }
     } else {
         // Restore saved input
@@ -364,7 +893,7 @@ void GenericCLI::processArrowDown() {
         inputBuffer = savedInput;
         cursorPos = inputBuffer.length();
         if (config.echoEnabled) {
-            Serial.print(inputBuffer);
+            io->print(inputBuffer);
         }
         exitHistoryMode();
     }
@@ -374,12 +903,10 @@ void GenericCLI::processBackspace() {
     if (cursorPos > 0 && !inputBuffer.isEmpty()) {
         inputBuffer.remove(cursorPos - 1, 1);
         cursorPos--;
-        if (config.echoEnabled) {
-            if (cursorPos == inputBuffer.length()) {
-                Serial.print("\b \b");
-            } else {
-                redrawInputLine();
-            }
+        if (cursorPos < inputBuffer.length()) {
+            redrawInputLine(cursorPos + 1);
+        } else if (config.echoEnabled) {
+            io->print("\b \b");
         }
         exitHistoryMode();
     }
@@ -388,58 +915,151 @@ void GenericCLI::processBackspace() {
 void GenericCLI::processDelete() {
     if (cursorPos < inputBuffer.length()) {
         inputBuffer.remove(cursorPos, 1);
-        if (config.echoEnabled) {
-            redrawInputLine();
-        }
+        redrawInputLine(cursorPos);
         exitHistoryMode();
     }
 }
 
 void GenericCLI::processHome() {
-    if (cursorPos > 0 && config.echoEnabled) {
-        Serial.printf("\033[%dD", cursorPos);
+    if (cursorPos > 0) {
+        if (config.echoEnabled) {
+            io->printf("\033[%uD", (unsigned)cursorPos);
+        }
         cursorPos = 0;
     }
 }
 
 void GenericCLI::processEnd() {
-    if (cursorPos < inputBuffer.length() && config.echoEnabled) {
-        Serial.printf("\033[%dC", inputBuffer.length() - cursorPos);
+    if (cursorPos < inputBuffer.length()) {
+        if (config.echoEnabled) {
+            io->printf("\033[%uC", (unsigned)(inputBuffer.length() - cursorPos));
+        }
         cursorPos = inputBuffer.length();
     }
 }
 
+void GenericCLI::processTab() {
+    // Completes the word before the cursor, which must be at the end of the line
+    if (cursorPos != inputBuffer.length()) {
+        return;
+    }
+    
+    std::vector<String> candidates;
+    int firstSpace = inputBuffer.indexOf(' ');
+    size_t wordStart = 0;
+    
+    if (firstSpace < 0) {
+        // Command name
+        for (const auto& cmd : commands) {
+            if (cmd.hidden || !inScope(cmd)) continue;
+            candidates.push_back(cmd.name);
+        }
+    } else {
+        // Argument, if the command provides a completer
+        CLICommand* cmd = findCommand(inputBuffer.substring(0, firstSpace));
+        if (cmd == nullptr || !cmd->completer) {
+            return;
+        }
+        wordStart = inputBuffer.lastIndexOf(' ') + 1;
+        
+        // Index among the positional arguments; flags are not counted
+        size_t argIndex = 0;
+        int pos = firstSpace;
+        while (pos < (int)wordStart - 1) {
+            int next = inputBuffer.indexOf(' ', pos + 1);
+            if (next > pos + 1 && !inputBuffer.substring(pos + 1, next).startsWith("--")) {
+                argIndex++;
+            }
+            pos = next;
+        }
+        cmd->completer(argIndex, inputBuffer.substring(wordStart), candidates);
+    }
+    
+    String word = inputBuffer.substring(wordStart);
+    std::vector<String> matches;
+    for (const auto& candidate : candidates) {
+        bool prefix = candidate.length() >= word.length() &&
+            (config.caseSensitive ? candidate.startsWith(word)
+                                  : candidate.substring(0, word.length()).equalsIgnoreCase(word));
+        if (prefix) {
+            matches.push_back(candidate);
+        }
+    }
+    if (matches.empty()) {
+        return;
+    }
+    
+    // Longest common prefix of all candidates
+    String completion = matches[0];
+    for (const auto& match : matches) {
+        size_t len = 0;
+        while (len < completion.length() && len < match.length() &&
+               (config.caseSensitive ? completion[len] == match[len]
+                                     : tolower(completion[len]) == tolower(match[len]))) {
+            len++;
+        }
+        completion = completion.substring(0, len);
+    }
+    if (matches.size() == 1) {
+        completion += " ";
+    }
+    
+    if (completion.length() > word.length()) {
+        String added = completion.substring(word.length());
+        inputBuffer += added;
+        cursorPos = inputBuffer.length();
+        if (config.echoEnabled) {
+            io->print(added);
+        }
+    } else if (matches.size() > 1) {
+        // Nothing to add: list the candidates and restore the line
+        io->println();
+        for (const auto& match : matches) {
+            io->print(match + "  ");
+        }
+        io->println();
+        printPrompt();
+        if (config.echoEnabled) {
+            io->print(inputBuffer);
+        }
+    }
+    exitHistoryMode();
+}
+
 // Display functions
-void GenericCLI::redrawInputLine() {
+// The terminal cursor is at column `from` of the input; it ends at cursorPos.
+// A zero count is not sent, terminals read "\033[0D" as one column.
+void GenericCLI::redrawInputLine(size_t from) {
     if (!config.echoEnabled) return;
     
-    // Save cursor position
-    Serial.printf("\033[%dD", cursorPos); // Move to beginning
-    Serial.print("\033[K"); // Clear to end of line
-    Serial.print(inputBuffer); // Print entire buffer
+    if (from > 0) {
+        io->printf("\033[%uD", (unsigned)from); // Move to beginning
+    }
+    io->print("\033[K"); // Clear to end of line
+    io->print(inputBuffer); // Print entire buffer
     
     // Move cursor to correct position
     if (cursorPos < inputBuffer.length()) {
-        Serial.printf("\033[%dD", inputBuffer.length() - cursorPos);
+        io->printf("\033[%uD", (unsigned)(inputBuffer.length() - cursorPos));
     }
 }
 
 void GenericCLI::clearInputLine() {
     if (!config.echoEnabled) return;
     
-    Serial.printf("\033[2K\033[G");
+    io->printf("\033[2K\033[G");
     printPrompt();
-//    Serial.printf("\033[%dD", cursorPos); // Move to beginning
-//    Serial.print("\033[K"); // Clear to end of line
+//    io->printf("\033[%dD", cursorPos); // Move to beginning
+//    io->print("\033[K"); // Clear to end of line
 }
 
 // Output functions
 void GenericCLI::print(const String& message, MessageType type) {
-    Serial.print(formatMessage(type, message));
+    io->print(formatMessage(type, message));
 }
 
 void GenericCLI::println(const String& message, MessageType type) {
-    Serial.println(formatMessage(type, message));
+    io->println(formatMessage(type, message));
 }
 
 void GenericCLI::printSuccess(const String& message) {
@@ -458,38 +1078,72 @@ void GenericCLI::printInfo(const String& message) {
     println(message, MessageType::INFO);
 }
 
+void GenericCLI::writePadded(const char* text, size_t length, int width) {
+    size_t target = (size_t)(width < 0 ? -width : width);
+    size_t padding = target > length ? target - length : 0;
+    if (width > 0) {
+        for (size_t i = 0; i < padding; i++) io->write(' ');
+    }
+    io->write((const uint8_t*)text, length);
+    if (width < 0) {
+        for (size_t i = 0; i < padding; i++) io->write(' ');
+    }
+}
+
+void GenericCLI::printNum(int64_t value, int width) {
+    char text[CLIFormat::NUMBER_SIZE];
+    writePadded(text, CLIFormat::formatSigned(text, value) - text, width);
+}
+
+void GenericCLI::printFixed(float value, uint8_t decimals, int width) {
+    char text[CLIFormat::NUMBER_SIZE];
+    writePadded(text, CLIFormat::formatFixed(text, value, decimals) - text, width);
+}
+
+void GenericCLI::printBytes(uint64_t bytes, int width) {
+    char text[CLIFormat::NUMBER_SIZE];
+    writePadded(text, CLIFormat::formatBytes(text, bytes) - text, width);
+}
+
 void GenericCLI::printWelcome() {
     if (!config.welcomeMessage.isEmpty()) {
         if (config.colorsEnabled) {
-            Serial.print(ANSIColors::CBRIGHT_CYAN);
-            Serial.print(ANSIIcons::INFO);
-            Serial.print(" ");
+            io->print(ANSIColors::CBRIGHT_CYAN);
+            io->print(ANSIIcons::INFO);
+            io->print(" ");
         }
-        Serial.print(config.welcomeMessage);
+        io->print(config.welcomeMessage);
         if (config.colorsEnabled) {
-            Serial.print(ANSIColors::CRESET);
+            io->print(ANSIColors::CRESET);
         }
-        Serial.println();
+        io->println();
         println("Type 'help' to see available commands.", MessageType::INFO);
-        Serial.println();
+        io->println();
     }
 }
 
 void GenericCLI::printPrompt() {
+    String modePath = getModePath();
     if (config.colorsEnabled) {
         // Simplified prompt for better compatibility
-        Serial.print(ANSIColors::CBRIGHT_CYAN);
-        Serial.print(config.prompt);
-        Serial.print(ANSIColors::CCYAN);
-        Serial.print(" > ");
-        Serial.print(ANSIColors::CRESET);
+        io->print(ANSIColors::CBRIGHT_CYAN);
+        io->print(config.prompt);
+        if (!modePath.isEmpty()) {
+            io->print(ANSIColors::CYELLOW);
+            io->print("(" + modePath + ")");
+        }
+        io->print(ANSIColors::CCYAN);
+        io->print(" > ");
+        io->print(ANSIColors::CRESET);
+    } else if (!modePath.isEmpty()) {
+        io->print(config.prompt + "(" + modePath + ") > ");
     } else {
-        Serial.print(config.prompt + " > ");
+        io->print(config.prompt + " > ");
     }
 }
 
 void GenericCLI::clearScreen() {
-    Serial.print("\033[2J\033[H");
+    io->print("\033[2J\033[H");
 }
 
 // Built-in command handlers
@@ -500,30 +1154,30 @@ void GenericCLI::handleHelpCommand(const CLIArgs& args) {
         String commandName = args.getPositional(0);
         CLICommand* cmd = findCommand(commandName);
         if (cmd != nullptr) {
-            Serial.println();
+            io->println();
             if (config.colorsEnabled) {
-                Serial.print(ANSIColors::CBRIGHT_WHITE);
-                Serial.print("Command: ");
-                Serial.print(ANSIColors::CBRIGHT_CYAN);
-                Serial.println(cmd->name);
-                Serial.print(ANSIColors::CBRIGHT_WHITE);
-                Serial.print("Category: ");
-                Serial.print(ANSIColors::CYELLOW);
-                Serial.println(cmd->category);
-                Serial.print(ANSIColors::CBRIGHT_WHITE);
-                Serial.print("Description: ");
-                Serial.print(ANSIColors::CRESET);
-                Serial.println(cmd->description);
-                Serial.print(ANSIColors::CBRIGHT_WHITE);
-                Serial.print("Usage: ");
-                Serial.print(ANSIColors::CGREEN);
-                Serial.println(cmd->usage);
-                Serial.print(ANSIColors::CRESET);
+                io->print(ANSIColors::CBRIGHT_WHITE);
+                io->print("Command: ");
+                io->print(ANSIColors::CBRIGHT_CYAN);
+                io->println(cmd->name);
+                io->print(ANSIColors::CBRIGHT_WHITE);
+                io->print("Category: ");
+                io->print(ANSIColors::CYELLOW);
+                io->println(cmd->category());
+                io->print(ANSIColors::CBRIGHT_WHITE);
+                io->print("Description: ");
+                io->print(ANSIColors::CRESET);
+                io->println(cmd->description);
+                io->print(ANSIColors::CBRIGHT_WHITE);
+                io->print("Usage: ");
+                io->print(ANSIColors::CGREEN);
+                io->println(cmd->usage);
+                io->print(ANSIColors::CRESET);
             } else {
-                Serial.println("Command: " + cmd->name);
-                Serial.println("Category: " + cmd->category);
-                Serial.println("Description: " + cmd->description);
-                Serial.println("Usage: " + cmd->usage);
+                io->println("Command: " + cmd->name);
+                io->println("Category: " + cmd->category());
+                io->println("Description: " + cmd->description);
+                io->println("Usage: " + cmd->usage);
             }
         } else {
             printError("Command not found: " + commandName);
@@ -543,27 +1197,27 @@ void GenericCLI::handleHistoryCommand(const CLIArgs& args) {
         return;
     }
     
-    Serial.println();
+    io->println();
     if (config.colorsEnabled) {
-        Serial.print(ANSIColors::CBRIGHT_WHITE);
-        Serial.println("Command History:");
-        Serial.print(ANSIColors::CRESET);
+        io->print(ANSIColors::CBRIGHT_WHITE);
+        io->println("Command History:");
+        io->print(ANSIColors::CRESET);
     } else {
-        Serial.println("Command History:");
+        io->println("Command History:");
     }
-    Serial.println("===============");
+    io->println("===============");
     
     for (size_t i = 0; i < commandHistory.size(); i++) {
         if (config.colorsEnabled) {
-            Serial.printf("%s%3d%s %s%s%s %s\n",
-                         ANSIColors::CBRIGHT_BLACK, i + 1, ANSIColors::CRESET,
+            io->printf("%s%3u%s %s%s%s %s\n",
+                         ANSIColors::CBRIGHT_BLACK, (unsigned)(i + 1), ANSIColors::CRESET,
                          ANSIColors::CCYAN, ANSIIcons::ARROW_RIGHT, ANSIColors::CRESET,
                          commandHistory[i].c_str());
         } else {
-            Serial.printf("%3d > %s\n", i + 1, commandHistory[i].c_str());
+            io->printf("%3u > %s\n", (unsigned)(i + 1), commandHistory[i].c_str());
         }
     }
-    Serial.println();
+    io->println();
 }
 
 void GenericCLI::handleClearCommand(const CLIArgs& args) {
@@ -572,50 +1226,95 @@ void GenericCLI::handleClearCommand(const CLIArgs& args) {
 }
 
 void GenericCLI::handleExitCommand(const CLIArgs& args) {
+    // Inside a mode, exit only leaves that mode
+    if (exitMode()) {
+        return;
+    }
     printInfo("Goodbye!");
     stopCLI();
 }
 
+void GenericCLI::handleAproposCommand(const CLIArgs& args) {
+    if (args.empty()) {
+        printError("Usage: apropos <keyword...>");
+        return;
+    }
+    
+    String query;
+    for (const auto& word : args.positional) {
+        query += word + " ";
+    }
+    query.trim();
+    
+    std::vector<const CLICommand*> results = searchCommands(query);
+    if (results.empty()) {
+        printInfo("Nothing appropriate for: " + query);
+        return;
+    }
+    
+    for (const auto* cmd : results) {
+        if (config.colorsEnabled) {
+            io->println("  \033[36m" + cmd->name + "\033[0m - " + cmd->description + 
+                           " \033[90m(" + cmd->category() + ")\033[0m");
+        } else {
+            io->println("  " + cmd->name + " - " + cmd->description + " (" + cmd->category() + ")");
+        }
+    }
+}
+
 void GenericCLI::printCommandList() {
-    Serial.println();
+    io->println();
     
-    // Group commands by category
-    std::map<String, std::vector<CLICommand*>> categorized;
-    for (auto& cmd : commands) {
-        if (!cmd.hidden) {
-            categorized[cmd.category].push_back(&cmd);
+    // Rank the (few) categories alphabetically once, then group with an integer sort
+    size_t categoryCount = CLIStrings::count();
+    std::vector<uint16_t> order(categoryCount);
+    for (size_t i = 0; i < categoryCount; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [](uint16_t a, uint16_t b) {
+        return CLIStrings::lookup(a) < CLIStrings::lookup(b);
+    });
+    std::vector<uint16_t> rank(categoryCount);
+    for (size_t i = 0; i < categoryCount; i++) rank[order[i]] = i;
+    
+    std::vector<const CLICommand*> visible;
+    for (const auto& cmd : commands) {
+        if (!cmd.hidden && inScope(cmd)) {
+            visible.push_back(&cmd);
         }
     }
+    std::stable_sort(visible.begin(), visible.end(), [&rank](const CLICommand* a, const CLICommand* b) {
+        return rank[a->categoryId] < rank[b->categoryId];
+    });
     
     if (config.colorsEnabled) {
-        Serial.println("\033[97mAvailable Commands:\033[0m");
+        io->println("\033[97mAvailable Commands:\033[0m");
     } else {
-        Serial.println("Available Commands:");
+        io->println("Available Commands:");
     }
-    Serial.println("==================");
+    io->println("==================");
     
-    for (const auto& category : categorized) {
-        Serial.println();
-        if (config.colorsEnabled) {
-            Serial.println("\033[33m• " + category.first + "\033[0m");
-        } else {
-            Serial.println("• " + category.first);
-        }
-        
-        for (const auto& cmd : category.second) {
+    for (size_t i = 0; i < visible.size(); i++) {
+        const CLICommand* cmd = visible[i];
+        if (i == 0 || visible[i - 1]->categoryId != cmd->categoryId) {
+            io->println();
             if (config.colorsEnabled) {
-                Serial.println("  \033[36m" + cmd->name + "\033[0m - " + cmd->description);
+                io->println("\033[33m• " + cmd->category() + "\033[0m");
             } else {
-                Serial.println("  " + cmd->name + " - " + cmd->description);
+                io->println("• " + cmd->category());
             }
         }
+        
+        if (config.colorsEnabled) {
+            io->println("  \033[36m" + cmd->name + "\033[0m - " + cmd->description);
+        } else {
+            io->println("  " + cmd->name + " - " + cmd->description);
+        }
     }
     
-    Serial.println();
+    io->println();
     if (config.colorsEnabled) {
-        Serial.println("\033[36mℹ\033[0m Use 'help <command>' for detailed usage information");
+        io->println("\033[36mℹ\033[0m Use 'help <command>' for detailed usage information");
     } else {
-        Serial.println("INFO: Use 'help <command>' for detailed usage information");
+        io->println("INFO: Use 'help <command>' for detailed usage information");
     }
 }
 
@@ -654,7 +1353,25 @@ String GenericCLI::formatMessage(MessageType type, const String& message) const
 }
 
 CLICommand* GenericCLI::findCommand(const String& name) {
+    // Active mode first, global commands as fallback; other modes are skipped
+    CLICommand* global = nullptr;
     for (auto& cmd : commands) {
+        if (!inScope(cmd)) continue;
+        if (config.caseSensitive ? cmd.name.equals(name) : cmd.name.equalsIgnoreCase(name)) {
+            if (cmd.mode == activeMode) {
+                return &cmd;
+            }
+            if (global == nullptr) {
+                global = &cmd;
+            }
+        }
+    }
+    return global;
+}
+
+CLICommand* GenericCLI::findCommandInMode(const String& name, uint8_t mode) {
+    for (auto& cmd : commands) {
+        if (cmd.mode != mode) continue;
         if (config.caseSensitive ? cmd.name.equals(name) : cmd.name.equalsIgnoreCase(name)) {
             return &cmd;
         }
@@ -662,11 +1379,53 @@ CLICommand* GenericCLI::findCommand(const String& name) {
     return nullptr;
 }
 
+String GenericCLI::suggestCommands(const String& name) const {
+    if (config.maxSuggestions == 0 || name.isEmpty()) {
+        return "";
+    }
+    
+    // Short inputs get a tighter bound, otherwise every two-letter typo matches everything
+    uint8_t maxDistance = std::min<size_t>(config.suggestionDistance, 
+                                           std::max<size_t>(1, name.length() / 2));
+    
+    // Best candidates so far, ordered by distance (ties keep registration order)
+    std::vector<std::pair<uint8_t, const CLICommand*>> best;
+    best.reserve(config.maxSuggestions + 1);
+    
+    for (const auto& cmd : commands) {
+        if (cmd.hidden || !inScope(cmd)) continue;
+        
+        // Once the list is full only strictly better candidates are interesting
+        uint8_t limit = maxDistance;
+        if (best.size() == config.maxSuggestions) {
+            if (best.back().first == 0) break;
+            limit = best.back().first - 1;
+        }
+        
+        uint8_t distance = CLIHelpers::editDistance(name, cmd.name, limit, config.caseSensitive);
+        if (distance > limit) continue;
+        
+        auto pos = std::upper_bound(best.begin(), best.end(), distance,
+            [](uint8_t d, const std::pair<uint8_t, const CLICommand*>& entry) { return d < entry.first; });
+        best.insert(pos, std::make_pair(distance, &cmd));
+        if (best.size() > config.maxSuggestions) {
+            best.pop_back();
+        }
+    }
+    
+    String result;
+    for (const auto& entry : best) {
+        if (!result.isEmpty()) result += ", ";
+        result += "'" + entry.second->name + "'";
+    }
+    return result;
+}
+
 // Public utility methods
 std::vector<String> GenericCLI::getCommandNames() const {
     std::vector<String> names;
     for (const auto& cmd : commands) {
-        if (!cmd.hidden) {
+        if (!cmd.hidden && inScope(cmd)) {
             names.push_back(cmd.name);
         }
     }
@@ -742,17 +1501,26 @@ namespace CLIHelpers {
     
     bool validateArgCount(const CLIArgs& args, size_t min, size_t max) {
         size_t count = args.size();
+        const char* problem = nullptr;
+        size_t limit = 0;
         if (count < min) {
-            Serial.printf("Error: Too few arguments. Expected at least %d, got %d\n", 
-                         min, count);
-            return false;
+            problem = "Error: Too few arguments. Expected at least ";
+            limit = min;
+        } else if (max != SIZE_MAX && count > max) {
+            problem = "Error: Too many arguments. Expected at most ";
+            limit = max;
         }
-        if (max != SIZE_MAX && count > max) {
-            Serial.printf("Error: Too many arguments. Expected at most %d, got %d\n", 
-                         max, count);
-            return false;
+        if (problem == nullptr) {
+            return true;
         }
-        return true;
+        
+        char number[CLIFormat::NUMBER_SIZE];
+        Serial.print(problem);
+        Serial.write((const uint8_t*)number, CLIFormat::formatUnsigned(number, limit) - number);
+        Serial.print(", got ");
+        Serial.write((const uint8_t*)number, CLIFormat::formatUnsigned(number, count) - number);
+        Serial.println();
+        return false;
     }
     
     bool validateFlags(const CLIArgs& args, const std::vector<String>& requiredFlags) {
@@ -764,4 +1532,56 @@ namespace CLIHelpers {
         }
         return true;
     }
+    
+    uint8_t editDistance(const String& a, const String& b, uint8_t maxDistance, bool caseSensitive) {
+        // Bit-parallel edit distance (Myers 1999, global variant by Hyyro):
+        // one column of the DP matrix is kept as vertical delta bit vectors,
+        // so each character of b costs a handful of word operations.
+        size_t m = std::min<size_t>(a.length(), 32);
+        size_t n = b.length();
+        
+        auto fold = [caseSensitive](char c) -> uint8_t {
+            return caseSensitive ? (uint8_t)c : (uint8_t)tolower((uint8_t)c);
+        };
+        auto clamp = [maxDistance](size_t d) -> uint8_t {
+            return d > maxDistance ? (uint8_t)(maxDistance + 1) : (uint8_t)d;
+        };
+        
+        if (m == 0) return clamp(n);
+        if ((m > n ? m - n : n - m) > maxDistance) return clamp(maxDistance + 1);
+        
+        // Match masks per ASCII character; non-ASCII bytes never match
+        uint32_t peq[128] = {0};
+        for (size_t i = 0; i < m; i++) {
+            uint8_t c = fold(a[i]);
+            if (c < 128) peq[c] |= (uint32_t)1 << i;
+        }
+        
+        const uint32_t lastBit = (uint32_t)1 << (m - 1);
+        uint32_t pv = (m == 32) ? 0xFFFFFFFFu : (lastBit << 1) - 1;
+        uint32_t mv = 0;
+        size_t score = m;
+        
+        for (size_t j = 0; j < n; j++) {
+            uint8_t c = fold(b[j]);
+            uint32_t eq = (c < 128) ? peq[c] : 0;
+            uint32_t xv = eq | mv;
+            uint32_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint32_t ph = mv | ~(xh | pv);
+            uint32_t mh = pv & xh;
+            
+            if (ph & lastBit) score++;
+            else if (mh & lastBit) score--;
+            
+            // The score drops by at most one per remaining character
+            if (score > maxDistance + (n - j - 1)) return clamp(maxDistance + 1);
+            
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+        
+        return clamp(score);
+    }
 }
\ No newline at end of file
@@ -57,6 +57,7 @@ enum class MessageType {
 struct CLIArgs {
     std::vector<String> positional;
     std::map<String, String> flags;
+    String line;    // Everything after the command name, as typed
     
     bool hasFlag(const String& flag) const {
         return flags.find(flag) != flags.end();
@@ -73,10 +74,37 @@ struct CLIArgs {
     
     size_t size() const { return positional.size(); }
     bool empty() const { return positional.empty(); }
+    
+    // line without its first count words, for commands that run the rest
+    // of their line as another command (time, repeat)
+    String lineAfter(size_t count) const;
 };
 
+// Shared string table for values repeated across many commands (categories).
+// Each distinct string is stored once and referenced by a small integer ID.
+namespace CLIStrings {
+    const uint16_t GENERAL = 0; // "General", always present
+    
+    uint16_t intern(const String& text);
+    const String& lookup(uint16_t id);
+    size_t count();
+}
+
+// Access roles. A command is usable when its access mask shares a bit
+// with the session role, so a session may hold several roles at once.
+namespace CLIRoles {
+    const uint8_t USER     = 0x01;
+    const uint8_t OPERATOR = 0x02;
+    const uint8_t ADMIN    = 0x04;
+    const uint8_t FACTORY  = 0x08;
+    const uint8_t ALL      = 0xFF;
+}
+
 // Command callback function type
 using CommandCallback = std::function<void(const CLIArgs&)>;
+using JobCallback = std::function<bool()>;  // Return false when finished
+// Adds completion candidates for positional argument argIndex (0 = first after the command)
+using CompletionCallback = std::function<void(size_t argIndex, const String& prefix, std::vector<String>& candidates)>;
 
 // Command structure
 struct CLICommand {
@@ -84,14 +112,56 @@ struct CLICommand {
     String description;
     String usage;
     CommandCallback callback;
+    CompletionCallback completer;   // Optional, for Tab on arguments
     bool hidden;
-    String category;
+    uint16_t categoryId;    // Interned, see CLIStrings
+    uint8_t mode;           // Owning mode, CLI_GLOBAL_MODE = available everywhere
+    uint8_t access;         // CLIRoles allowed to see and run the command
     
-    CLICommand() : hidden(false), category("General") {}
+    CLICommand() : hidden(false), categoryId(CLIStrings::GENERAL), mode(0), access(CLIRoles::ALL) {}
     
     CLICommand(const String& n, const String& desc, const String& use, 
-               CommandCallback cb, bool hide = false, const String& cat = "General") :
-        name(n), description(desc), usage(use), callback(cb), hidden(hide), category(cat) {}
+               CommandCallback cb, bool hide = false, const String& cat = "General",
+               uint8_t acc = CLIRoles::ALL) :
+        name(n), description(desc), usage(use), callback(cb), hidden(hide), 
+        categoryId(CLIStrings::intern(cat)), mode(0), access(acc) {}
+    
+    const String& category() const { return CLIStrings::lookup(categoryId); }
+};
+
+// Command mode (nested context like Cisco's "configure" mode).
+// Mode 0 is the global scope; every other mode has its own commands
+// and is entered through a command registered in its parent.
+const uint8_t CLI_GLOBAL_MODE = 0;
+
+struct CLIMode {
+    String name;
+    String description;
+    uint8_t parent;
+};
+
+// Search index entry: one lower-case token and the commands it appears in
+struct CLIIndexPosting {
+    uint16_t command;   // Index into the command table
+    uint8_t weight;     // Higher for matches in name/category than in description
+};
+
+struct CLIIndexEntry {
+    String token;
+    std::vector<CLIIndexPosting> postings;
+};
+
+// Input statistics, see GenericCLI::getStats()
+struct CLIStats {
+    uint32_t bytesReceived;
+    uint32_t linesExecuted;
+    uint32_t overflows;         // Lines longer than maxLineLength
+    uint32_t droppedBytes;      // Discarded by overflow recovery or the rate limit
+    uint32_t rateLimited;       // Seconds in which inputRateLimit was exceeded
+    uint32_t malformedEscapes;
+    
+    CLIStats() : bytesReceived(0), linesExecuted(0), overflows(0), 
+                 droppedBytes(0), rateLimited(0), malformedEscapes(0) {}
 };
 
 // CLI Configuration
@@ -103,6 +173,14 @@ struct CLIConfig {
     size_t historySize;
     bool caseSensitive;
     String logTag;
+    size_t maxSuggestions;      // "Did you mean" entries for unknown commands (0 = off)
+    uint8_t suggestionDistance; // Maximum edit distance for a suggestion
+    uint8_t role;               // CLIRoles held by this session
+    Stream* stream;             // Transport, nullptr = Serial
+    unsigned long baudRate;     // Serial speed set by begin(), 0 = already initialized
+    size_t maxLineLength;       // Longer lines are discarded up to the next newline (0 = unlimited)
+    size_t inputRateLimit;      // Input bytes accepted per second (0 = unlimited)
+    size_t maxBytesPerUpdate;   // Input bytes handled per update() call (0 = all available)
     
     CLIConfig() : 
         prompt("cli"), 
@@ -111,16 +189,40 @@ struct CLIConfig {
         colorsEnabled(true), 
         historySize(50),
         caseSensitive(false),
-        logTag("CLI") {}
+        logTag("CLI"),
+        maxSuggestions(3),
+        suggestionDistance(2),
+        role(CLIRoles::USER),
+        stream(nullptr),
+        baudRate(115200),
+        maxLineLength(256),
+        inputRateLimit(0),
+        maxBytesPerUpdate(128) {}
 };
 
+namespace CLIBench { class Internals; }
+namespace CLIFuzz { class Probe; }
+class CLISessionReplay;
+
 class GenericCLI {
 private:
+    friend class CLIBench::Internals;  // clibench times the private hot paths
+    friend class CLISessionReplay;      // Sets the live session aside during a replay
+    friend class CLIFuzz::Probe;        // Host fuzz targets check the decoder invariants
+    
+    void writePadded(const char* text, size_t length, int width);
+    
     // Configuration
     CLIConfig config;
+    Stream* io;
     
     // Commands
     std::vector<CLICommand> commands;
+    std::vector<CLIIndexEntry> searchIndex; // Sorted by token, maintained on registration
+    
+    // Modes
+    std::vector<CLIMode> modes;             // modes[0] is the global scope
+    uint8_t activeMode;
     
     // Input handling
     String inputBuffer;
@@ -132,15 +234,43 @@ private:
     // Terminal state
     size_t cursorPos;
     bool isRunning;
+    bool hostConnected;
+    bool executing;                 // Inside a command callback
+    JobCallback job;                // Foreground job, empty when none
+    
+    // Input decoder state
+    enum class EscapeState : uint8_t { NONE, ESC, CSI, SS3 };
+    EscapeState escapeState;
+    char escapeParams[4];
+    uint8_t escapeLength;
+    bool lastWasCR;
+    bool discardingInput;           // Recovering from overflow, until the next newline
+    
+    // Flood protection
+    unsigned long rateWindowStart;
+    size_t rateWindowBytes;
+    CLIStats stats;
+    
+    // Event-driven operation
+    volatile uint32_t wakeups;
+#if defined(ESP32)
+    TaskHandle_t eventTask;
+    uint32_t taskPollInterval;
+    static void eventTaskMain(void* param);
+#endif
     
     // Internal command handlers
     void handleHelpCommand(const CLIArgs& args);
     void handleHistoryCommand(const CLIArgs& args);
     void handleClearCommand(const CLIArgs& args);
     void handleExitCommand(const CLIArgs& args);
+    void handleAproposCommand(const CLIArgs& args);
     
     // Input processing
     CLIArgs parseArguments(const String& input);
+    void processInput(char c);
+    void processEscape(char c);
+    void startDiscarding();
     void processSpecialKey(char c);
     void processArrowUp();
     void processArrowDown();
@@ -148,14 +278,20 @@ private:
     void processDelete();
     void processHome();
     void processEnd();
+    void processTab();
     
     // History management
     void addToHistory(const String& command);
     void enterHistoryMode();
     void exitHistoryMode();
     
+    // Search index
+    static void tokenize(const String& text, std::vector<String>& tokens);
+    void indexCommand(size_t index);
+    void rebuildSearchIndex();
+    
     // Display functions
-    void redrawInputLine();
+    void redrawInputLine(size_t from);
     void clearInputLine();
     void moveCursor(int delta);
     
@@ -163,9 +299,17 @@ private:
     String colorize(const String& text, const char* color) const;
     String formatMessage(MessageType type, const String& message) const;
     CLICommand* findCommand(const String& name);
+    CLICommand* findCommandInMode(const String& name, uint8_t mode);
+    bool removeCommand(const String& name, uint8_t mode);
+    int findMode(const String& name) const;
+    bool inScope(const CLICommand& cmd) const { 
+        return (cmd.mode == CLI_GLOBAL_MODE || cmd.mode == activeMode) && (cmd.access & config.role);
+    }
+    String suggestCommands(const String& name) const;
     
     // Internal utility to stop CLI
     void stopCLI();
+    bool hostPresent();
     
 public:
     GenericCLI();
@@ -180,21 +324,63 @@ public:
     void setColorsEnabled(bool enabled);
     void setEchoEnabled(bool enabled);
     void setHistorySize(size_t size);
+    void setRole(uint8_t role);
+    uint8_t getRole() const { return config.role; }
     
     // Command registration
     bool registerCommand(const String& name, const String& description, 
                         const String& usage, CommandCallback callback, 
-                        const String& category = "General");
+                        const String& category = "General",
+                        uint8_t access = CLIRoles::ALL, bool hidden = false);
     bool registerCommand(const CLICommand& command);
     bool unregisterCommand(const String& name);
+    bool setCompleter(const String& name, CompletionCallback completer);
     void clearCommands();
     
+    // Modes
+    bool addMode(const String& name, const String& description, const String& parent = "",
+                 uint8_t access = CLIRoles::ALL);
+    bool registerModeCommand(const String& mode, const String& name, const String& description,
+                             const String& usage, CommandCallback callback,
+                             const String& category = "", uint8_t access = CLIRoles::ALL);
+    bool enterMode(const String& name);
+    bool exitMode();                // Back to the parent mode, false if already global
+    String getModePath() const;     // e.g. "configure/wifi", empty when global
+    
     // Core functionality
-    void begin();
+    void begin();   // Non-blocking, the welcome is shown once the host connects
     void update();
     void executeCommand(const String& commandLine);
     void stop(); // Stop the CLI
     bool running() const; // Check if CLI is running
+    bool connected() const { return hostConnected; }
+    
+    // Event-driven mode: instead of polling update() from loop(), a task
+    // sleeps until the UART receives data. pollIntervalMs = 0 picks event-only
+    // wakeups when Serial supports RX callbacks, 20 ms polling otherwise.
+#if defined(ESP32)
+    bool beginTask(uint32_t stackSize = 4096, UBaseType_t priority = 1, uint32_t pollIntervalMs = 0);
+#endif
+    // Foreground job: work a command leaves running after it returns (e.g.
+    // `tail --follow`). update() calls the job instead of reading commands
+    // until it returns false or the user presses Ctrl-C, then shows the prompt.
+    void startJob(JobCallback callback);
+    void stopJob();
+    bool jobRunning() const { return (bool)job; }
+    
+    void notify();                  // Wake the CLI task, e.g. from a custom transport's RX callback
+    bool isIdle();                  // No pending input and no command running: safe to light sleep
+    uint32_t getWakeups() const { return wakeups; } // update() calls since start
+    
+    // Input statistics
+    const CLIStats& getStats() const { return stats; }
+    void resetStats();
+    Stream& getStream() { return *io; }
+    
+    // Routes the CLI's input and output through another stream until it is
+    // swapped back, e.g. to count or mute what a nested command prints.
+    // Returns the stream that was in use.
+    Stream* swapStream(Stream* stream);
     
     // Output functions
     void print(const String& message, MessageType type = MessageType::NORMAL);
@@ -204,6 +390,12 @@ public:
     void printWarning(const String& message);
     void printInfo(const String& message);
     
+    // Numbers straight to the stream, without String or printf. width pads
+    // with spaces: positive right aligns, negative left aligns.
+    void printNum(int64_t value, int width = 0);
+    void printFixed(float value, uint8_t decimals = 2, int width = 0);
+    void printBytes(uint64_t bytes, int width = 0);    // "1.5 KB"
+    
     // Display functions
     void printWelcome();
     void printPrompt();
@@ -215,6 +407,7 @@ public:
     size_t getCommandCount() const { return commands.size(); }
     std::vector<String> getCommandNames() const;
     bool hasCommand(const String& name) const;
+    std::vector<const CLICommand*> searchCommands(const String& query) const;
     
     // History access
     std::vector<String> getHistory() const;
@@ -236,6 +429,11 @@ namespace CLIHelpers {
     // Argument parsing helpers
     bool validateArgCount(const CLIArgs& args, size_t min, size_t max = SIZE_MAX);
     bool validateFlags(const CLIArgs& args, const std::vector<String>& requiredFlags);
+    
+    // Levenshtein distance between a and b (only the first 32 chars of a are used).
+    // Returns maxDistance + 1 as soon as the distance is known to exceed maxDistance.
+    uint8_t editDistance(const String& a, const String& b, 
+                         uint8_t maxDistance = 254, bool caseSensitive = false);
 }
 
 #endif // GENERIC_CLI_H
\ No newline at end of file
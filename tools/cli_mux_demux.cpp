@@ -0,0 +1,146 @@
+/**
+ * Host-side demultiplexer for CLIMux
+ * 
+ * Splits the framed channel stream produced by CLIMux (src/cli_mux.h) back
+ * into its channels. The console channel is shown on stdout and, when
+ * talking to a serial device, keystrokes are framed back onto it, so the
+ * device CLI can be used interactively while other channels are captured.
+ * 
+ * Build (Linux/macOS):
+ *   g++ -std=c++17 -O2 -I../src -o cli_mux_demux cli_mux_demux.cpp ../src/cli_codec.cpp
+ * 
+ * Usage:
+ *   cli_mux_demux <device|capture-file|-> [--baud=115200] [--console=0] [--split=DIR]
+ * 
+ *   --console=N   channel shown on stdout and fed from stdin (default 0)
+ *   --split=DIR   write every other channel N to DIR/channel-N.bin
+ * 
+ * Press Ctrl-] to quit an interactive session.
+ */
+
+#include "cli_codec.h"
+#include "host_serial.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <device|capture-file|-> [--baud=115200] [--console=0] [--split=DIR]\n", argv[0]);
+        return 2;
+    }
+    
+    std::string path = argv[1];
+    long baud = 115200;
+    int console = 0;
+    std::string splitDir;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--baud=", 0) == 0) baud = atol(arg.c_str() + 7);
+        else if (arg.rfind("--console=", 0) == 0) console = atoi(arg.c_str() + 10);
+        else if (arg.rfind("--split=", 0) == 0) splitDir = arg.substr(8);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    
+    int link = (path == "-") ? STDIN_FILENO : open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (link < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), strerror(errno));
+        return 1;
+    }
+    
+    // A serial device is interactive: raw link, raw keyboard, keystrokes go to the console channel
+    bool interactive = isatty(link) && path != "-";
+    termios savedTerminal;
+    bool terminalSaved = false;
+    if (interactive) {
+        if (!makeRaw(link, baud, nullptr)) {
+            fprintf(stderr, "Cannot configure %s at %ld baud\n", path.c_str(), baud);
+            return 1;
+        }
+        if (isatty(STDIN_FILENO)) {
+            terminalSaved = makeRaw(STDIN_FILENO, 0, &savedTerminal);
+        }
+    }
+    
+    CLIFrameDecoder decoder;
+    std::map<int, FILE*> outputs;
+    std::map<int, unsigned long> byteCounts;
+    unsigned long frames = 0;
+    
+    uint8_t buffer[512];
+    bool done = false;
+    while (!done) {
+        pollfd fds[2] = { { link, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+        int count = interactive ? 2 : 1;
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n = read(link, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            for (ssize_t i = 0; i < n; i++) {
+                if (!decoder.feed(buffer[i])) continue;
+                
+                frames++;
+                int channel = decoder.channel();
+                byteCounts[channel] += decoder.length();
+                if (channel == console) {
+                    writeAll(STDOUT_FILENO, decoder.payload(), decoder.length());
+                } else if (!splitDir.empty()) {
+                    FILE*& out = outputs[channel];
+                    if (out == nullptr) {
+                        std::string file = splitDir + "/channel-" + std::to_string(channel) + ".bin";
+                        out = fopen(file.c_str(), "ab");
+                        if (out == nullptr) {
+                            fprintf(stderr, "Cannot open %s\r\n", file.c_str());
+                            continue;
+                        }
+                    }
+                    fwrite(decoder.payload(), 1, decoder.length(), out);
+                    fflush(out);
+                }
+            }
+        }
+        
+        if (interactive && (fds[1].revents & POLLIN)) {
+            ssize_t n = read(STDIN_FILENO, buffer, CLIFrame::MAX_PAYLOAD);
+            if (n <= 0) break;
+            for (ssize_t i = 0; i < n; i++) {
+                if (buffer[i] == 0x1D) { // Ctrl-]
+                    n = i;
+                    done = true;
+                    break;
+                }
+            }
+            if (n > 0) {
+                sendFrame(link, console, buffer, n);
+            }
+        }
+    }
+    
+    if (terminalSaved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+    }
+    for (auto& output : outputs) {
+        fclose(output.second);
+    }
+    
+    fprintf(stderr, "\n%lu frames, %lu CRC errors\n", frames, (unsigned long)decoder.crcErrors());
+    for (auto& entry : byteCounts) {
+        fprintf(stderr, "  channel %d: %lu bytes\n", entry.first, entry.second);
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * Host-side sender for the `ota` command
+ * 
+ * Uploads a firmware image to a device running GenericCLI with the
+ * transfer commands registered (src/cli_transfer_commands.h). The tool
+ * types the `ota` command itself, then streams the image as OTA frames
+ * (CLIOtaFrame in src/cli_codec.h), keeping several frames in flight and
+ * rewinding when the device reports a gap. The device verifies the
+ * SHA-256 announced here before committing the image.
+ * 
+ * Build (Linux/macOS):
+ *   g++ -std=c++17 -O2 -I../src -o cli_ota_send cli_ota_send.cpp ../src/cli_codec.cpp
+ * 
+ * Usage:
+ *   cli_ota_send <device> <image.bin> [--baud=115200] [--window=1] [--reboot] [--no-command]
+ * 
+ *   --window=N     frames in flight; passed to the device, which may need a
+ *                  larger receive buffer (Serial.setRxBufferSize) for N > 1
+ *   --reboot       restart the device once the image is committed
+ *   --no-command   do not type `ota`, the device is already waiting
+ */
+
+#include "cli_codec.h"
+#include "host_serial.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+
+static const int TIMEOUT_MS = 1000;
+static const int MAX_TIMEOUTS = 10;
+
+// Waits for the next frame from the device; text around frames (the
+// command echo, prompt) is skipped by the decoder
+static bool readFrame(int fd, CLIFrameDecoder& decoder, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint8_t byte;
+    while (true) {
+        int remaining = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) return false;
+        
+        pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, remaining) <= 0) continue;
+        if (read(fd, &byte, 1) != 1) return false;
+        if (decoder.feed(byte)) return true;
+    }
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <device> <image.bin> [--baud=115200] [--window=1] [--reboot] [--no-command]\n", argv[0]);
+        return 2;
+    }
+    
+    std::string devicePath = argv[1];
+    std::string imagePath = argv[2];
+    long baud = 115200;
+    int window = 1;
+    bool reboot = false;
+    bool typeCommand = true;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--baud=", 0) == 0) baud = atol(arg.c_str() + 7);
+        else if (arg.rfind("--window=", 0) == 0) window = atoi(arg.c_str() + 9);
+        else if (arg == "--reboot") reboot = true;
+        else if (arg == "--no-command") typeCommand = false;
+        else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (window < 1 || window > 32) {
+        fprintf(stderr, "--window must be between 1 and 32\n");
+        return 2;
+    }
+    
+    // Read the image and hash it up front; the BEGIN frame announces both
+    FILE* imageFile = fopen(imagePath.c_str(), "rb");
+    if (!imageFile) {
+        fprintf(stderr, "Cannot open %s: %s\n", imagePath.c_str(), strerror(errno));
+        return 1;
+    }
+    std::vector<uint8_t> image;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), imageFile)) > 0) {
+        image.insert(image.end(), chunk, chunk + n);
+    }
+    fclose(imageFile);
+    
+    uint8_t begin[CLIOtaFrame::OFFSET_SIZE + CLISha256::DIGEST_SIZE];
+    CLIOtaFrame::putU32(begin, (uint32_t)image.size());
+    CLISha256 sha;
+    sha.update(image.data(), image.size());
+    sha.finish(begin + CLIOtaFrame::OFFSET_SIZE);
+    
+    int link = open(devicePath.c_str(), O_RDWR | O_NOCTTY);
+    if (link < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", devicePath.c_str(), strerror(errno));
+        return 1;
+    }
+    if (isatty(link) && !makeRaw(link, baud, nullptr)) {
+        fprintf(stderr, "Cannot configure %s at %ld baud\n", devicePath.c_str(), baud);
+        return 1;
+    }
+    
+    if (typeCommand) {
+        std::string command = "ota --window=" + std::to_string(window) + (reboot ? " --reboot" : "") + "\r";
+        writeAll(link, (const uint8_t*)command.data(), command.size());
+    }
+    
+    CLIFrameDecoder decoder;
+    
+    // Handshake: repeat BEGIN until the device acknowledges offset 0
+    bool accepted = false;
+    for (int attempt = 0; attempt < MAX_TIMEOUTS && !accepted; attempt++) {
+        sendFrame(link, CLIOtaFrame::BEGIN, begin, sizeof(begin));
+        while (readFrame(link, decoder, TIMEOUT_MS)) {
+            if (decoder.channel() == CLIOtaFrame::ACK && decoder.length() > CLIOtaFrame::OFFSET_SIZE) {
+                window = std::min<int>(window, decoder.payload()[CLIOtaFrame::OFFSET_SIZE]);
+                accepted = true;
+                break;
+            }
+        }
+    }
+    if (!accepted) {
+        fprintf(stderr, "No response from device - is the transfer command registered?\n");
+        return 1;
+    }
+    
+    // Go-back-N: `acked` is what the device has committed to storage,
+    // `next` the first byte not yet sent
+    const size_t size = image.size();
+    size_t acked = 0;
+    size_t next = 0;
+    bool endPending = true;
+    int timeouts = 0;
+    uint8_t payload[CLIFrame::MAX_PAYLOAD];
+    auto start = std::chrono::steady_clock::now();
+    double lastReport = 0;
+    
+    while (true) {
+        while (next < size && next < acked + window * CLIOtaFrame::MAX_CHUNK) {
+            size_t length = std::min(CLIOtaFrame::MAX_CHUNK, size - next);
+            CLIOtaFrame::putU32(payload, (uint32_t)next);
+            memcpy(payload + CLIOtaFrame::OFFSET_SIZE, image.data() + next, length);
+            sendFrame(link, CLIOtaFrame::DATA, payload, (uint8_t)(CLIOtaFrame::OFFSET_SIZE + length));
+            next += length;
+        }
+        if (acked == size && endPending) {
+            sendFrame(link, CLIOtaFrame::END, nullptr, 0);
+            endPending = false;
+        }
+        
+        if (!readFrame(link, decoder, TIMEOUT_MS)) {
+            if (++timeouts > MAX_TIMEOUTS) {
+                fprintf(stderr, "\nDevice stopped responding at %zu of %zu bytes\n", acked, size);
+                return 1;
+            }
+            // Lost frames or ACKs: resend everything that is not acknowledged
+            next = acked;
+            endPending = true;
+            continue;
+        }
+        timeouts = 0;
+        
+        const uint8_t* frame = decoder.payload();
+        switch (decoder.channel()) {
+            case CLIOtaFrame::ACK:
+                if (decoder.length() >= CLIOtaFrame::OFFSET_SIZE) {
+                    acked = std::max<size_t>(acked, CLIOtaFrame::getU32(frame));
+                    next = std::max(next, acked);
+                }
+                break;
+                
+            case CLIOtaFrame::NAK:
+                if (decoder.length() >= CLIOtaFrame::OFFSET_SIZE) {
+                    acked = next = CLIOtaFrame::getU32(frame);
+                    endPending = true;
+                }
+                break;
+                
+            case CLIOtaFrame::DONE: {
+                double elapsed = secondsSince(start);
+                std::string message((const char*)frame + 1, decoder.length() > 0 ? decoder.length() - 1 : 0);
+                bool ok = decoder.length() > 0 && frame[0] == 0;
+                fprintf(stderr, "\n%s: %s (%zu bytes in %.1f s, %.1f KB/s)\n", ok ? "Done" : "Failed",
+                        message.c_str(), acked, elapsed, elapsed > 0 ? acked / 1024.0 / elapsed : 0.0);
+                return ok ? 0 : 1;
+            }
+                
+            default:
+                break;
+        }
+        
+        double elapsed = secondsSince(start);
+        if (elapsed - lastReport >= 0.25) {
+            lastReport = elapsed;
+            fprintf(stderr, "\r%zu/%zu bytes (%d%%) %.1f KB/s", acked, size,
+                    size ? (int)(acked * 100 / size) : 100, acked / 1024.0 / elapsed);
+        }
+    }
+}
@@ -0,0 +1,256 @@
+/**
+ * Host-side player for CLI session recordings
+ * 
+ * Reads a recording made with `session record` (CLISessionRecorder, fetch
+ * it with `sx`) and either prints it as a timed transcript or plays its
+ * input to a device over the serial port. During a replay the device
+ * output is compared byte by byte with the recorded output, and for every
+ * line sent the tool measures how long the device took to write the
+ * output that followed it in the recording.
+ * 
+ * The device should be at the prompt of the global mode, as it was when
+ * the recording started. Output before the first input (the prompt) and
+ * after the end of the recording is not compared.
+ * 
+ * Build (Linux/macOS):
+ *   g++ -std=c++17 -O2 -I../src -o cli_session cli_session.cpp ../src/cli_codec.cpp
+ * 
+ * Usage:
+ *   cli_session <recording> --dump
+ *   cli_session <recording> <device> [--baud=115200] [--speed=1]
+ * 
+ *   --speed=N   play the input N times faster than recorded (0 = no pauses)
+ */
+
+#include "cli_codec.h"
+#include "host_serial.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+
+static const int IDLE_TIMEOUT_MS = 1000;
+
+struct Record {
+    uint8_t kind;
+    uint32_t timeMs;            // From the start of the recording
+    std::vector<uint8_t> data;
+};
+
+static bool load(const char* path, std::vector<Record>& records) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    
+    if (bytes.size() < CLISessionFormat::HEADER_SIZE ||
+        memcmp(bytes.data(), CLISessionFormat::MAGIC, sizeof(CLISessionFormat::MAGIC)) != 0 ||
+        bytes[4] != CLISessionFormat::VERSION) {
+        fprintf(stderr, "%s is not a session recording\n", path);
+        return false;
+    }
+    
+    size_t used = CLISessionFormat::HEADER_SIZE;
+    uint32_t timeMs = 0;
+    while (used < bytes.size()) {
+        Record record;
+        uint32_t delta;
+        uint32_t length;
+        record.kind = bytes[used++];
+        size_t consumed = CLIVarint::get(bytes.data() + used, bytes.size() - used, &delta);
+        used += consumed;
+        size_t consumedLength = consumed > 0 ? CLIVarint::get(bytes.data() + used, bytes.size() - used, &length) : 0;
+        used += consumedLength;
+        if (consumed == 0 || consumedLength == 0 || length > bytes.size() - used) {
+            fprintf(stderr, "Recording truncated after %zu records\n", records.size());
+            return true;
+        }
+        timeMs += delta;
+        if (record.kind == CLISessionFormat::END) {
+            return true;
+        }
+        record.timeMs = timeMs;
+        record.data.assign(bytes.begin() + used, bytes.begin() + used + length);
+        records.push_back(record);
+        used += length;
+    }
+    fprintf(stderr, "Recording has no END record\n");
+    return true;
+}
+
+static void printEscaped(const std::vector<uint8_t>& data) {
+    for (uint8_t c : data) {
+        if (c == '\r') printf("\\r");
+        else if (c == '\n') printf("\\n");
+        else if (c == '\\') printf("\\\\");
+        else if (c < 0x20 || c >= 0x7F) printf("\\x%02X", c);
+        else putchar(c);
+    }
+}
+
+static void dump(const std::vector<Record>& records) {
+    size_t rx = 0;
+    size_t tx = 0;
+    for (const Record& record : records) {
+        bool input = record.kind == CLISessionFormat::RX;
+        printf("%8u ms  %s  ", record.timeMs, input ? "RX" : "TX");
+        printEscaped(record.data);
+        printf("\n");
+        (input ? rx : tx) += record.data.size();
+    }
+    printf("%zu records, %zu bytes in, %zu bytes out, %u ms\n", records.size(), rx, tx,
+           records.empty() ? 0 : records.back().timeMs);
+}
+
+static uint32_t nowMs() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <recording> --dump\n"
+                        "       %s <recording> <device> [--baud=115200] [--speed=1]\n", argv[0], argv[0]);
+        return 2;
+    }
+    
+    std::vector<Record> records;
+    if (!load(argv[1], records)) {
+        return 1;
+    }
+    if (std::string(argv[2]) == "--dump") {
+        dump(records);
+        return 0;
+    }
+    
+    long baud = 115200;
+    double speed = 1.0;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--baud=", 0) == 0) baud = atol(arg.c_str() + 7);
+        else if (arg.rfind("--speed=", 0) == 0) speed = atof(arg.c_str() + 8);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    
+    int link = open(argv[2], O_RDWR | O_NOCTTY);
+    if (link < 0 || !makeRaw(link, baud, nullptr)) {
+        fprintf(stderr, "Cannot open %s at %ld baud\n", argv[2], baud);
+        return 1;
+    }
+    
+    // Expected output from the first input on; after each input record,
+    // the output offset the recording had reached before the next one
+    std::vector<uint8_t> expected;
+    std::vector<const Record*> inputs;
+    std::vector<size_t> reached;
+    for (const Record& record : records) {
+        if (record.kind == CLISessionFormat::RX) {
+            if (!inputs.empty()) reached.push_back(expected.size());
+            inputs.push_back(&record);
+        } else if (!inputs.empty()) {
+            expected.insert(expected.end(), record.data.begin(), record.data.end());
+        }
+    }
+    if (inputs.empty()) {
+        fprintf(stderr, "Recording has no input\n");
+        return 1;
+    }
+    reached.push_back(expected.size());
+    
+    tcflush(link, TCIFLUSH);
+    std::vector<uint8_t> received;
+    std::vector<uint32_t> latencies;
+    uint32_t firstMs = inputs[0]->timeMs;
+    uint32_t startMs = nowMs();
+    size_t next = 0;            // Input record to send
+    size_t waiting = 0;         // Oldest line still waiting for its output
+    std::vector<uint32_t> sentMs(inputs.size(), 0);
+    uint32_t lastActivity = startMs;
+    
+    while (true) {
+        uint32_t now = nowMs();
+        if (next < inputs.size()) {
+            uint32_t dueMs = speed > 0 ? (uint32_t)((inputs[next]->timeMs - firstMs) / speed) : 0;
+            if (now - startMs >= dueMs) {
+                writeAll(link, inputs[next]->data.data(), inputs[next]->data.size());
+                sentMs[next++] = now;
+                lastActivity = now;
+                continue;
+            }
+        } else if (now - lastActivity >= (uint32_t)IDLE_TIMEOUT_MS) {
+            break;
+        }
+        
+        pollfd pfd = { link, POLLIN, 0 };
+        if (poll(&pfd, 1, 1) > 0) {
+            uint8_t buffer[1024];
+            ssize_t n = read(link, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            received.insert(received.end(), buffer, buffer + n);
+            lastActivity = nowMs();
+        }
+        
+        // A line's latency ends when the output recorded after it is complete
+        while (waiting < next && received.size() >= reached[waiting]) {
+            const std::vector<uint8_t>& data = inputs[waiting]->data;
+            if (std::find(data.begin(), data.end(), '\r') != data.end() ||
+                std::find(data.begin(), data.end(), '\n') != data.end()) {
+                latencies.push_back(nowMs() - sentMs[waiting]);
+            }
+            waiting++;
+        }
+    }
+    
+    size_t compared = std::min(received.size(), expected.size());
+    size_t mismatches = 0;
+    size_t firstMismatch = 0;
+    for (size_t i = 0; i < compared; i++) {
+        if (received[i] != expected[i] && mismatches++ == 0) {
+            firstMismatch = i;
+        }
+    }
+    
+    size_t sent = 0;
+    for (const Record* input : inputs) {
+        sent += input->data.size();
+    }
+    fprintf(stderr, "%zu input bytes sent, %zu of %zu output bytes received\n",
+            sent, received.size(), expected.size());
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        uint64_t total = 0;
+        for (uint32_t latency : latencies) total += latency;
+        fprintf(stderr, "Line latency: min %u ms, mean %.1f ms, max %u ms over %zu lines\n",
+                latencies.front(), (double)total / latencies.size(), latencies.back(), latencies.size());
+    }
+    
+    if (mismatches == 0 && received.size() >= expected.size()) {
+        fprintf(stderr, "Output matches the recording\n");
+        return 0;
+    }
+    if (mismatches > 0) {
+        fprintf(stderr, "%zu byte(s) differ, first at offset %zu\n", mismatches, firstMismatch);
+    }
+    if (received.size() < expected.size()) {
+        fprintf(stderr, "%zu byte(s) of output missing\n", expected.size() - received.size());
+    }
+    return 1;
+}
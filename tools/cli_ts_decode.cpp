@@ -0,0 +1,206 @@
+/**
+ * Host-side decoder for binary time-series exports
+ * 
+ * Turns the frames written by CLITimeSeries::exportBinary() (for example
+ * `ts export sensors --binary`) back into CSV on stdout. The input is a
+ * serial device, a capture file or stdin; text around the frames (command
+ * echo, prompt) is skipped. Every DATA frame is decoded on its own, so a
+ * frame that fails its CRC costs only the samples it carried, which are
+ * reported on stderr.
+ * 
+ * Build (Linux/macOS):
+ *   g++ -std=c++17 -O2 -I../src -o cli_ts_decode cli_ts_decode.cpp ../src/cli_codec.cpp
+ * 
+ * Usage:
+ *   cli_ts_decode <device|capture-file|-> [--baud=115200] [--command="ts export sensors --binary"]
+ * 
+ *   --command=TEXT   type TEXT into the device CLI first (serial devices only)
+ */
+
+#include "cli_codec.h"
+#include "host_serial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+
+static const int IDLE_TIMEOUT_MS = 5000;
+
+struct Channel {
+    std::string name;
+    uint8_t decimals;
+    double scale;
+};
+
+static std::vector<Channel> channels;
+static uint32_t announced = 0;
+static uint32_t decoded = 0;
+
+static bool decodeHeader(const uint8_t* frame, size_t length) {
+    if (length < 6 || frame[0] != CLISeriesFrame::VERSION) {
+        fprintf(stderr, "Unsupported header (version %u)\n", length > 0 ? frame[0] : 0);
+        return false;
+    }
+    
+    channels.clear();
+    uint8_t count = frame[1];
+    announced = CLIOtaFrame::getU32(frame + 2);
+    size_t used = 6;
+    for (uint8_t i = 0; i < count; i++) {
+        if (used + 2 > length || used + 2 + frame[used + 1] > length) {
+            fprintf(stderr, "Truncated header\n");
+            return false;
+        }
+        Channel channel;
+        channel.decimals = std::min(frame[used], CLISeriesFrame::MAX_DECIMALS);
+        channel.name.assign((const char*)frame + used + 2, frame[used + 1]);
+        if (channel.name.empty()) {
+            channel.name = "ch" + std::to_string(i);
+        }
+        channel.scale = std::pow(10.0, channel.decimals);
+        channels.push_back(channel);
+        used += 2 + frame[used + 1];
+    }
+    
+    printf("timestamp");
+    for (const Channel& channel : channels) {
+        printf(",%s", channel.name.c_str());
+    }
+    printf("\n");
+    return true;
+}
+
+static bool decodeData(const uint8_t* frame, size_t length) {
+    if (length < 1 || channels.empty()) {
+        return false;
+    }
+    
+    uint8_t samples = frame[0];
+    size_t used = 1;
+    uint32_t timestamp = 0;
+    std::vector<int32_t> values(channels.size(), 0);
+    
+    for (uint8_t sample = 0; sample < samples; sample++) {
+        uint32_t value;
+        size_t consumed = CLIVarint::get(frame + used, length - used, &value);
+        if (consumed == 0) return false;
+        used += consumed;
+        timestamp += value;
+        
+        for (size_t i = 0; i < channels.size(); i++) {
+            consumed = CLIVarint::get(frame + used, length - used, &value);
+            if (consumed == 0) return false;
+            used += consumed;
+            values[i] = (int32_t)((uint32_t)values[i] + (uint32_t)CLIVarint::unzigzag(value));
+        }
+        
+        printf("%u", timestamp);
+        for (size_t i = 0; i < channels.size(); i++) {
+            printf(",%.*f", channels[i].decimals, values[i] / channels[i].scale);
+        }
+        printf("\n");
+        decoded++;
+    }
+    return used == length;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <device|capture-file|-> [--baud=115200] [--command=TEXT]\n", argv[0]);
+        return 2;
+    }
+    
+    std::string path = argv[1];
+    long baud = 115200;
+    std::string command;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--baud=", 0) == 0) baud = atol(arg.c_str() + 7);
+        else if (arg.rfind("--command=", 0) == 0) command = arg.substr(10);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    
+    int link = (path == "-") ? STDIN_FILENO : open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (link < 0) {
+        fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), strerror(errno));
+        return 1;
+    }
+    bool device = isatty(link);
+    if (device && !makeRaw(link, baud, nullptr)) {
+        fprintf(stderr, "Cannot configure %s at %ld baud\n", path.c_str(), baud);
+        return 1;
+    }
+    if (!command.empty()) {
+        if (!device) {
+            fprintf(stderr, "--command needs a serial device\n");
+            return 2;
+        }
+        command += "\r";
+        writeAll(link, (const uint8_t*)command.data(), command.size());
+    }
+    
+    CLIFrameDecoder decoder;
+    size_t bytes = 0;
+    size_t badFrames = 0;
+    bool haveHeader = false;
+    bool ended = false;
+    uint8_t buffer[4096];
+    
+    while (!ended) {
+        if (device) {
+            pollfd pfd = { link, POLLIN, 0 };
+            if (poll(&pfd, 1, IDLE_TIMEOUT_MS) <= 0) {
+                fprintf(stderr, "No data for %d s\n", IDLE_TIMEOUT_MS / 1000);
+                break;
+            }
+        }
+        ssize_t n = read(link, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        
+        for (ssize_t i = 0; i < n && !ended; i++) {
+            if (haveHeader) bytes++;
+            if (!decoder.feed(buffer[i])) continue;
+            
+            switch (decoder.channel()) {
+                case CLISeriesFrame::HEADER:
+                    haveHeader = decodeHeader(decoder.payload(), decoder.length());
+                    bytes = CLIFrame::HEADER_SIZE + decoder.length() + CLIFrame::CRC_SIZE;
+                    break;
+                
+                case CLISeriesFrame::DATA:
+                    if (haveHeader && !decodeData(decoder.payload(), decoder.length())) {
+                        badFrames++;
+                    }
+                    break;
+                
+                case CLISeriesFrame::END:
+                    ended = haveHeader;
+                    break;
+            }
+        }
+    }
+    
+    fflush(stdout);
+    if (!haveHeader) {
+        fprintf(stderr, "No time-series header found\n");
+        return 1;
+    }
+    
+    badFrames += decoder.crcErrors();
+    fprintf(stderr, "%u of %u samples, %zu bytes (%.1f per sample)%s\n", decoded, announced, bytes,
+            decoded > 0 ? (double)bytes / decoded : 0.0, ended ? "" : ", no END frame");
+    if (badFrames > 0) {
+        fprintf(stderr, "%zu damaged frame(s) skipped\n", badFrames);
+    }
+    return (ended && decoded == announced) ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/**
+ * Counting operator new/delete for the fuzz targets
+ * 
+ * Every block carries its size and the Allocations::reset() generation it
+ * was counted in (0 when it was allocated outside a Scope), so freeing a
+ * block only takes back what was counted for it in the current input.
+ * Blocks stay malloc'ed, which keeps ASan's checks on them.
+ */
+
+#include "cli_fuzz.h"
+
+#include <cstddef>
+
+#include <new>
+
+namespace {
+
+struct alignas(std::max_align_t) Header {
+    size_t size;
+    unsigned long generation;
+};
+
+unsigned long generation = 1;
+bool counting = false;
+size_t liveBytes = 0;
+size_t peakBytes = 0;
+
+void* allocate(size_t size) {
+    Header* header = (Header*)malloc(sizeof(Header) + size);
+    if (header == nullptr) {
+        return nullptr;
+    }
+    header->size = size;
+    header->generation = counting ? generation : 0;
+    if (counting) {
+        liveBytes += size;
+        peakBytes = std::max(peakBytes, liveBytes);
+    }
+    return header + 1;
+}
+
+void release(void* pointer) {
+    if (pointer == nullptr) {
+        return;
+    }
+    Header* header = (Header*)pointer - 1;
+    if (header->generation == generation) {
+        liveBytes -= header->size;
+    }
+    free(header);
+}
+
+void* allocateOrThrow(size_t size) {
+    void* pointer = allocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+}
+
+namespace CLIFuzz {
+
+Allocations::Scope::Scope(bool count) : outer(counting) {
+    counting = count;
+}
+
+Allocations::Scope::~Scope() {
+    counting = outer;
+}
+
+void Allocations::reset() {
+    generation++;
+    liveBytes = 0;
+    peakBytes = 0;
+}
+
+size_t Allocations::live() {
+    return liveBytes;
+}
+
+size_t Allocations::peak() {
+    return peakBytes;
+}
+
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void operator delete(void* pointer) noexcept { release(pointer); }
+void operator delete[](void* pointer) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
@@ -0,0 +1,92 @@
+#ifndef CLI_FUZZ_H
+#define CLI_FUZZ_H
+
+/**
+ * Shared pieces of the fuzz targets
+ * 
+ * CLIFuzz::Probe is a friend of GenericCLI (see generic_cli.h) and gives
+ * the targets the decoder state they check after every byte. FUZZ_CHECK
+ * prints the broken invariant and aborts, which libFuzzer and the
+ * standalone driver both report as a crash with the input saved.
+ * CLIFuzz::Allocations counts the heap the CLI holds on to (allocations.cpp
+ * replaces operator new/delete), for checks that it stays bounded.
+ */
+
+#include "generic_cli.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#define FUZZ_CHECK(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "Invariant failed: %s\n  ", #condition); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            abort(); \
+        } \
+    } while (0)
+
+namespace CLIFuzz {
+
+class Probe {
+public:
+    static CLIArgs parse(GenericCLI& cli, const String& input) { return cli.parseArguments(input); }
+    static void input(GenericCLI& cli, char c) { cli.processInput(c); }
+    
+    static const String& line(const GenericCLI& cli) { return cli.inputBuffer; }
+    static size_t cursor(const GenericCLI& cli) { return cli.cursorPos; }
+    static bool discarding(const GenericCLI& cli) { return cli.discardingInput; }
+    static bool inEscape(const GenericCLI& cli) { return cli.escapeState != GenericCLI::EscapeState::NONE; }
+    static size_t escapeLength(const GenericCLI& cli) { return cli.escapeLength; }
+    static size_t escapeCapacity(const GenericCLI& cli) { return sizeof(cli.escapeParams); }
+    static bool inHistory(const GenericCLI& cli) { return cli.inHistoryMode; }
+    static int historyIndex(const GenericCLI& cli) { return cli.historyIndex; }
+    static size_t historySize(const GenericCLI& cli) { return cli.commandHistory.size(); }
+};
+
+// Bytes allocated with new while a counting Scope is open and not freed
+// yet, since the last reset(). The harness keeps its own allocations out:
+// they happen outside a Scope or in a Scope(false)
+class Allocations {
+public:
+    class Scope {
+    public:
+        explicit Scope(bool count = true);
+        ~Scope();
+    
+    private:
+        bool outer;
+    };
+    
+    static void reset();
+    static size_t live();
+    static size_t peak();
+};
+
+// Collects the CLI output for checks on the escape sequences it writes
+class OutputSink : public Stream {
+public:
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t value) override {
+        Allocations::Scope uncounted(false);
+        text += (char)value;
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        Allocations::Scope uncounted(false);
+        text.append((const char*)buffer, size);
+        return size;
+    }
+    using Print::write;
+    
+    std::string text;
+};
+
+}
+
+#endif // CLI_FUZZ_H
@@ -0,0 +1,69 @@
+/**
+ * Fuzz target for GenericCLI::parseArguments
+ * 
+ * Invariants:
+ *   - no flag has an empty name, or a name containing ' ' or '='
+ *   - no positional argument is empty
+ *   - without quotes in the input, no positional contains a space, and
+ *     printing the result back as "pos ... --name=value ..." and parsing
+ *     that again gives the same arguments
+ *   - the heap in use while parsing peaks at most BYTES_PER_INPUT_BYTE
+ *     per input byte (plus a constant)
+ * 
+ * See tools/README.md for building with libFuzzer or the standalone driver.
+ */
+
+#include "cli_fuzz.h"
+
+using CLIFuzz::Probe;
+
+// Parsing allocates a String per argument (32 bytes on the host) and at
+// least two input bytes make one, with vector growth holding the old and
+// the new array at once: about 25 bytes per input byte at worst
+static const size_t BYTES_PER_INPUT_BYTE = 48;
+
+static String canonical(const CLIArgs& args) {
+    String line;
+    for (const String& value : args.positional) {
+        line += value;
+        line += ' ';
+    }
+    for (const auto& flag : args.flags) {
+        line += "--" + flag.first + "=" + flag.second + " ";
+    }
+    return line;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static GenericCLI cli;
+    
+    String input((const char*)data, size);
+    bool quoted = memchr(data, '"', size) != nullptr;
+    CLIFuzz::Allocations::reset();
+    CLIArgs args;
+    {
+        CLIFuzz::Allocations::Scope counted;
+        args = Probe::parse(cli, input);
+    }
+    FUZZ_CHECK(CLIFuzz::Allocations::peak() <= BYTES_PER_INPUT_BYTE * size + 1024,
+               "%zu bytes at the peak for %zu input bytes", CLIFuzz::Allocations::peak(), size);
+    
+    for (const auto& flag : args.flags) {
+        FUZZ_CHECK(!flag.first.isEmpty(), "input [%s]", input.c_str());
+        FUZZ_CHECK(flag.first.indexOf(' ') < 0 && flag.first.indexOf('=') < 0,
+                   "flag [%s] in input [%s]", flag.first.c_str(), input.c_str());
+    }
+    for (const String& value : args.positional) {
+        FUZZ_CHECK(!value.isEmpty(), "input [%s]", input.c_str());
+        FUZZ_CHECK(quoted || value.indexOf(' ') < 0,
+                   "positional [%s] in input [%s]", value.c_str(), input.c_str());
+    }
+    
+    if (!quoted) {
+        String line = canonical(args);
+        CLIArgs again = Probe::parse(cli, line);
+        FUZZ_CHECK(again.positional == args.positional && again.flags == args.flags,
+                   "input [%s] printed as [%s]", input.c_str(), line.c_str());
+    }
+    return 0;
+}
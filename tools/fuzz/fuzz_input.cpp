@@ -0,0 +1,159 @@
+/**
+ * Fuzz target for the GenericCLI input decoder (processInput)
+ * 
+ * The input is typed into a CLI with echo on, a short line limit, a few
+ * commands for Tab completion and history to work with, and the built-in
+ * commands. After every byte:
+ *   - the cursor is within the input line
+ *   - the line is no longer than maxLineLength, and empty while input is
+ *     being discarded
+ *   - an escape sequence holds at most one byte more than escapeParams
+ *     (the marker for "too long")
+ *   - in history mode the history index is within the history
+ *   - the heap allocated while typing and not freed stays under
+ *     ALLOCATION_LIMIT, however long the input
+ *   - the terminal shows the line with the cursor where the decoder has
+ *     it: a small terminal model replays the output, and the line must
+ *     start cursorPos columns left of its cursor with only blanks after it
+ * At the end, the output contains no zero-length cursor move ("\033[0D",
+ * "\033[0C"), which terminals treat as a move of one column.
+ * 
+ * See tools/README.md for building with libFuzzer or the standalone driver.
+ */
+
+#include "cli_fuzz.h"
+
+using CLIFuzz::Probe;
+
+static const size_t MAX_LINE = 48;
+// Heap the CLI may hold on to between bytes: the line and history are
+// capped, so this does not grow with the input (about 200 bytes in use)
+static const size_t ALLOCATION_LIMIT = 4096;
+
+// The current row of a terminal, enough of VT100 for what the CLI writes
+class Terminal {
+public:
+    void feed(const std::string& output, size_t from) {
+        for (size_t i = from; i < output.size(); i++) {
+            feed((uint8_t)output[i]);
+        }
+    }
+    
+    const std::string& row() const { return text; }
+    size_t column() const { return col; }
+
+private:
+    void feed(uint8_t c) {
+        if (state == ESCAPE) {
+            state = (c == '[') ? CSI : TEXT;
+            count = 0;
+            return;
+        }
+        if (state == CSI) {
+            if (c >= '0' && c <= '9') {
+                count = std::min<size_t>(count * 10 + (c - '0'), 100000);
+            } else if (c >= 0x40 && c <= 0x7E) {
+                control(c);
+                state = TEXT;
+            }
+            return;
+        }
+        if (c == 0x1B) {
+            state = ESCAPE;
+        } else if (c == '\r') {
+            col = 0;
+        } else if (c == '\n') {
+            text.clear();
+            col = 0;
+        } else if (c == '\b') {
+            col -= (col > 0);
+        } else if (c >= 0x20) {
+            if (col >= text.size()) {
+                text.resize(col + 1, ' ');
+            }
+            text[col++] = c;
+        }
+    }
+    
+    void control(uint8_t c) {
+        size_t n = count > 0 ? count : 1;
+        switch (c) {
+            case 'C': col += n; break;
+            case 'D': col -= std::min(col, n); break;
+            case 'K': if (col < text.size()) text.resize(col); break;
+            case 'J': text.clear(); break;
+            case 'H': col = 0; break;
+            default: break;     // Colors
+        }
+    }
+    
+    enum { TEXT, ESCAPE, CSI } state = TEXT;
+    std::string text;
+    size_t col = 0;
+    size_t count = 0;
+};
+
+static void checkArgs(const CLIArgs& args) {
+    for (const auto& flag : args.flags) {
+        FUZZ_CHECK(!flag.first.isEmpty(), "empty flag name");
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    CLIFuzz::OutputSink output;
+    CLIConfig config;
+    config.stream = &output;
+    config.baudRate = 0;
+    config.colorsEnabled = (size > 0 && (data[0] & 1));
+    config.maxLineLength = MAX_LINE;
+    config.historySize = 4;
+    config.welcomeMessage = "";
+    
+    GenericCLI cli(config);
+    cli.registerCommand("set", "Set a value", "set <name> [--value=X]", checkArgs);
+    cli.registerCommand("settings", "Show values", "settings", checkArgs);
+    cli.registerCommand("status", "Show status", "status", checkArgs);
+    
+    Terminal terminal;
+    CLIFuzz::Allocations::reset();
+    for (size_t i = 0; i < size; i++) {
+        size_t written = output.text.size();
+        {
+            CLIFuzz::Allocations::Scope counted;
+            Probe::input(cli, (char)data[i]);
+        }
+        terminal.feed(output.text, written);
+        
+        size_t length = Probe::line(cli).length();
+        FUZZ_CHECK(Probe::cursor(cli) <= length, "cursor %zu, line %zu, byte %zu",
+                   Probe::cursor(cli), length, i);
+        FUZZ_CHECK(length <= MAX_LINE, "line %zu, byte %zu", length, i);
+        FUZZ_CHECK(!Probe::discarding(cli) || length == 0, "line %zu while discarding, byte %zu", length, i);
+        FUZZ_CHECK(!Probe::inEscape(cli) || Probe::escapeLength(cli) <= Probe::escapeCapacity(cli) + 1,
+                   "escape length %zu, byte %zu", Probe::escapeLength(cli), i);
+        FUZZ_CHECK(CLIFuzz::Allocations::live() <= ALLOCATION_LIMIT, "%zu bytes held, byte %zu",
+                   CLIFuzz::Allocations::live(), i);
+        FUZZ_CHECK(!Probe::inHistory(cli) ||
+                   (Probe::historyIndex(cli) >= 0 && (size_t)Probe::historyIndex(cli) <= Probe::historySize(cli)),
+                   "history index %d of %zu, byte %zu", Probe::historyIndex(cli), Probe::historySize(cli), i);
+        
+        if (!Probe::discarding(cli) && !Probe::inEscape(cli)) {
+            const String& line = Probe::line(cli);
+            std::string row = terminal.row();
+            size_t column = terminal.column();
+            bool shown = column >= Probe::cursor(cli);
+            if (shown) {
+                size_t start = column - Probe::cursor(cli);
+                row.resize(std::max(row.size(), start + length), ' ');
+                shown = row.compare(start, length, line.c_str()) == 0 &&
+                        row.find_first_not_of(' ', start + length) == std::string::npos;
+            }
+            FUZZ_CHECK(shown, "row [%s] column %zu, line [%s] cursor %zu, byte %zu",
+                       terminal.row().c_str(), column, line.c_str(), Probe::cursor(cli), i);
+        }
+    }
+    
+    FUZZ_CHECK(output.text.find("\033[0D") == std::string::npos, "zero cursor move left");
+    FUZZ_CHECK(output.text.find("\033[0C") == std::string::npos, "zero cursor move right");
+    return 0;
+}
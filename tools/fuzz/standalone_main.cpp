@@ -0,0 +1,168 @@
+/**
+ * Driver for the fuzz targets without libFuzzer
+ * 
+ * Runs a target on files and on every file in directories, like a
+ * libFuzzer binary does to reproduce a crash or check a corpus. With
+ * --runs=N it then runs N random mutations of those inputs (byte flips,
+ * insertions, deletions and splices, seeded by --seed), which finds the
+ * shallow bugs on a compiler without -fsanitize=fuzzer (gcc).
+ * 
+ * Usage:
+ *   fuzz_input corpus/input [--runs=100000] [--seed=1] [--max-len=256]
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+typedef std::vector<uint8_t> Input;
+
+static const Input* current = nullptr;
+
+// Saves the input that failed to ./crash-input before dying
+static void onCrash(int signal) {
+    if (current != nullptr) {
+        int file = open("crash-input", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file >= 0) {
+            ssize_t written = write(file, current->data(), current->size());
+            (void)written;
+            close(file);
+        }
+        static const char message[] = "Input saved to crash-input\n";
+        ssize_t written = write(2, message, sizeof(message) - 1);
+        (void)written;
+    }
+    ::signal(signal, SIG_DFL);
+    raise(signal);
+}
+
+static bool readFile(const std::string& path, Input& input) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        input.insert(input.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static void collect(const std::string& path, std::vector<Input>& inputs) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        exit(2);
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        Input input;
+        if (readFile(path, input)) {
+            inputs.push_back(input);
+        }
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            collect(path + "/" + entry->d_name, inputs);
+        }
+    }
+    closedir(dir);
+}
+
+static void mutate(Input& input, const std::vector<Input>& corpus, std::mt19937& rng, size_t maxLength) {
+    size_t edits = 1 + rng() % 4;
+    for (size_t i = 0; i < edits; i++) {
+        size_t at = input.empty() ? 0 : rng() % (input.size() + 1);
+        switch (rng() % 5) {
+            case 0:     // Flip a bit
+                if (at < input.size()) input[at] ^= 1 << (rng() % 8);
+                break;
+            case 1:     // Insert a random byte, biased towards the decoder's special ones
+            {
+                static const uint8_t special[] = { '\r', '\n', '\b', 127, '\t', 27, '[', 'O', '"', '-', '=', ' ', '~', '3' };
+                uint8_t value = (rng() % 2) ? special[rng() % sizeof(special)] : (uint8_t)rng();
+                input.insert(input.begin() + at, value);
+                break;
+            }
+            case 2:     // Delete a run
+                if (at < input.size()) {
+                    size_t count = std::min<size_t>(1 + rng() % 8, input.size() - at);
+                    input.erase(input.begin() + at, input.begin() + at + count);
+                }
+                break;
+            case 3:     // Duplicate a run
+                if (at < input.size()) {
+                    size_t count = std::min<size_t>(1 + rng() % 16, input.size() - at);
+                    Input run(input.begin() + at, input.begin() + at + count);
+                    input.insert(input.begin() + at, run.begin(), run.end());
+                }
+                break;
+            default:    // Splice in part of another input
+            {
+                const Input& other = corpus[rng() % corpus.size()];
+                if (!other.empty()) {
+                    size_t from = rng() % other.size();
+                    size_t count = std::min<size_t>(1 + rng() % 32, other.size() - from);
+                    input.insert(input.begin() + at, other.begin() + from, other.begin() + from + count);
+                }
+                break;
+            }
+        }
+    }
+    if (input.size() > maxLength) {
+        input.resize(maxLength);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<Input> corpus;
+    unsigned long runs = 0;
+    unsigned long seed = 1;
+    size_t maxLength = 256;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--runs=", 7) == 0) runs = strtoul(argv[i] + 7, nullptr, 10);
+        else if (strncmp(argv[i], "--seed=", 7) == 0) seed = strtoul(argv[i] + 7, nullptr, 10);
+        else if (strncmp(argv[i], "--max-len=", 10) == 0) maxLength = strtoul(argv[i] + 10, nullptr, 10);
+        else collect(argv[i], corpus);
+    }
+    if (corpus.empty()) {
+        corpus.push_back(Input());
+    }
+    
+    signal(SIGABRT, onCrash);
+    signal(SIGSEGV, onCrash);
+    
+    for (const Input& input : corpus) {
+        current = &input;
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    printf("%zu inputs passed\n", corpus.size());
+    
+    std::mt19937 rng(seed);
+    for (unsigned long run = 0; run < runs; run++) {
+        Input input = corpus[rng() % corpus.size()];
+        mutate(input, corpus, rng, maxLength);
+        current = &input;
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    if (runs > 0) {
+        printf("%lu mutations passed (seed %lu)\n", runs, seed);
+    }
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ========================================================================
+// STRING
+// ========================================================================
+
+static std::string formatNumber(unsigned long long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    char digits[66];
+    char* end = digits + sizeof(digits);
+    char* start = end;
+    do {
+        unsigned digit = value % base;
+        *--start = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    if (negative) {
+        *--start = '-';
+    }
+    return std::string(start, end);
+}
+
+// Like the ESP32 core: negative numbers are signed only in base 10
+static std::string formatSigned(long long value, unsigned char base, unsigned long long mask) {
+    if (base == 10) {
+        bool negative = value < 0;
+        return formatNumber(negative ? 0 - (unsigned long long)value : value, negative, base);
+    }
+    return formatNumber((unsigned long long)value & mask, false, base);
+}
+
+String::String(unsigned char number, unsigned char base) : value(formatNumber(number, false, base)) {}
+String::String(int number, unsigned char base) : value(formatSigned(number, base, 0xFFFFFFFFull)) {}
+String::String(unsigned int number, unsigned char base) : value(formatNumber(number, false, base)) {}
+String::String(long number, unsigned char base) : value(formatSigned(number, base, ~0ul)) {}
+String::String(unsigned long number, unsigned char base) : value(formatNumber(number, false, base)) {}
+String::String(long long number, unsigned char base) : value(formatSigned(number, base, ~0ull)) {}
+String::String(unsigned long long number, unsigned char base) : value(formatNumber(number, false, base)) {}
+
+String::String(float number, unsigned int decimals) : String((double)number, decimals) {}
+
+String::String(double number, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)std::min(decimals, 20u), number);
+    value = buffer;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= value.size()) {
+        dummy = 0;
+        return dummy;
+    }
+    return value[index];
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (value.size() != other.value.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < value.size(); i++) {
+        if (tolower((unsigned char)value[i]) != tolower((unsigned char)other.value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        std::swap(from, to);
+    }
+    if (from >= value.size()) {
+        return String();
+    }
+    to = std::min<unsigned int>(to, value.size());
+    return String(value.substr(from, to - from));
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= value.size()) {
+        return;
+    }
+    value.erase(index, std::min<size_t>(count, value.size() - index));
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.value.empty()) {
+        return;
+    }
+    size_t at = 0;
+    while ((at = value.find(find.value, at)) != std::string::npos) {
+        value.replace(at, find.value.size(), replacement.value);
+        at += replacement.value.size();
+    }
+}
+
+void String::replace(char find, char replacement) {
+    std::replace(value.begin(), value.end(), find, replacement);
+}
+
+void String::toLowerCase() {
+    for (char& c : value) {
+        c = tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase() {
+    for (char& c : value) {
+        c = toupper((unsigned char)c);
+    }
+}
+
+void String::trim() {
+    size_t start = 0;
+    while (start < value.size() && isspace((unsigned char)value[start])) {
+        start++;
+    }
+    size_t end = value.size();
+    while (end > start && isspace((unsigned char)value[end - 1])) {
+        end--;
+    }
+    value = value.substr(start, end - start);
+}
+
+// ========================================================================
+// PRINT / STREAM
+// ========================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size-- > 0) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    if ((size_t)length < sizeof(buffer)) {
+        return write((const uint8_t*)buffer, length);
+    }
+    std::string large(length + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&large[0], large.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)large.data(), length);
+}
+
+size_t Print::printSigned(long long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Print::printUnsigned(unsigned long long value, int base) {
+    return print(String(value, (unsigned char)base));
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length) {
+        int c = read();
+        if (c < 0) {
+            if (millis() - start >= timeout) {
+                break;
+            }
+            yield();
+            continue;
+        }
+        buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t, int8_t, int8_t) {
+    speed = baud;
+}
+
+// ========================================================================
+// TIME
+// ========================================================================
+
+static const auto startTime = std::chrono::steady_clock::now();
+static bool manualClock = false;
+static unsigned long long manualMicros = 0;
+
+static unsigned long long hostMicros() {
+    if (manualClock) {
+        return manualMicros;
+    }
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - startTime).count();
+}
+
+unsigned long millis() {
+    return (unsigned long)(hostMicros() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)hostMicros();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(hostMicros() * 240);
+}
+
+void delay(unsigned long ms) {
+    if (manualClock) {
+        manualMicros += ms * 1000ull;
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (manualClock) {
+        manualMicros += us;
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void yield() {
+    // A manual clock must still move, or timeouts polled with yield() never expire
+    if (manualClock) {
+        manualMicros += 1000;
+    }
+}
+
+void hostSetManualClock(bool manual) {
+    if (manual && !manualClock) {
+        manualMicros = hostMicros();
+    }
+    manualClock = manual;
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+    manualMicros += ms * 1000ull;
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + rand() % (max - min) : min;
+}
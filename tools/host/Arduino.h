@@ -0,0 +1,235 @@
+#ifndef CLI_HOST_ARDUINO_H
+#define CLI_HOST_ARDUINO_H
+
+/**
+ * Minimal Arduino core for host builds
+ * 
+ * Just enough of String, Print, Stream, Serial and the timing functions to
+ * build the platform independent parts of the library (generic_cli.cpp,
+ * cli_codec.cpp, cli_ymodem.cpp) on Linux/macOS for the fuzz targets and
+ * host tests in tools/. Behaviour follows the ESP32 Arduino core where it
+ * matters to the library: indexOf() returns -1, substring() and remove()
+ * clamp out of range arguments, operator[] out of range reads 0.
+ * 
+ * Serial keeps its input and output in memory: tests queue input with
+ * Serial.feed() and inspect Serial.output(). millis() follows the host
+ * clock unless hostSetManualClock() freezes it, after which only delay()
+ * and hostAdvanceMillis() move it.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define SERIAL_8N1 0x800001c
+#define IRAM_ATTR
+#define PROGMEM
+#define F(text) text
+
+using std::min;
+using std::max;
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text != nullptr ? text : "") {}
+    String(const char* text, size_t length) : value(text, length) {}
+    String(const std::string& text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+    
+    unsigned int length() const { return value.size(); }
+    const char* c_str() const { return value.c_str(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+    
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    void setCharAt(unsigned int index, char c) { if (index < value.size()) value[index] = c; }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char& operator[](unsigned int index);
+    
+    bool concat(const String& text) { value += text.value; return true; }
+    bool concat(const char* text) { if (text != nullptr) value += text; return text != nullptr; }
+    bool concat(const char* text, unsigned int length) { value.append(text, length); return true; }
+    bool concat(char c) { value += c; return true; }
+    String& operator+=(const String& text) { concat(text); return *this; }
+    String& operator+=(const char* text) { concat(text); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    String& operator+=(int number) { return *this += String(number); }
+    String& operator+=(unsigned int number) { return *this += String(number); }
+    String& operator+=(long number) { return *this += String(number); }
+    String& operator+=(unsigned long number) { return *this += String(number); }
+    
+    friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+    friend String operator+(const String& a, const char* b) { return String(a.value + (b != nullptr ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a != nullptr ? a : "") + b.value); }
+    friend String operator+(const String& a, char b) { return String(a.value + b); }
+    
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* other) const { return value == (other != nullptr ? other : ""); }
+    bool operator!=(const String& other) const { return !(*this == other); }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool operator<(const String& other) const { return value < other.value; }
+    bool operator>(const String& other) const { return value > other.value; }
+    int compareTo(const String& other) const { return value.compare(other.value); }
+    bool equals(const String& other) const { return value == other.value; }
+    bool equalsIgnoreCase(const String& other) const;
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const;
+    
+    int indexOf(char c, unsigned int from = 0) const { return position(value.find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return position(value.find(text.value, from)); }
+    int lastIndexOf(char c) const { return position(value.rfind(c)); }
+    int lastIndexOf(const String& text) const { return position(value.rfind(text.value)); }
+    
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+    void remove(unsigned int index) { remove(index, (unsigned int)-1); }
+    void remove(unsigned int index, unsigned int count);
+    void replace(const String& find, const String& replacement);
+    void replace(char find, char replacement);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    
+    long toInt() const { return atol(value.c_str()); }
+    float toFloat() const { return (float)atof(value.c_str()); }
+    double toDouble() const { return atof(value.c_str()); }
+
+private:
+    static int position(size_t found) { return found == std::string::npos ? -1 : (int)found; }
+    
+    std::string value;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return text != nullptr ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+    
+    size_t print(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+    size_t print(const char* text) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return printUnsigned(value, base); }
+    size_t print(int value, int base = DEC) { return printSigned(value, base); }
+    size_t print(unsigned int value, int base = DEC) { return printUnsigned(value, base); }
+    size_t print(long value, int base = DEC) { return printSigned(value, base); }
+    size_t print(unsigned long value, int base = DEC) { return printUnsigned(value, base); }
+    size_t print(long long value, int base = DEC) { return printSigned(value, base); }
+    size_t print(unsigned long long value, int base = DEC) { return printUnsigned(value, base); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+    
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+    
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    size_t printSigned(long long value, int base);
+    size_t printUnsigned(unsigned long long value, int base);
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    
+    void setTimeout(unsigned long ms) { timeout = ms; }
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+
+protected:
+    unsigned long timeout = 1000;
+};
+
+// In-memory UART: input queued by the test, output collected for inspection
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end() {}
+    void updateBaudRate(unsigned long baud) { speed = baud; }
+    unsigned long baudRate() { return speed; }
+    operator bool() const { return true; }
+    
+    int available() override { return input.size() - position; }
+    int read() override { return position < input.size() ? (uint8_t)input[position++] : -1; }
+    int peek() override { return position < input.size() ? (uint8_t)input[position] : -1; }
+    size_t write(uint8_t value) override { collected += (char)value; return 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { collected.append((const char*)buffer, size); return size; }
+    int availableForWrite() override { return 128; }
+    using Print::write;
+    
+    // Host side
+    void feed(const void* data, size_t length) { input.append((const char*)data, length); }
+    void feed(const char* text) { input += text; }
+    const std::string& output() const { return collected; }
+    void clear() { input.clear(); position = 0; collected.clear(); }
+
+private:
+    std::string input;
+    size_t position = 0;
+    std::string collected;
+    unsigned long speed = 115200;
+};
+
+extern HardwareSerial Serial;
+
+struct EspClass {
+    uint32_t getFreeHeap() { return 256 * 1024; }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getMaxAllocHeap() { return 128 * 1024; }
+    uint32_t getMinFreeHeap() { return 200 * 1024; }
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    const char* getChipModel() { return "host"; }
+    uint8_t getChipRevision() { return 0; }
+    void restart() { exit(0); }
+};
+
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+long random(long max);
+long random(long min, long max);
+
+// Test control of millis(): frozen at its current value until advanced
+void hostSetManualClock(bool manual);
+void hostAdvanceMillis(unsigned long ms);
+
+#endif // CLI_HOST_ARDUINO_H
@@ -0,0 +1,105 @@
+#include "FS.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+File::File(FILE* file, const std::string& path, bool isDir) :
+    handle(file, [](FILE* f) { if (f != nullptr) fclose(f); }),
+    filePath(path),
+    directory(isDir) {
+    if (file == nullptr) {
+        handle.reset();
+    }
+}
+
+int File::available() {
+    return handle ? (int)(size() - position()) : 0;
+}
+
+int File::read() {
+    return handle ? fgetc(handle.get()) : -1;
+}
+
+int File::peek() {
+    if (!handle) {
+        return -1;
+    }
+    int c = fgetc(handle.get());
+    if (c >= 0) {
+        ungetc(c, handle.get());
+    }
+    return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+    return handle ? fread(buffer, 1, length, handle.get()) : 0;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    return handle ? fwrite(buffer, 1, size, handle.get()) : 0;
+}
+
+void File::flush() {
+    if (handle) {
+        fflush(handle.get());
+    }
+}
+
+bool File::seek(uint32_t offset, SeekMode mode) {
+    static const int origins[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    return handle && fseek(handle.get(), offset, origins[mode]) == 0;
+}
+
+size_t File::position() const {
+    return handle ? (size_t)ftell(handle.get()) : 0;
+}
+
+size_t File::size() const {
+    if (!handle) {
+        return 0;
+    }
+    struct stat info;
+    fflush(handle.get());
+    return fstat(fileno(handle.get()), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+const char* File::name() const {
+    size_t slash = filePath.rfind('/');
+    return filePath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+File FS::open(const String& path, const char* mode, bool) {
+    std::string host = hostPath(path);
+    struct stat info;
+    if (mode[0] == 'r' && stat(host.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        return File(nullptr, path.c_str(), true);
+    }
+    const char* hostMode = (mode[0] == 'w') ? "wb" : (mode[0] == 'a') ? "ab" : "rb";
+    return File(fopen(host.c_str(), hostMode), path.c_str(), false);
+}
+
+bool FS::exists(const String& path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const String& path) {
+    return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const String& from, const String& to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const String& path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const String& path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+}
@@ -0,0 +1,76 @@
+#ifndef CLI_HOST_FS_H
+#define CLI_HOST_FS_H
+
+/**
+ * Host stand-in for the Arduino fs::FS / fs::File API
+ * 
+ * An fs::FS rooted at a host directory, so CLIFileStorage and the file
+ * commands run unchanged in host tests: "/data/log.txt" is
+ * <root>/data/log.txt. Only the calls the library makes are provided.
+ * Like LittleFS, open() for writing fails when the parent directory does
+ * not exist.
+ */
+
+#include "Arduino.h"
+
+#include <memory>
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Stream {
+public:
+    File() : directory(false) {}
+    File(FILE* handle, const std::string& path, bool isDir);
+    
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buffer, size_t length);
+    size_t write(uint8_t value) override { return write(&value, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush() override;
+    using Print::write;
+    
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close() { handle.reset(); directory = false; }
+    operator bool() const { return handle != nullptr || directory; }
+    bool isDirectory() const { return directory; }
+    const char* path() const { return filePath.c_str(); }
+    const char* name() const;
+
+private:
+    std::shared_ptr<FILE> handle;
+    std::string filePath;
+    bool directory;
+};
+
+class FS {
+public:
+    explicit FS(const std::string& root) : root(root) {}
+    
+    File open(const String& path, const char* mode = "r", bool create = false);
+    bool exists(const String& path);
+    bool remove(const String& path);
+    bool rename(const String& from, const String& to);
+    bool mkdir(const String& path);
+    bool rmdir(const String& path);
+
+private:
+    std::string hostPath(const String& path) const { return root + path.c_str(); }
+    
+    std::string root;
+};
+
+}
+
+using fs::File;
+
+#endif // CLI_HOST_FS_H
@@ -0,0 +1,75 @@
+#ifndef HOST_SERIAL_H
+#define HOST_SERIAL_H
+
+/**
+ * Serial port and framing helpers shared by the host tools (POSIX only).
+ */
+
+#include "cli_codec.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <termios.h>
+#include <unistd.h>
+
+static inline speed_t toSpeed(long baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+#ifdef B1500000
+        case 1500000: return B1500000;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+        default: return 0;
+    }
+}
+
+static inline bool makeRaw(int fd, long baud, termios* saved) {
+    termios tio;
+    if (tcgetattr(fd, &tio) != 0) return false;
+    if (saved) *saved = tio;
+    cfmakeraw(&tio);
+    if (baud > 0) {
+        speed_t speed = toSpeed(baud);
+        if (speed == 0) return false;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static inline void writeAll(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        length -= n;
+    }
+}
+
+static inline void sendFrame(int fd, uint8_t channel, const uint8_t* payload, uint8_t length) {
+    uint8_t frame[CLIFrame::HEADER_SIZE + CLIFrame::MAX_PAYLOAD + CLIFrame::CRC_SIZE];
+    uint16_t crc = CLIFrame::encode(frame, channel, payload, length);
+    memcpy(frame + CLIFrame::HEADER_SIZE, payload, length);
+    frame[CLIFrame::HEADER_SIZE + length] = crc >> 8;
+    frame[CLIFrame::HEADER_SIZE + length + 1] = crc & 0xFF;
+    writeAll(fd, frame, CLIFrame::HEADER_SIZE + length + CLIFrame::CRC_SIZE);
+}
+
+#endif // HOST_SERIAL_H
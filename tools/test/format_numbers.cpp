@@ -0,0 +1,95 @@
+/**
+ * Host test for CLIFormat::formatFixed and formatBytes
+ * 
+ * formatFixed is compared with snprintf("%.*f") at every precision for
+ * random float bit patterns below 1.8e19, random values around the
+ * millions, every tie k/2^n with n < 12, and signed zeros. formatBytes is
+ * checked at unit boundaries and up to UINT64_MAX.
+ * 
+ * Build and run (Linux/macOS), from tools/:
+ *   g++ -std=gnu++17 -O1 -g -Ihost -I../src -o format_numbers test/format_numbers.cpp \
+ *       ../src/cli_codec.cpp host/Arduino.cpp
+ *   ./format_numbers
+ */
+
+#include "cli_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <random>
+
+static int failures = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("  FAILED: %s: ", #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static long compared = 0;
+
+static void compareFixed(float value, uint8_t decimals) {
+    char text[CLIFormat::NUMBER_SIZE];
+    char expected[64];
+    *CLIFormat::formatFixed(text, value, decimals) = '\0';
+    snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+    compared++;
+    // Only the first mismatches, a broken rounding rule would flood the log
+    if (failures < 20) {
+        EXPECT(strcmp(text, expected) == 0, "%.9g with %u decimals: %s, printf %s",
+               value, decimals, text, expected);
+    }
+}
+
+static void expectBytes(uint64_t bytes, const char* expected) {
+    char text[CLIFormat::NUMBER_SIZE];
+    *CLIFormat::formatBytes(text, bytes) = '\0';
+    EXPECT(strcmp(text, expected) == 0, "%llu bytes: %s", (unsigned long long)bytes, text);
+}
+
+int main() {
+    printf("formatFixed against printf\n");
+    std::mt19937 rng(1);
+    for (int i = 0; i < 1000000; i++) {
+        uint32_t bits = rng();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (fabsf(value) < 1.8e19f) {
+            compareFixed(value, i % (CLIFormat::MAX_DECIMALS + 1));
+        }
+    }
+    std::uniform_real_distribution<float> millions(-3e6f, 3e6f);
+    for (int i = 0; i < 1000000; i++) {
+        compareFixed(millions(rng), i % (CLIFormat::MAX_DECIMALS + 1));
+    }
+    for (int exponent = 1; exponent < 12; exponent++) {
+        for (int k = -5000; k <= 5000; k++) {
+            for (uint8_t decimals = 0; decimals <= CLIFormat::MAX_DECIMALS; decimals++) {
+                compareFixed(ldexpf((float)k, -exponent), decimals);
+            }
+        }
+    }
+    compareFixed(-0.0f, 2);
+    compareFixed(-0.001f, 2);
+    compareFixed(1912110.125f, 2);
+    compareFixed(-1488734.5f, 0);
+    compareFixed(-INFINITY, 1);
+    printf("  %ld values compared\n", compared);
+    
+    printf("formatBytes\n");
+    expectBytes(1023, "1023 B");
+    expectBytes(1024, "1.0 KB");
+    expectBytes(1048524, "1023.9 KB");
+    expectBytes(1048535, "1.0 MB");
+    expectBytes(1536ULL << 30, "1.5 TB");
+    expectBytes(1844674407370955162ULL, "1677721.6 TB");
+    expectBytes(UINT64_MAX, "16777216.0 TB");
+    
+    printf(failures == 0 ? "All tests passed\n" : "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
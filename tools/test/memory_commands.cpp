@@ -0,0 +1,153 @@
+/**
+ * Host test for the peek/poke/dump commands over a buffer-backed memory
+ * 
+ * A page mapped at 0x3FFB0000 stands in for device RAM and is split into
+ * three regions added with addRegion(): read/write, read-only and
+ * word-only (read-modify-write pokes). The commands run through
+ * executeCommand() and their output is compared with the expected rows;
+ * pokes are checked in the buffer itself. Dumps longer than 1 KB run as
+ * a job through update() and stop on Ctrl-C. Also covers rejected input:
+ * ranges outside or across regions, misaligned addresses, negative and
+ * out of range numbers.
+ * 
+ * Build and run (Linux), from tools/:
+ *   g++ -std=gnu++17 -O1 -g -Ihost -I../src -o memory_commands test/memory_commands.cpp \
+ *       ../src/cli_memory_commands.cpp ../src/generic_cli.cpp ../src/cli_codec.cpp host/Arduino.cpp
+ *   ./memory_commands
+ */
+
+#include "cli_memory_commands.h"
+
+#include <sys/mman.h>
+
+static int failures = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("  FAILED: %s: ", #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static const uintptr_t BASE = 0x3FFB0000;
+static const size_t PAGE = 0x1000;
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0
+#endif
+
+static GenericCLI* cli;
+
+// Output of one command, without the echo of the command line
+static std::string run(const char* line) {
+    Serial.clear();
+    cli->executeCommand(line);
+    return Serial.output();
+}
+
+static void expectOutput(const char* line, const char* expected) {
+    std::string output = run(line);
+    EXPECT(output == expected, "%s\n    got:      [%s]\n    expected: [%s]", line, output.c_str(), expected);
+}
+
+static void expectError(const char* line, const char* message) {
+    std::string output = run(line);
+    EXPECT(output.find(message) != std::string::npos, "%s\n    got: [%s]\n    expected an error containing [%s]",
+           line, output.c_str(), message);
+}
+
+int main() {
+    uint8_t* memory = (uint8_t*)mmap((void*)BASE, PAGE, PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (memory != (uint8_t*)BASE) {
+        printf("Cannot map test memory at 0x%08lX\n", (unsigned long)BASE);
+        return 1;
+    }
+    const char text[] = "Hello, world!";
+    memcpy(memory, text, sizeof(text));
+    for (size_t i = sizeof(text); i < 0x20; i++) {
+        memory[i] = (uint8_t)(0xF0 + i);
+    }
+    memset(memory + 0x800, 0x5A, 0x10);
+    
+    CLIConfig config;
+    config.colorsEnabled = false;
+    config.welcomeMessage = "";
+    config.baudRate = 0;
+    GenericCLI instance(config);
+    cli = &instance;
+    CLIMemoryCommands::registerMemoryCommands(instance);
+    instance.setRole(CLIRoles::ADMIN);
+    CLIMemoryCommands::addRegion("TRAM", BASE, 0x800);
+    CLIMemoryCommands::addRegion("TROM", BASE + 0x800, 0x400, CLIMemoryCommands::READ);
+    CLIMemoryCommands::addRegion("TIRAM", BASE + 0xC00, 0x400,
+                                 CLIMemoryCommands::READ | CLIMemoryCommands::WRITE | CLIMemoryCommands::WORD_ONLY);
+    
+    printf("dump\n");
+    expectOutput("dump 0x3FFB0000 20",
+                 "3FFB0000  48 65 6C 6C 6F 2C 20 77  6F 72 6C 64 21 00 FE FF  |Hello, world!...|\r\n"
+                 "3FFB0010  00 01 02 03                                       |....|\r\n");
+    expectOutput("dump 0x3FFB0801 3", "3FFB0801  5A 5A 5A                                          |ZZZ|\r\n");
+    
+    printf("dump as a job\n");
+    instance.begin();
+    Serial.clear();
+    instance.executeCommand("dump 0x3FFB0000 0x800");
+    EXPECT(instance.jobRunning() && Serial.output().empty(), "%zu bytes before the job ran", Serial.output().size());
+    size_t calls = 0;
+    while (instance.jobRunning() && calls < 100) {
+        instance.update();
+        calls++;
+    }
+    std::string output = Serial.output();
+    EXPECT(calls == 8, "%zu update() calls for 2 KB", calls);
+    EXPECT(output.find("3FFB07F0  ") != std::string::npos && output.find("3FFB0800") == std::string::npos,
+           "last row missing or past the end");
+    Serial.clear();
+    instance.executeCommand("dump 0x3FFB0000 0x800");
+    instance.update();
+    Serial.feed("\x03");
+    instance.update();
+    output = Serial.output();
+    EXPECT(!instance.jobRunning() && output.find("^C") != std::string::npos &&
+           output.find("3FFB00F0") != std::string::npos && output.find("3FFB0100") == std::string::npos,
+           "Ctrl-C did not stop the dump after one block");
+    
+    printf("peek\n");
+    expectOutput("peek 0x3FFB0000 8", "3FFB0000: 6C6C6548 77202C6F\r\n");
+    expectOutput("peek 0x3FFB0004 3 --width=2", "3FFB0004: 2C6F 7720\r\n");
+    expectOutput("peek 1073414145 2 --width=1", "3FFB0001: 65 6C\r\n");
+    
+    printf("poke\n");
+    run("poke 0x3FFB0010 0xAB --width=1");
+    EXPECT(memory[0x10] == 0xAB && memory[0x11] == 0x01, "byte poke: %02X %02X", memory[0x10], memory[0x11]);
+    run("poke 0x3FFB0020 0x12345678");
+    EXPECT(memory[0x20] == 0x78 && memory[0x23] == 0x12, "word poke: %02X %02X", memory[0x20], memory[0x23]);
+    memset(memory + 0xC00, 0x11, 4);
+    run("poke 0x3FFB0C02 0xBEEF --width=2");
+    EXPECT(memory[0xC00] == 0x11 && memory[0xC01] == 0x11 && memory[0xC02] == 0xEF && memory[0xC03] == 0xBE,
+           "read-modify-write: %02X %02X %02X %02X", memory[0xC00], memory[0xC01], memory[0xC02], memory[0xC03]);
+    
+    printf("rejected input\n");
+    expectError("dump 0x3FFB0000 0", "Invalid length");
+    expectError("poke 0x3FFB0800 1", "TROM is read-only");
+    EXPECT(memory[0x800] == 0x5A, "read-only region written");
+    expectError("dump 0x3FFB1000 16", "outside known memory");
+    expectError("dump 0x3FFB07F8 16", "outside known memory");
+    expectError("peek 0x3FFB0002", "aligned");
+    expectError("poke 0x3FFB0010 0x100 --width=1", "does not fit");
+    expectError("peek -4", "Usage");
+    expectError("peek 0x3FFB0000 -1", "Length");
+    expectError("peek 0x1_3FFB0000", "Usage");
+    expectError("peek 0x13FFB00001234567890", "Usage");
+    if (sizeof(uintptr_t) < sizeof(unsigned long long)) {
+        expectError("peek 0x13FFB0000", "Usage");
+    }
+    
+    munmap(memory, PAGE);
+    printf(failures == 0 ? "All tests passed\n" : "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
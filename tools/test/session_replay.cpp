@@ -0,0 +1,165 @@
+/**
+ * Host replay of CLI session recordings
+ * 
+ * Runs GenericCLI on the host (tools/host shim) and feeds recordings
+ * through update() with CLISessionReplay::run, comparing the output with
+ * the recorded output as `session replay` does on a device.
+ * 
+ * Without arguments it tests the round trip: keystrokes (editing, Tab,
+ * history recall, Ctrl-C) are typed into `session record`, the recording
+ * is replayed with `session replay` and must match, and replayed again
+ * after a command changed its output, which must be reported.
+ * 
+ * With a recording it replays that file against the commands registered
+ * in registerCommands() below and prints the result. A recording made on
+ * a device replays here when the commands it used are registered the same
+ * way and give the same output on the host.
+ * 
+ * Build and run (Linux/macOS), from tools/:
+ *   g++ -std=gnu++17 -O1 -g -Ihost -I../src -o session_replay test/session_replay.cpp \
+ *       ../src/cli_session.cpp ../src/generic_cli.cpp ../src/cli_codec.cpp host/Arduino.cpp host/FS.cpp
+ *   ./session_replay                  # round trip test
+ *   ./session_replay <recording>      # replay a file, exit status 1 if it differs
+ */
+
+#include "cli_session.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("  FAILED: %s: ", #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+static bool sumChanged = false;
+
+// Commands the recordings are replayed against
+static void registerCommands(GenericCLI& cli) {
+    cli.registerCommand("echo", "Print the arguments", "echo <text...>", [&cli](const CLIArgs& args) {
+        cli.println(args.line);
+    });
+    cli.registerCommand("sum", "Add integers", "sum <n...>", [&cli](const CLIArgs& args) {
+        long total = sumChanged ? 1 : 0;
+        for (const String& value : args.positional) {
+            total += value.toInt();
+        }
+        cli.printSuccess("Sum: " + String(total));
+    });
+}
+
+static GenericCLI* createCli() {
+    CLIConfig config;
+    config.colorsEnabled = false;
+    config.welcomeMessage = "";
+    config.baudRate = 0;
+    GenericCLI* cli = new GenericCLI(config);
+    registerCommands(*cli);
+    return cli;
+}
+
+// Types text into Serial and runs update() until it is consumed
+static void type(GenericCLI& cli, const char* text) {
+    Serial.feed(text);
+    for (int i = 0; i < 1000 && Serial.available() > 0; i++) {
+        cli.update();
+    }
+    cli.update();
+}
+
+static int replayFile(const char* path) {
+    std::string directory = path;
+    size_t slash = directory.rfind('/');
+    std::string name = slash == std::string::npos ? directory : directory.substr(slash + 1);
+    directory = slash == std::string::npos ? "." : directory.substr(0, slash);
+    
+    fs::FS filesystem(directory);
+    fs::File input = filesystem.open(("/" + name).c_str(), "r");
+    fs::File expected = filesystem.open(("/" + name).c_str(), "r");
+    if (!input || !expected) {
+        printf("Cannot open %s\n", path);
+        return 2;
+    }
+    GenericCLI* cli = createCli();
+    cli->begin();
+    cli->update();
+    CLISessionReplay::Result result = CLISessionReplay::run(*cli, input, expected);
+    delete cli;
+    if (!result.valid) {
+        printf("%s is not a session recording\n", path);
+        return 2;
+    }
+    printf("Input %zu bytes, output %zu bytes compared, %zu missing, %zu after the end\n",
+           result.inputBytes, result.outputBytes, result.missingBytes, result.uncheckedBytes);
+    printf("update() %lu us in %lu calls\n", (unsigned long)result.updateMicros, (unsigned long)result.updates);
+    if (result.mismatches == 0 && result.missingBytes == 0) {
+        printf("Output matches the recording\n");
+        return 0;
+    }
+    printf("%zu byte(s) differ, first at offset %zu\n", result.mismatches,
+           result.mismatches > 0 ? result.firstMismatch : result.outputBytes);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return replayFile(argv[1]);
+    }
+    
+    char directory[] = "/tmp/session_replay.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    fs::FS filesystem(directory);
+    GenericCLI* cli = createCli();
+    CLISession::registerSessionCommands(*cli, filesystem);
+    cli->begin();
+    cli->update();
+    
+    printf("Recording\n");
+    type(*cli, "session record /typed.rec\r");
+    type(*cli, "echo hello \"quoted words\"  --flag=1\r");
+    type(*cli, "sum 1 2 3\r");
+    type(*cli, "sum 4 5x\b6\r");            // Backspace
+    type(*cli, "ech\t again\r");             // Tab completion
+    type(*cli, "\033[A\033[A\r");            // History recall
+    type(*cli, "echo abc\033[D\033[DX\r");   // Insert mid-line
+    type(*cli, "echo dropped\x03");          // Ctrl-C clears the line
+    type(*cli, "sum 10 20\r");
+    type(*cli, "session stop\r");
+    EXPECT(Serial.output().find("Recorded") != std::string::npos, "recording not stopped");
+    
+    printf("Replay\n");
+    Serial.clear();
+    type(*cli, "session replay /typed.rec\r");
+    std::string output = Serial.output();
+    EXPECT(output.find("Output matches the recording") != std::string::npos, "replay output:\n%s", output.c_str());
+    
+    printf("Replay with a changed command\n");
+    sumChanged = true;
+    Serial.clear();
+    type(*cli, "session replay /typed.rec\r");
+    output = Serial.output();
+    EXPECT(output.find("byte(s) differ") != std::string::npos, "replay output:\n%s", output.c_str());
+    sumChanged = false;
+    
+    printf("Replay of the file from the command line\n");
+    std::string path = std::string(directory) + "/typed.rec";
+    EXPECT(replayFile(path.c_str()) == 0, "%s did not replay", path.c_str());
+    
+    delete cli;
+    std::string cleanup = "rm -rf '" + std::string(directory) + "'";
+    if (system(cleanup.c_str()) != 0) {
+        printf("Could not remove %s\n", directory);
+    }
+    printf(failures == 0 ? "All tests passed\n" : "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+ * Host test for CLISettings value checks
+ * 
+ * Values go in through set(), the `config` command and importJson(), and
+ * must stay inside the registered range: nan and inf for FLOAT settings,
+ * the int32_t limits and values past them for INT settings (whose bounds
+ * are kept as integers, exact above 2^24). A rejected value leaves the
+ * variable and its dirty flag unchanged.
+ * 
+ * Build and run (Linux/macOS), from tools/:
+ *   g++ -std=gnu++17 -O1 -g -Ihost -I../src -o settings test/settings.cpp \
+ *       ../src/cli_settings.cpp ../src/cli_json.cpp ../src/generic_cli.cpp ../src/cli_codec.cpp host/Arduino.cpp
+ *   ./settings
+ */
+
+#include "cli_settings.h"
+
+#include <math.h>
+
+static int failures = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("  FAILED: %s: ", #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+// A JSON document for importJson()
+class TextStream : public Stream {
+public:
+    explicit TextStream(const char* text) : text(text) {}
+    
+    int available() override { return (int)(text.size() - position); }
+    int read() override { return position < text.size() ? (uint8_t)text[position++] : -1; }
+    int peek() override { return position < text.size() ? (uint8_t)text[position] : -1; }
+    size_t write(uint8_t) override { return 1; }
+    using Print::write;
+
+private:
+    std::string text;
+    size_t position = 0;
+};
+
+static float ratio;
+static int32_t wide;
+static int32_t small;
+
+static void expectRejected(CLISettings& settings, const char* name, const char* value) {
+    float ratioBefore = ratio;
+    int32_t wideBefore = wide;
+    int32_t smallBefore = small;
+    size_t dirtyBefore = settings.dirtyCount();
+    EXPECT(!settings.set(name, value), "%s = %s accepted", name, value);
+    EXPECT(memcmp(&ratio, &ratioBefore, sizeof(ratio)) == 0 && wide == wideBefore && small == smallBefore,
+           "%s = %s changed a value", name, value);
+    EXPECT(settings.dirtyCount() == dirtyBefore, "%s = %s marked a setting dirty", name, value);
+}
+
+static void expectAccepted(CLISettings& settings, const char* name, const char* value, const char* shown) {
+    EXPECT(settings.set(name, value), "%s = %s rejected: %s", name, value, settings.lastError().c_str());
+    EXPECT(settings.get(name) == shown, "%s = %s reads back as %s", name, value, settings.get(name).c_str());
+}
+
+int main() {
+    CLISettings settings("test");
+    settings.addFloat("ratio", &ratio, 0.5f, 0.0f, 1.0f);
+    settings.addInt("wide", &wide, 16777217, INT32_MIN, INT32_MAX);
+    settings.addInt("small", &small, 5, 1, 10);
+    
+    printf("Defaults\n");
+    EXPECT(wide == 16777217, "wide default %d", (int)wide);
+    EXPECT(settings.get("wide") == "16777217", "wide reads %s", settings.get("wide").c_str());
+    
+    printf("FLOAT range\n");
+    expectRejected(settings, "ratio", "nan");
+    expectRejected(settings, "ratio", "-nan");
+    expectRejected(settings, "ratio", "inf");
+    expectRejected(settings, "ratio", "1.5");
+    expectRejected(settings, "ratio", "x");
+    expectAccepted(settings, "ratio", "1", "1.000");
+    
+    printf("INT range\n");
+    expectAccepted(settings, "wide", "2147483647", "2147483647");
+    expectAccepted(settings, "wide", "-2147483648", "-2147483648");
+    expectAccepted(settings, "wide", "16777219", "16777219");
+    expectRejected(settings, "wide", "2147483648");
+    expectRejected(settings, "wide", "-2147483649");
+    expectRejected(settings, "wide", "99999999999999999999");
+    expectRejected(settings, "small", "11");
+    expectRejected(settings, "small", "0x");
+    
+    printf("config command\n");
+    CLIConfig config;
+    config.colorsEnabled = false;
+    config.welcomeMessage = "";
+    config.baudRate = 0;
+    GenericCLI cli(config);
+    settings.registerCommands(cli);
+    Serial.clear();
+    cli.executeCommand("config set ratio nan");
+    EXPECT(Serial.output().find("ERROR") != std::string::npos, "config set ratio nan: %s", Serial.output().c_str());
+    EXPECT(ratio == 1.0f, "ratio is %f", ratio);
+    
+    printf("importJson\n");
+    TextStream document("{\"ratio\": \"nan\", \"small\": 7, \"wide\": 4294967296}\r\n");
+    CLISettings::ImportResult result = settings.importJson(document, 100);
+    EXPECT(result.complete, "import stopped: %s", result.error.c_str());
+    EXPECT(result.applied == 1 && result.rejected == 2, "%zu applied, %zu rejected", result.applied, result.rejected);
+    EXPECT(ratio == 1.0f && small == 7, "ratio %f, small %d", ratio, (int)small);
+    
+    printf(failures == 0 ? "All tests passed\n" : "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
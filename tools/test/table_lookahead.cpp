@@ -0,0 +1,109 @@
+/**
+ * Host test for the CLITable look-ahead
+ * 
+ * TEXT tables hold rows back (LOOKAHEAD_BYTES) to size the columns. When
+ * the held back text fills up in the middle of a row, the header and the
+ * complete rows are written and the rest of that row streams on from the
+ * column it had reached. Tables of 1 to 4 columns with cells of 10 to 40
+ * characters are written so that the buffer fills at every column
+ * position, and each output line is compared with the row it should be.
+ * 
+ * Build and run (Linux/macOS), from tools/:
+ *   g++ -std=gnu++17 -O1 -g -Ihost -I../src -o table_lookahead test/table_lookahead.cpp \
+ *       ../src/cli_widgets.cpp ../src/generic_cli.cpp ../src/cli_codec.cpp host/Arduino.cpp
+ *   ./table_lookahead
+ */
+
+#include "cli_widgets.h"
+
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("  FAILED: %s: ", #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+class OutputSink : public Print {
+public:
+    size_t write(uint8_t value) override { text += (char)value; return 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { text.append((const char*)buffer, size); return size; }
+    using Print::write;
+    
+    std::string text;
+};
+
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    size_t end;
+    while ((end = text.find("\r\n", start)) != std::string::npos) {
+        lines.push_back(text.substr(start, end - start));
+        start = end + 2;
+    }
+    return lines;
+}
+
+// Cell text of a given length that names its row and column
+static std::string cellText(size_t row, size_t column, size_t length) {
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "r%02zu-%c", row, (char)('a' + column));
+    std::string text = prefix;
+    text.resize(length, (char)('a' + column));
+    return text;
+}
+
+static void testTable(size_t columnCount, size_t length, size_t rowCount) {
+    static const char* const titles[] = { "A", "B", "C", "D" };
+    OutputSink out;
+    {
+        CLITable table(out);
+        for (size_t c = 0; c < columnCount; c++) {
+            table.column(titles[c]);
+        }
+        for (size_t r = 0; r < rowCount; r++) {
+            for (size_t c = 0; c < columnCount; c++) {
+                table.cell(cellText(r, c, length).c_str());
+            }
+            table.endRow();
+        }
+    }
+    
+    std::vector<std::string> lines = splitLines(out.text);
+    EXPECT(lines.size() == rowCount + 2, "%zu columns of %zu characters: %zu lines for %zu rows",
+           columnCount, length, lines.size(), rowCount);
+    for (size_t r = 0; r < rowCount && r + 2 < lines.size(); r++) {
+        std::string expected;
+        for (size_t c = 0; c < columnCount; c++) {
+            if (c > 0) expected += "  ";
+            expected += cellText(r, c, length);
+        }
+        if (lines[r + 2] != expected) {
+            EXPECT(lines[r + 2] == expected, "%zu columns of %zu characters, row %zu:\n    got:      [%s]\n"
+                   "    expected: [%s]", columnCount, length, r, lines[r + 2].c_str(), expected.c_str());
+            return;
+        }
+    }
+}
+
+int main() {
+    printf("Look-ahead filled at every column position\n");
+    for (size_t columns = 1; columns <= 4; columns++) {
+        for (size_t length = 10; length <= CLITable::MAX_AUTO_WIDTH; length++) {
+            testTable(columns, length, 15);
+        }
+    }
+    printf("Rows that fit the look-ahead\n");
+    testTable(3, 39, 4);
+    testTable(2, 12, 40);
+    
+    printf(failures == 0 ? "All tests passed\n" : "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+/**
+ * Host test for CLIYModem over a loopback link
+ * 
+ * Sender and receiver run in two threads connected by an in-memory byte
+ * pipe, and write into a temporary directory through CLIFileStorage and
+ * the host fs::FS (tools/host/FS.h). The sent and received files are
+ * compared byte for byte. Faults are injected on the link or in storage:
+ *   - files of 0, 100, 3072 and 5000 bytes, with CRC and with YMODEM-g
+ *   - a corrupted byte and a lost ACK, which the receiver must recover from
+ *   - a storage read error in the sender, after which the receiver must
+ *     report CANCELLED and delete the partial file
+ *   - a header with "../" in the file name, which must land in the target
+ *     directory
+ * 
+ * Build and run (Linux/macOS), from tools/:
+ *   g++ -std=gnu++17 -O1 -g -pthread -Ihost -I../src -o ymodem_loopback test/ymodem_loopback.cpp \
+ *       ../src/cli_ymodem.cpp ../src/cli_storage.cpp ../src/cli_codec.cpp host/Arduino.cpp host/FS.cpp
+ *   ./ymodem_loopback
+ */
+
+#include "cli_ymodem.h"
+#include "cli_codec.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define EXPECT(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("  FAILED: %s: ", #condition); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while (0)
+
+// One direction of the link
+struct Pipe {
+    std::mutex lock;
+    std::deque<uint8_t> bytes;
+};
+
+// One end of the link; can corrupt or drop a byte it writes
+class LoopbackEnd : public Stream {
+public:
+    LoopbackEnd(Pipe& in, Pipe& out) : in(in), out(out) {}
+    
+    int available() override {
+        std::lock_guard<std::mutex> guard(in.lock);
+        return in.bytes.size();
+    }
+    
+    int read() override {
+        std::lock_guard<std::mutex> guard(in.lock);
+        if (in.bytes.empty()) {
+            return -1;
+        }
+        uint8_t value = in.bytes.front();
+        in.bytes.pop_front();
+        return value;
+    }
+    
+    int peek() override {
+        std::lock_guard<std::mutex> guard(in.lock);
+        return in.bytes.empty() ? -1 : in.bytes.front();
+    }
+    
+    size_t write(uint8_t value) override {
+        size_t index = written++;
+        if (index == dropAt) {
+            return 1;
+        }
+        std::lock_guard<std::mutex> guard(out.lock);
+        out.bytes.push_back(index == corruptAt ? value ^ 0x55 : value);
+        return 1;
+    }
+    
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            write(buffer[i]);
+        }
+        return size;
+    }
+    using Print::write;
+    
+    size_t corruptAt = SIZE_MAX;
+    size_t dropAt = SIZE_MAX;
+
+private:
+    Pipe& in;
+    Pipe& out;
+    size_t written = 0;
+};
+
+// Sender storage that fails to read after failAfter bytes
+class FailingStorage : public CLIFileStorage {
+public:
+    FailingStorage(fs::FS& filesystem, size_t failAfter) : CLIFileStorage(filesystem), left(failAfter) {}
+    
+    size_t read(uint8_t* data, size_t length) override {
+        if (length > left) {
+            return 0;
+        }
+        left -= length;
+        return CLIFileStorage::read(data, length);
+    }
+
+private:
+    size_t left;
+};
+
+static std::string root;
+
+static std::vector<uint8_t> readHostFile(const std::string& path) {
+    std::vector<uint8_t> data;
+    FILE* file = fopen((root + path).c_str(), "rb");
+    if (file != nullptr) {
+        int c;
+        while ((c = fgetc(file)) != EOF) {
+            data.push_back((uint8_t)c);
+        }
+        fclose(file);
+    }
+    return data;
+}
+
+static std::vector<uint8_t> writeHostFile(const std::string& path, size_t size, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& value : data) {
+        value = (uint8_t)rng();
+    }
+    FILE* file = fopen((root + path).c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+    return data;
+}
+
+struct Transfer {
+    CLIYModem::Result sent;
+    CLIYModem::Result received;
+    size_t bytes;
+    String name;
+};
+
+// Sends path from "/out" into "/in" with the faults set on the two ends
+static Transfer run(fs::FS& filesystem, const String& path, bool streaming,
+                    LoopbackEnd& senderEnd, LoopbackEnd& receiverEnd, CLIFileStorage* source = nullptr) {
+    CLIFileStorage defaultSource(filesystem);
+    CLIFileStorage target(filesystem, "/in");
+    CLIYModem sender(senderEnd);
+    CLIYModem receiver(receiverEnd);
+    Transfer transfer;
+    
+    std::thread sending([&]() {
+        transfer.sent = sender.send(source != nullptr ? *source : defaultSource, path);
+    });
+    transfer.received = receiver.receive(target, streaming);
+    sending.join();
+    transfer.bytes = receiver.getBytesTransferred();
+    transfer.name = receiver.getFileName();
+    return transfer;
+}
+
+static void testFile(fs::FS& filesystem, size_t size, bool streaming, size_t corruptAt = SIZE_MAX,
+                     size_t dropAckAt = SIZE_MAX) {
+    printf("%zu bytes%s%s%s\n", size, streaming ? ", YMODEM-g" : "",
+           corruptAt != SIZE_MAX ? ", corrupted byte" : "", dropAckAt != SIZE_MAX ? ", lost ACK" : "");
+    std::string name = "file" + std::to_string(size) + ".bin";
+    std::vector<uint8_t> data = writeHostFile("/out/" + name, size, (unsigned)size);
+    
+    Pipe toReceiver;
+    Pipe toSender;
+    LoopbackEnd senderEnd(toSender, toReceiver);
+    LoopbackEnd receiverEnd(toReceiver, toSender);
+    senderEnd.corruptAt = corruptAt;
+    receiverEnd.dropAt = dropAckAt;
+    Transfer transfer = run(filesystem, ("/out/" + name).c_str(), streaming, senderEnd, receiverEnd);
+    
+    EXPECT(transfer.sent == CLIYModem::Result::OK, "send: %s", CLIYModem::resultText(transfer.sent));
+    EXPECT(transfer.received == CLIYModem::Result::OK, "receive: %s", CLIYModem::resultText(transfer.received));
+    EXPECT(transfer.bytes == size, "%zu bytes received", transfer.bytes);
+    EXPECT(transfer.name == name.c_str(), "name %s", transfer.name.c_str());
+    EXPECT(readHostFile("/in/" + name) == data, "received file differs");
+}
+
+static void testSenderFailure(fs::FS& filesystem) {
+    printf("Storage error in the sender\n");
+    writeHostFile("/out/partial.bin", 4000, 7);
+    
+    Pipe toReceiver;
+    Pipe toSender;
+    LoopbackEnd senderEnd(toSender, toReceiver);
+    LoopbackEnd receiverEnd(toReceiver, toSender);
+    FailingStorage source(filesystem, 2048);
+    Transfer transfer = run(filesystem, "/out/partial.bin", false, senderEnd, receiverEnd, &source);
+    
+    EXPECT(transfer.sent == CLIYModem::Result::STORAGE_ERROR, "send: %s", CLIYModem::resultText(transfer.sent));
+    EXPECT(transfer.received == CLIYModem::Result::CANCELLED, "receive: %s", CLIYModem::resultText(transfer.received));
+    EXPECT(!filesystem.exists("/in/partial.bin"), "partial file kept");
+}
+
+// A header block with a path in the name, written by hand
+static void testPathInName(fs::FS& filesystem) {
+    printf("Directories in the received file name\n");
+    std::vector<uint8_t> stream;
+    auto block = [&stream](uint8_t sequence, const char* text, size_t textLength) {
+        uint8_t data[128];
+        memset(data, 0, sizeof(data));
+        memcpy(data, text, textLength);
+        uint16_t crc = CLICodec::crc16(data, sizeof(data), 0);
+        stream.insert(stream.end(), { 0x01, sequence, (uint8_t)~sequence });
+        stream.insert(stream.end(), data, data + sizeof(data));
+        stream.insert(stream.end(), { (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) });
+    };
+    block(0, "../../escape.txt\0" "3", 19);
+    block(1, "abc", 3);
+    stream.insert(stream.end(), { 0x04, 0x04 });
+    block(0, "", 0);
+    
+    Pipe toReceiver;
+    Pipe toSender;
+    toReceiver.bytes.assign(stream.begin(), stream.end());
+    LoopbackEnd receiverEnd(toReceiver, toSender);
+    CLIFileStorage target(filesystem, "/in");
+    CLIYModem receiver(receiverEnd);
+    CLIYModem::Result result = receiver.receive(target);
+    
+    EXPECT(result == CLIYModem::Result::OK, "receive: %s", CLIYModem::resultText(result));
+    EXPECT(readHostFile("/in/escape.txt") == std::vector<uint8_t>({ 'a', 'b', 'c' }), "file not in /in");
+    EXPECT(!filesystem.exists("/escape.txt"), "file written outside /in");
+}
+
+int main() {
+    char directory[] = "/tmp/ymodem_loopback.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    root = directory;
+    fs::FS filesystem(root);
+    filesystem.mkdir("/in");
+    filesystem.mkdir("/out");
+    
+    testFile(filesystem, 5000, false);
+    testFile(filesystem, 3072, false);
+    testFile(filesystem, 100, false);
+    testFile(filesystem, 0, false);
+    testFile(filesystem, 5000, true);
+    testFile(filesystem, 5000, false, 2000);
+    testFile(filesystem, 5000, false, SIZE_MAX, 3);
+    testSenderFailure(filesystem);
+    testPathInName(filesystem);
+    
+    std::string cleanup = "rm -rf '" + root + "'";
+    if (system(cleanup.c_str()) != 0) {
+        printf("Could not remove %s\n", directory);
+    }
+    printf(failures == 0 ? "All tests passed\n" : "%d check(s) failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}